@@ -12,33 +12,56 @@ DESTDIR = .
 cache()
 
 
-SOURCES += src/Asteroids.cpp \
+SOURCES += src/ActiveSet.cpp \
+           src/AssetLoader.cpp \
+           src/Asteroids.cpp \
+           src/AsteroidKernel.cpp \
            src/Audio.cpp \
            src/Camera.cpp \
+           src/Frustum.cpp \
+           src/Icosphere.cpp \
            src/LoadOBJ.cpp \
+           src/Mesh.cpp \
            src/main.cpp \
            src/Particles.cpp \
+           src/ParticleKernel.cpp \
+           src/Simd.cpp \
            src/Planet.cpp \
            src/Player.cpp \
            src/Projectile.cpp \
            src/Sdl_gl.cpp \
+           src/Shader.cpp \
+           src/SphereGrid.cpp \
+           src/Narrowphase.cpp \
            src/TextureOBJ.cpp \
            src/World.cpp \
            src/NCCA/GLFunctions.cpp \
            src/NCCA/Mat4.cpp \
            src/NCCA/Vec4.cpp
-HEADERS += include/Asteroids.h \
+HEADERS += include/ActiveSet.h \
+           include/AlignedAllocator.h \
+           include/AssetLoader.h \
+           include/Asteroids.h \
+           include/AsteroidKernel.h \
            include/Audio.h \
            include/Camera.h \
            include/Defs.h \
            include/frames.h \
-           include/Icosahedron.h \
+           include/Icosphere.h \
+           include/Frustum.h \
            include/LoadOBJ.h \
+           include/Mesh.h \
            include/Particles.h \
+           include/ParticleKernel.h \
+           include/Simd.h \
            include/Planet.h \
            include/Player.h \
            include/Projectile.h \
            include/Sdl_gl.h \
+           include/Shader.h \
+           include/SlotMap.h \
+           include/SphereGrid.h \
+           include/Narrowphase.h \
            include/TextureOBJ.h \
            include/World.h \
            include/NCCA/GLFunctions.h \
@@ -46,6 +69,7 @@ HEADERS += include/Asteroids.h \
            include/NCCA/Vec4.h
 OTHER_FILES += textures/* \
                models/* \
+               shaders/* \
                sounds/* \
                Resources.txt
 
@@ -62,12 +86,17 @@ macx:LIBS += -framework OpenGL
 macx:LIBS += -framework glut
 macx:DEFINES +=DARWIN
 
+# Uncomment to show the drawn and culled object counts under the fps
+# DEFINES += CULLINGSTATS
+
 linux-* {
-    DEFINES += LINUX
-    LIBS+= -lGLEW -lglut -lGLU
+    DEFINES += LINUX GL_GLEXT_PROTOTYPES
+    QMAKE_CXXFLAGS += -pthread
+    LIBS+= -lGLEW -lglut -lGLU -pthread
 }
 
 linux-clang {
-    DEFINES += LINUX
-    LIBS+= -lGLEW -lglut -lGLU
+    DEFINES += LINUX GL_GLEXT_PROTOTYPES
+    QMAKE_CXXFLAGS += -pthread
+    LIBS+= -lGLEW -lglut -lGLU -pthread
 }
@@ -0,0 +1,60 @@
+# Microbenchmarks for the parts of the simulation that don't need a window or a GL
+# context. Built headless like the simulation build in ../headless.
+
+CONFIG += console
+CONFIG += c++11
+CONFIG -= qt
+CONFIG -= app_bundle
+
+TARGET = super_stardust_bench
+DESTDIR = .
+
+SOURCES += ../src/bench.cpp \
+           ../src/Asteroids.cpp \
+           ../src/AsteroidKernel.cpp \
+           ../src/Frustum.cpp \
+           ../src/Icosphere.cpp \
+           ../src/LoadOBJ.cpp \
+           ../src/Mesh.cpp \
+           ../src/Particles.cpp \
+           ../src/ParticleKernel.cpp \
+           ../src/Simd.cpp \
+           ../src/SphereGrid.cpp \
+           ../src/Narrowphase.cpp \
+           ../src/NCCA/Mat4.cpp \
+           ../src/NCCA/Vec4.cpp
+HEADERS += ../include/Defs.h \
+           ../include/Particles.h \
+           ../include/ParticleKernel.h \
+           ../include/Simd.h \
+           ../include/SphereGrid.h \
+           ../include/Narrowphase.h \
+           ../include/AlignedAllocator.h \
+           ../include/Asteroids.h \
+           ../include/AsteroidKernel.h \
+           ../include/Frustum.h \
+           ../include/Icosphere.h \
+           ../include/LoadOBJ.h \
+           ../include/Mesh.h \
+           ../include/SlotMap.h \
+           ../include/NCCA/Mat4.h \
+           ../include/NCCA/Vec4.h
+
+INCLUDEPATH += ../include
+INCLUDEPATH += /usr/local/include
+
+DEFINES += HEADLESS
+QMAKE_CXXFLAGS += -std=c++0x -O2
+
+macx:LIBS += -framework OpenGL
+macx:DEFINES +=DARWIN
+
+linux-* {
+    DEFINES += LINUX
+    LIBS+= -lGL
+}
+
+linux-clang {
+    DEFINES += LINUX
+    LIBS+= -lGL
+}
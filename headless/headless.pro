@@ -0,0 +1,61 @@
+# Headless simulation build. Links the World/Player/Asteroid/Projectile/Particle
+# simulation without GLUT, SDL or SDL_mixer so it can be run on machines without
+# a display. The NCCA maths library still carries its small GL helper functions
+# (vertexGL() etc.) so GL is linked for those, but no context is ever created.
+
+CONFIG += console
+CONFIG += c++11
+CONFIG -= qt
+CONFIG -= app_bundle
+
+TARGET = super_stardust_headless
+DESTDIR = .
+
+SOURCES += ../src/ActiveSet.cpp \
+           ../src/Asteroids.cpp \
+           ../src/AsteroidKernel.cpp \
+           ../src/headless.cpp \
+           ../src/Particles.cpp \
+           ../src/ParticleKernel.cpp \
+           ../src/Simd.cpp \
+           ../src/Player.cpp \
+           ../src/Projectile.cpp \
+           ../src/SphereGrid.cpp \
+           ../src/Narrowphase.cpp \
+           ../src/World.cpp \
+           ../src/NCCA/Mat4.cpp \
+           ../src/NCCA/Vec4.cpp
+HEADERS += ../include/ActiveSet.h \
+           ../include/AlignedAllocator.h \
+           ../include/Asteroids.h \
+           ../include/AsteroidKernel.h \
+           ../include/Camera.h \
+           ../include/Defs.h \
+           ../include/Particles.h \
+           ../include/ParticleKernel.h \
+           ../include/Simd.h \
+           ../include/Player.h \
+           ../include/Projectile.h \
+           ../include/SlotMap.h \
+           ../include/SphereGrid.h \
+           ../include/Narrowphase.h \
+           ../include/World.h \
+           ../include/NCCA/Mat4.h \
+           ../include/NCCA/Vec4.h
+
+INCLUDEPATH += ../include
+INCLUDEPATH += /usr/local/include
+
+DEFINES += HEADLESS
+QMAKE_CXXFLAGS += -std=c++0x
+
+macx:DEFINES +=DARWIN
+
+# Nothing in the headless build calls GL, the GL headers are only used for the types
+linux-* {
+    DEFINES += LINUX
+}
+
+linux-clang {
+    DEFINES += LINUX
+}
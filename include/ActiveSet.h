@@ -0,0 +1,113 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#ifndef ACTIVESET_H
+#define ACTIVESET_H
+
+// ---------------------------------------------------------------------------------------
+/// @file ActiveSet.h
+/// @brief Set of indices stored as a flat array for iteration with a membership bitset
+///        and the position of each member in the array, so inserting, removing and
+///        checking for an index are all O(1). The order of the members isn't kept.
+/// @version 1.0
+/// @author Teemu Lindborg
+/// @date 03/05/15
+/// Revision History:
+///   -
+/// @todo Nothing for now
+// ---------------------------------------------------------------------------------------
+
+#include <vector>
+
+class ActiveSet
+{
+  public:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Ctor, reserves the space for indices up to the given capacity
+    /// @param[in] _capacity Amount of indices to reserve space for, the set grows past it
+    ///            when larger indices are inserted
+    // ---------------------------------------------------------------------------------------
+    ActiveSet(
+              const int _capacity = 0
+             );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Default dtor
+    // ---------------------------------------------------------------------------------------
+    ~ActiveSet() {}
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Adds an index to the set, does nothing if it's already in it
+    /// @param[in] _i Index to add
+    // ---------------------------------------------------------------------------------------
+    void insert(
+                const int _i
+               );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Removes an index from the set by moving the last member in to its place,
+    ///        does nothing if the index isn't in the set
+    /// @param[in] _i Index to remove
+    // ---------------------------------------------------------------------------------------
+    void erase(
+               const int _i
+              );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Checks whether an index is in the set
+    /// @param[in] _i Index to check
+    /// @return True if the index is in the set
+    // ---------------------------------------------------------------------------------------
+    bool contains(
+                  const int _i
+                 ) const
+    {
+      return _i < (int)m_slot.size() && (m_bits[_i >> 5] >> (_i & 31)) & 1u;
+    }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Removes all the members, the allocated memory is kept
+    // ---------------------------------------------------------------------------------------
+    void clear();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the amount of members
+    /// @return Amount of indices in the set
+    // ---------------------------------------------------------------------------------------
+    int size() const { return (int)m_members.size(); }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Access to the members in no particular order, valid positions are [0, size())
+    /// @param[in] _n Position of the member
+    /// @return The index stored at the position
+    // ---------------------------------------------------------------------------------------
+    int operator[](const int _n) const { return m_members[_n]; }
+
+  protected:
+    // ---------------------------------------------------------------------------------------
+    /// @brief The members packed in to a flat array
+    // ---------------------------------------------------------------------------------------
+    std::vector<int> m_members;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Position of each index in m_members, only valid for the members
+    // ---------------------------------------------------------------------------------------
+    std::vector<int> m_slot;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Membership bit of each index, 32 indices per word
+    // ---------------------------------------------------------------------------------------
+    std::vector<unsigned int> m_bits;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Grows the slot and bit arrays to hold the given index
+    /// @param[in] _i Index that needs to fit
+    // ---------------------------------------------------------------------------------------
+    void grow(
+              const int _i
+             );
+}; // end of class
+
+#endif // end of ACTIVESET_H
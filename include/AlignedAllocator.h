@@ -0,0 +1,93 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#ifndef ALIGNEDALLOCATOR_H
+#define ALIGNEDALLOCATOR_H
+
+// ---------------------------------------------------------------------------------------
+/// @file AlignedAllocator.h
+/// @brief Allocator for stl vectors that aligns the storage to the given boundary, used
+///        for the arrays the SIMD kernels load from so that the start of an array always
+///        begins a full AVX register.
+/// @version 1.0
+/// @author Teemu Lindborg
+/// @date 03/05/15
+/// Revision History:
+///   -
+/// @todo Nothing for now
+// ---------------------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Alignment of the SIMD arrays, the width of an AVX register
+#define SIMDALIGNMENT 32
+
+template <class T, size_t A = SIMDALIGNMENT>
+class AlignedAllocator
+{
+  public:
+    typedef T value_type;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief The same allocator for a different type, stl containers need this as the
+    ///        alignment parameter stops it from being worked out automatically
+    // ---------------------------------------------------------------------------------------
+    template <class U>
+    struct rebind { typedef AlignedAllocator<U, A> other; };
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Default ctor and the converting ctor for the rebound allocators
+    // ---------------------------------------------------------------------------------------
+    AlignedAllocator() {}
+    template <class U>
+    AlignedAllocator(const AlignedAllocator<U, A> &) {}
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Allocates aligned storage for _n elements
+    /// @param[in] _n Amount of elements
+    /// @return Pointer to the storage
+    // ---------------------------------------------------------------------------------------
+    T *allocate(
+                const size_t _n
+               )
+    {
+      void *p = NULL;
+      if(posix_memalign(&p, A, _n * sizeof(T)))
+        throw std::bad_alloc();
+      return static_cast<T *>(p);
+    }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Frees storage returned by allocate
+    /// @param[in] _p Pointer to the storage
+    // ---------------------------------------------------------------------------------------
+    void deallocate(
+                    T *_p,
+                    const size_t
+                   )
+    {
+      free(_p);
+    }
+}; // end of class
+
+// The allocators hold no state so any two of them can free each other's storage
+template <class T, class U, size_t A>
+bool operator==(const AlignedAllocator<T, A> &, const AlignedAllocator<U, A> &) { return true; }
+template <class T, class U, size_t A>
+bool operator!=(const AlignedAllocator<T, A> &, const AlignedAllocator<U, A> &) { return false; }
+
+// ---------------------------------------------------------------------------------------
+/// @brief Vector of floats aligned for the SIMD kernels
+// ---------------------------------------------------------------------------------------
+typedef std::vector<float, AlignedAllocator<float> > alignedFloats;
+
+// ---------------------------------------------------------------------------------------
+/// @brief Vector of ints aligned for the SIMD kernels
+// ---------------------------------------------------------------------------------------
+typedef std::vector<int, AlignedAllocator<int> > alignedInts;
+
+#endif // end of ALIGNEDALLOCATOR_H
@@ -0,0 +1,169 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#ifndef ASSETLOADER_H
+#define ASSETLOADER_H
+
+// ---------------------------------------------------------------------------------------
+/// @file AssetLoader.h
+/// @brief Loads the models, textures and sounds on a pool of threads. The loads are
+///        requested with the destination they're stored in and run in the background,
+///        finish() then waits for all of them. The textures can only be created on the
+///        thread that owns the GL context, so the workers just decode the images and
+///        finish() uploads them one by one as they get decoded.
+/// @version 1.0
+/// @author Teemu Lindborg
+/// @date 03/05/15
+/// Revision History:
+///   -
+/// @todo Build the meshes on the workers as well, only their upload needs the GL thread
+// ---------------------------------------------------------------------------------------
+
+#ifdef LINUX
+  #include <GL/gl.h>
+#endif
+#ifdef DARWIN
+  #include <OpenGL/gl.h>
+#endif
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_mixer.h>
+
+#include "LoadOBJ.h"
+
+class AssetLoader
+{
+  public:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Ctor, starts the worker threads
+    /// @param[in] _threads Amount of worker threads, 0 uses one per core
+    // ---------------------------------------------------------------------------------------
+    AssetLoader(
+                const int _threads = 0
+               );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Dtor, finishes the requested loads and stops the worker threads
+    // ---------------------------------------------------------------------------------------
+    ~AssetLoader();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Requests an OBJ-file to be loaded (see loadModel)
+    /// @param[in] _n Path to the OBJ-file
+    /// @param[out] o_m Model structure to store the data in, must not be touched before
+    ///             finish() has returned
+    // ---------------------------------------------------------------------------------------
+    void requestModel(
+                      const std::string &_n,
+                      model &o_m
+                     );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Requests a texture to be loaded, the image is decoded on a worker and the
+    ///        texture is created in finish()
+    /// @param[in] _n Path to the image
+    /// @param[out] o_id GLuint that the texture will be loaded in to
+    // ---------------------------------------------------------------------------------------
+    void requestTexture(
+                        const std::string &_n,
+                        GLuint &o_id
+                       );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Requests a sound to be loaded (see audio::loadSound)
+    /// @param[in] _n Path to the sound file
+    /// @param[out] o_sound Var to store the sound data
+    // ---------------------------------------------------------------------------------------
+    void requestSound(
+                      const std::string &_n,
+                      Mix_Chunk **o_sound
+                     );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Requests a music file to be loaded (see audio::loadSound)
+    /// @param[in] _n Path to the music file
+    /// @param[out] o_music Var to store the music data
+    // ---------------------------------------------------------------------------------------
+    void requestSound(
+                      const std::string &_n,
+                      Mix_Music **o_music
+                     );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Waits for all the requested loads to finish and creates the textures while
+    ///        waiting. Needs to be called from the thread that owns the GL context.
+    // ---------------------------------------------------------------------------------------
+    void finish();
+
+  protected:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Image decoded by a worker, waiting to be uploaded in to its texture
+    // ---------------------------------------------------------------------------------------
+    typedef struct
+    {
+      SDL_Surface *m_surface;
+      GLuint *m_id;
+    } decodedTexture;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Worker threads
+    // ---------------------------------------------------------------------------------------
+    std::vector<std::thread> m_threads;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Loads waiting for a free worker, in the order they were requested
+    // ---------------------------------------------------------------------------------------
+    std::deque<std::function<void()> > m_jobs;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Decoded images waiting to be uploaded
+    // ---------------------------------------------------------------------------------------
+    std::vector<decodedTexture> m_decoded;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Amount of requested loads that haven't finished yet
+    // ---------------------------------------------------------------------------------------
+    int m_pending;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Tells the workers to stop once the queue is empty
+    // ---------------------------------------------------------------------------------------
+    bool m_quit;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Guards all of the above, m_wake wakes up the workers when there's a new load
+    ///        or they should stop and m_done wakes up finish() when a load has finished
+    // ---------------------------------------------------------------------------------------
+    std::mutex m_mutex;
+    std::condition_variable m_wake, m_done;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Adds a load to the queue and wakes up a worker for it
+    /// @param[in] _job Function that does the load
+    // ---------------------------------------------------------------------------------------
+    void push(
+              const std::function<void()> &_job
+             );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Loop of the worker threads, runs loads from the queue till told to stop
+    // ---------------------------------------------------------------------------------------
+    void worker();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief The threads can't be shared between copies
+    // ---------------------------------------------------------------------------------------
+    AssetLoader(const AssetLoader &);
+    AssetLoader &operator=(const AssetLoader &);
+}; // end of class
+
+#endif // end of ASSETLOADER_H
@@ -0,0 +1,136 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#ifndef ASTEROIDKERNEL_H
+#define ASTEROIDKERNEL_H
+
+// ---------------------------------------------------------------------------------------
+/// @file AsteroidKernel.h
+/// @brief Batched asteroid movement kernels. Each kernel moves a whole batch of asteroids
+///        stored as a structure of arrays, the ones still approaching towards the planet
+///        along their direction and the ones on the atmosphere around it. Both phases are
+///        calculated for every lane and blended so the SIMD versions don't branch. Like
+///        the particle kernels there's a scalar, an SSE and an AVX2 version, the fastest
+///        one supported by the cpu is chosen at runtime.
+/// @version 1.0
+/// @author Teemu Lindborg
+/// @date 03/05/15
+/// Revision History:
+///   -
+/// @todo Nothing for now
+// ---------------------------------------------------------------------------------------
+
+namespace asteroidKernel
+{
+  // ---------------------------------------------------------------------------------------
+  /// @brief Pointers to the asteroid arrays a kernel works on, all arrays hold _count
+  ///        elements
+  // ---------------------------------------------------------------------------------------
+  typedef struct
+  {
+    // ---------------------------------------------------------------------------------------
+    /// @brief Current positions, moved by the kernel
+    // ---------------------------------------------------------------------------------------
+    float *m_x, *m_y, *m_z;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Previous positions, the kernel stores the current positions here before moving
+    // ---------------------------------------------------------------------------------------
+    float *m_prevX, *m_prevY, *m_prevZ;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Directions the asteroids approach the planet along
+    // ---------------------------------------------------------------------------------------
+    const float *m_dirX, *m_dirY, *m_dirZ;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Up vectors, the asteroids on the atmosphere orbit around these
+    // ---------------------------------------------------------------------------------------
+    const float *m_upX, *m_upY, *m_upZ;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Speeds per simulation step, set to the orbiting speed on the atmosphere
+    // ---------------------------------------------------------------------------------------
+    float *m_speed;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Rotation angles and the angles before the latest move
+    // ---------------------------------------------------------------------------------------
+    float *m_rot, *m_prevRot;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief 1 if the asteroid has reached the atmosphere, 0 otherwise
+    // ---------------------------------------------------------------------------------------
+    int *m_onAtmosphere;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Amount of asteroids in the batch
+    // ---------------------------------------------------------------------------------------
+    int m_count;
+  } batch; // end of struct
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Kernel function signature
+  /// @param[io] io_b Asteroid arrays to update
+  /// @param[in] _scale Elapsed time relative to the simulation step (_dt / SIMSTEP)
+  /// @param[out] o_reached Indices of the asteroids that reached the atmosphere during
+  ///             this update, needs space for _count indices
+  /// @return Amount of indices written to o_reached
+  // ---------------------------------------------------------------------------------------
+  typedef int (*kernel)(const batch &io_b, const float _scale, int *o_reached);
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Plain C++ version of the kernel
+  // ---------------------------------------------------------------------------------------
+  int updateScalar(
+                   const batch &io_b,
+                   const float _scale,
+                   int *o_reached
+                  );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief SSE version of the kernel, 4 asteroids at a time. Only call if supported.
+  // ---------------------------------------------------------------------------------------
+  int updateSSE(
+                const batch &io_b,
+                const float _scale,
+                int *o_reached
+               );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief AVX2 version of the kernel, 8 asteroids at a time. Only call if supported.
+  // ---------------------------------------------------------------------------------------
+  int updateAVX2(
+                 const batch &io_b,
+                 const float _scale,
+                 int *o_reached
+                );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Checks the cpu features (CPUID) and returns the fastest supported kernel
+  /// @return The kernel to use
+  // ---------------------------------------------------------------------------------------
+  kernel select();
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Checks whether the cpu supports the given kernel
+  /// @param[in] _k Kernel to check
+  /// @return True if the kernel can be run on this cpu
+  // ---------------------------------------------------------------------------------------
+  bool supported(
+                 const kernel _k
+                );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Name of a kernel for printing
+  /// @param[in] _k Kernel to get the name of
+  /// @return "scalar", "sse" or "avx2"
+  // ---------------------------------------------------------------------------------------
+  const char *name(
+                   const kernel _k
+                  );
+} // end of namespace
+
+#endif // end of ASTEROIDKERNEL_H
@@ -8,12 +8,25 @@
 
 // ---------------------------------------------------------------------------------------
 /// @file Asteroids.h
-/// @brief Class used to define an asteroid and its attributes
+/// @brief Container holding all the asteroids and their attributes
 /// @version 1.0
 /// @author Teemu Lindborg
 /// @date 03/05/15
 /// Revision History:
-///   -
+///   - The update reports when the asteroid reaches the atmosphere so the world can keep
+///     track of the asteroids on it without searching for them.
+///   - The single Asteroid class was replaced with the AsteroidField that stores the
+///     attributes of all the asteroids in separate aligned arrays and moves them in
+///     batches with the SIMD asteroid kernels. The asteroids are still referred to with
+///     generational handles like in the slot map.
+///   - The slots and generations of the handles are kept by a SlotMap instead of the
+///     field itself.
+///   - All the asteroids are drawn with one instanced draw call per model, the position,
+///     size and rotation of each asteroid are streamed in to an instance buffer.
+///   - Only the asteroids with their bounding spheres in the view frustum are written to
+///     the instance buffer.
+///   - Each model has a chain of simplified meshes and every asteroid is drawn with the
+///     level matching its size on the screen.
 /// @todo Tidying up, maybe figure out a way to move the asteroids when they reach the
 ///       surface without having to do normalisation as much.
 // ---------------------------------------------------------------------------------------
@@ -23,110 +36,302 @@
 #endif
 #ifdef DARWIN
   #include <OpenGL/gl.h>
+  #include <OpenGL/glext.h>
 #endif
 
 #include <vector>
 
 #include "Defs.h"
+#include "AlignedAllocator.h"
+#include "AsteroidKernel.h"
+#include "SlotMap.h"
 #include "NCCA/Vec4.h"
 
-class Asteroid
+#ifndef HEADLESS
+  #include "Frustum.h"
+  #include "Mesh.h"
+#endif
+
+// Radius used for the collisions between projectiles and an asteroid relative to its size
+#define ASTEROIDHITSCALE 0.75f
+
+// Amount of different asteroid models
+#define ASTEROIDTYPES 2
+
+// Levels of detail of each asteroid model including the full one, each level has half
+// the triangles of the one before
+#define ASTEROIDLODS 4
+
+// Radius on the screen in pixels below which an asteroid is drawn with the first
+// simplified level, each following level is used below half the radius of the last
+#define ASTEROIDLODPIXELS 64.0f
+
+#ifndef HEADLESS
+// ---------------------------------------------------------------------------------------
+/// @brief Per instance data of an asteroid, position, scale factor and rotation angle
+// ---------------------------------------------------------------------------------------
+typedef struct
+{
+  GLfloat m_x, m_y, m_z, m_size;
+  GLfloat m_rot;
+} asteroidInstance;
+#endif
+
+class AsteroidField
 {
   public:
     // ---------------------------------------------------------------------------------------
-    /// @brief Position vector of an asteroid
+    /// @brief Positions of the asteroids
     // ---------------------------------------------------------------------------------------
-    Vec4 m_pos;
+    alignedFloats m_x, m_y, m_z;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Direction vector of an asteroid
+    /// @brief Positions of the asteroids before the latest move, used for interpolation
     // ---------------------------------------------------------------------------------------
-    Vec4 m_dir;
+    alignedFloats m_prevX, m_prevY, m_prevZ;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Up vector of an asteroid
+    /// @brief Direction vectors of the asteroids
     // ---------------------------------------------------------------------------------------
-    Vec4 m_up;
+    alignedFloats m_dirX, m_dirY, m_dirZ;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Side vector of an asteroid
+    /// @brief Up vectors of the asteroids, the asteroids on the atmosphere move around these
     // ---------------------------------------------------------------------------------------
-    Vec4 m_side;
+    alignedFloats m_upX, m_upY, m_upZ;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Scale factor of an asteroid
+    /// @brief Speeds of the asteroids
     // ---------------------------------------------------------------------------------------
-    float m_size;
+    alignedFloats m_speed;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Speed of an asteroid
+    /// @brief Rotation angles of the asteroids
     // ---------------------------------------------------------------------------------------
-    float m_speed;
+    alignedFloats m_rot;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Rotation angle of an asteroid
+    /// @brief Rotation angles of the asteroids before the latest move, used for interpolation
     // ---------------------------------------------------------------------------------------
-    float m_rot;
+    alignedFloats m_prevRot;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Health of an asteroid
+    /// @brief Scale factors of the asteroids
     // ---------------------------------------------------------------------------------------
-    int m_life;
+    alignedFloats m_size;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief 3d model
+    /// @brief 1 if the asteroid has reached the atmosphere and is moving along it
     // ---------------------------------------------------------------------------------------
-    int c_aType;
+    alignedInts m_onAtmosphere;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Default constructor for an asteroid
+    /// @brief Health of the asteroids
+    // ---------------------------------------------------------------------------------------
+    std::vector<int> m_life;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief 3d model of the asteroids
+    // ---------------------------------------------------------------------------------------
+    std::vector<int> m_type;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Ctor, reserves the space for the given amount of asteroids and selects the
+    ///        fastest kernel the cpu supports
+    /// @param[in] _capacity Amount of asteroids to reserve space for
+    // ---------------------------------------------------------------------------------------
+    AsteroidField(
+                  const int _capacity = 0
+                 );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Dtor, frees the instance buffer and the shader program
+    // ---------------------------------------------------------------------------------------
+    ~AsteroidField();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Adds an asteroid to the end of the arrays, reusing a free slot if there is one
     /// @param[in] _p Position vector
     /// @param[in] _d Direction vector
     /// @param[in] _up Up vector
-    /// @param[in] _side Side vector
     /// @param[in] _s Scale factor
     /// @param[in] _sp Speed value
     /// @param[in] _l Life/health
     /// @param[in] _t Asteroid type for different models
+    /// @return Handle to the added asteroid
+    // ---------------------------------------------------------------------------------------
+    handle insert(
+                  const Vec4 &_p,
+                  const Vec4 &_d,
+                  const Vec4 &_up,
+                  const float _s,
+                  const float _sp,
+                  const int _l,
+                  const int _t
+                 );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Removes an asteroid by moving the last asteroid in to its place in the arrays
+    ///        and frees its slot, does nothing if the handle is invalid
+    /// @param[in] _h Handle to the asteroid to remove
+    /// @return True if the asteroid was removed
     // ---------------------------------------------------------------------------------------
-    Asteroid(
-             const Vec4 &_p,
-             const Vec4 &_d,
-             const Vec4 &_up,
-             const Vec4 &_side,
-             const float _s,
-             const float _sp,
-             const float _l,
-             const int _t
-            ) :
-             m_pos(_p),
-             m_dir(_d),
-             m_up(_up),
-             m_side(_side),
-             m_size(_s),
-             m_speed(_sp),
-             m_rot(0.0),
-             m_life(_l),
-             c_aType(_t) {;}
+    bool remove(
+                const handle &_h
+               );
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Default destructor
+    /// @brief Checks whether a handle still refers to a living asteroid
+    /// @param[in] _h Handle to check
+    /// @return True if the asteroid is alive
     // ---------------------------------------------------------------------------------------
-    ~Asteroid() {}
+    bool valid(
+               const handle &_h
+              ) const;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Function that will call the correct displaylist, scale, rotate and translate
-    ///        the asteroid to its correct position
-    /// @param[in] _dL displaylist holding both asteroid models
+    /// @brief Moves all the asteroids with the selected kernel
+    /// @param[in] _dt Elapsed time in seconds, the speeds are given per SIMSTEP
+    /// @param[io] io_reached Filled with the indices of the asteroids that reached the
+    ///            atmosphere during this update, grown to the amount of asteroids if needed
+    /// @return Amount of asteroids that reached the atmosphere
+    // ---------------------------------------------------------------------------------------
+    int update(
+               const float _dt,
+               std::vector<int> &io_reached
+              );
+
+#ifndef HEADLESS
+    // ---------------------------------------------------------------------------------------
+    /// @brief Draws the asteroids in the view frustum. Writes the interpolated position,
+    ///        size and rotation of each visible asteroid in to the instance buffer grouped
+    ///        by the model and the level of detail for its projected size and draws each
+    ///        level once with all of its instances.
+    /// @param[in] _meshes Levels of detail of the asteroid models, one row for each type
+    /// @param[in] _alpha Interpolation factor between the previous and current position
+    /// @param[in] _frustum Planes of the view frustum
+    /// @param[io] io_counter The visible and culled asteroids are added here
     // ---------------------------------------------------------------------------------------
     void draw(
-              const std::vector<GLuint> &_dL
-             );
+              const Mesh _meshes[ASTEROIDTYPES][ASTEROIDLODS],
+              const float _alpha,
+              const frustum::planes &_frustum,
+              frustum::counter &io_counter
+             ) const;
+#endif
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Picks the level of detail for an asteroid
+    /// @param[in] _pixels Radius of the asteroid on the screen in pixels
+    /// @return Level of detail, 0 for the full model
+    // ---------------------------------------------------------------------------------------
+    static int lodLevel(
+                        const float _pixels
+                       );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the position of an asteroid
+    /// @param[in] _i Index in the arrays
+    /// @return Position vector
+    // ---------------------------------------------------------------------------------------
+    Vec4 position(const int _i) const { return Vec4(m_x[_i], m_y[_i], m_z[_i]); }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the array index of the asteroid in a slot without checking the
+    ///        generation, only for slot indices known to be alive
+    /// @param[in] _s Slot index of the asteroid
+    /// @return Index in the arrays
+    // ---------------------------------------------------------------------------------------
+    int indexOf(const int _s) const { return m_slots.indexOf(_s); }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the handle of an asteroid in the arrays
+    /// @param[in] _i Index in the arrays
+    /// @return Handle to the asteroid
+    // ---------------------------------------------------------------------------------------
+    handle handleAt(const int _i) const { return m_slots.handleAt(_i); }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the slot index of an asteroid in the arrays
+    /// @param[in] _i Index in the arrays
+    /// @return Slot index of the asteroid
+    // ---------------------------------------------------------------------------------------
+    int slotAt(const int _i) const { return m_slots.slotAt(_i); }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the amount of living asteroids
+    /// @return Amount of asteroids
+    // ---------------------------------------------------------------------------------------
+    int size() const { return (int)m_x.size(); }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Removes all the asteroids, all the existing handles become invalid
+    // ---------------------------------------------------------------------------------------
+    void clear();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Sets the kernel used for the updates
+    /// @param[in] _k Kernel to use, must be supported by the cpu
+    // ---------------------------------------------------------------------------------------
+    void setKernel(const asteroidKernel::kernel _k) { m_kernel = _k; }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the kernel used for the updates
+    /// @return The kernel in use
+    // ---------------------------------------------------------------------------------------
+    asteroidKernel::kernel getKernel() const { return m_kernel; }
+
+  protected:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Slots of the asteroids, the attribute arrays are kept in the order it says
+    // ---------------------------------------------------------------------------------------
+    SlotMap m_slots;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Kernel used to move the asteroids
+    // ---------------------------------------------------------------------------------------
+    asteroidKernel::kernel m_kernel;
+
+#ifndef HEADLESS
+    // ---------------------------------------------------------------------------------------
+    /// @brief Instance buffer, orphaned and refilled every frame
+    // ---------------------------------------------------------------------------------------
+    GLuint m_vbo;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Shader program that places and lights the instances
+    // ---------------------------------------------------------------------------------------
+    GLuint m_program;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Locations of the per instance attributes and the texture uniform
+    // ---------------------------------------------------------------------------------------
+    GLint m_instanceLoc, m_rotLoc, m_texLoc;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Interpolated positions and bounding radii packed for the culling kernel and
+    ///        the indices of the visible asteroids, filled in every frame
+    // ---------------------------------------------------------------------------------------
+    mutable alignedFloats m_drawX, m_drawY, m_drawZ, m_drawR;
+    mutable std::vector<int> m_visible;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Model and level of detail of each visible asteroid as type * ASTEROIDLODS +
+    ///        level, filled in every frame
+    // ---------------------------------------------------------------------------------------
+    mutable std::vector<int> m_batch;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Frustum culling kernel picked for the cpu
+    // ---------------------------------------------------------------------------------------
+    frustum::kernel m_cull;
+#endif
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Handles the movement of an asteroid
+    /// @brief The instance buffer and the shader program can't be shared between copies
     // ---------------------------------------------------------------------------------------
-    void move();
+    AsteroidField(const AsteroidField &);
+    AsteroidField &operator=(const AsteroidField &);
 }; // end of class
 
 #endif // end of ASTEROIDS_H
@@ -13,12 +13,14 @@
 /// @author Teemu Lindborg
 /// @date 03/05/15
 /// Revision History:
-///   -
+///   - The camera keeps its projection matrix and the frustum planes extracted from the
+///     matrices it loads, for culling what's drawn with them.
 /// @todo Understand the GL pipeline properly and load/use projection and modelview
 ///       matrices properly, thus possibly update the updateCamera() function
 // ---------------------------------------------------------------------------------------
 
 #include "Defs.h"
+#include "Frustum.h"
 #include "NCCA/Vec4.h"
 #define CAMRADIUS 6.0f
 
@@ -30,6 +32,11 @@ class Camera
     // ---------------------------------------------------------------------------------------
     Vec4 m_eye;
 
+    // ---------------------------------------------------------------------------------------
+    /// @brief Camera position before the latest update, used for interpolation
+    // ---------------------------------------------------------------------------------------
+    Vec4 m_prevEye;
+
     // ---------------------------------------------------------------------------------------
     /// @brief Vector holding the position to look at
     // ---------------------------------------------------------------------------------------
@@ -62,8 +69,19 @@ class Camera
 
     Mat4 orient;
 
+    // ---------------------------------------------------------------------------------------
+    /// @brief Projection matrix loaded with the orientation
+    // ---------------------------------------------------------------------------------------
+    Mat4 m_project;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Planes of the view frustum in world space, from the latest matrices loaded
+    // ---------------------------------------------------------------------------------------
+    frustum::planes m_frustum;
+
     Camera() :
               m_eye(0.0f, 0.0f, CAMRADIUS),
+              m_prevEye(0.0f, 0.0f, CAMRADIUS),
               m_look(0.0f, 0.0f, 0.0f),
               m_up(0.0f, 1.0f, 0.0f),
               m_w(1.0f, 0.0f, 0.0f),
@@ -84,8 +102,11 @@ class Camera
 
     // ---------------------------------------------------------------------------------------
     /// @brief Updates the camera based on the new position, look and up vectors
+    /// @param[in] _alpha Interpolation factor between the previous and current position
     // ---------------------------------------------------------------------------------------
-    void updateCamera();
+    void updateCamera(
+                      const float _alpha = 1.0f
+                     );
 
 }; // end of class
 
@@ -25,10 +25,19 @@
 #define ASPHERERADIUS 1.225f
 #define MOVESPEED 0.015f
 
+// Fixed simulation rate (updates per second) and timestep. All the per update movement
+// values (MOVESPEED, PROJECTILESPEED, asteroid speeds etc.) are tuned for this rate,
+// rendering runs independently of it and interpolates between the last two updates.
+#define SIMRATE 100
+#define SIMSTEP (1.0/SIMRATE)
+
 const static float TWO_PI = float(2 * M_PI);
 const static float PI = float(M_PI);
 const static float PI2 = float(M_PI/2.0);
 const static float PI4 = float(M_PI/4.0);
 const static int FIRE_PARTICLES = 10;
+const static int MAX_PARTICLES = 10000;
+const static int MAX_PROJECTILES = 128;
+const static int MAX_ASTEROIDS = 5000;
 
 #endif // end of DEFS_H
@@ -0,0 +1,194 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+// ---------------------------------------------------------------------------------------
+/// @file Frustum.h
+/// @brief View frustum culling. The six planes of the frustum are extracted from the
+///        camera's modelview and projection matrices and batches of bounding spheres
+///        stored as packed arrays are tested against them, writing out the ones that are
+///        at least partly inside. Like the narrowphase there's a scalar kernel and SSE and
+///        AVX2 versions testing 4 or 8 spheres at a time.
+/// @version 1.0
+/// @author Teemu Lindborg
+/// @date 03/05/15
+/// Revision History:
+///   - The focal length of the projection and the depth of a point can be taken from
+///     the planes for working out sizes on the screen.
+/// @todo Skip the near and far planes, nothing in the game gets close to either
+// ---------------------------------------------------------------------------------------
+
+#include "NCCA/Mat4.h"
+
+namespace frustum
+{
+  // ---------------------------------------------------------------------------------------
+  /// @brief Planes of the frustum, a point is inside a plane when
+  ///        a * x + b * y + c * z + d >= 0. The normals are unit length so that's the
+  ///        distance from the plane. In the order left, right, bottom, top, near, far.
+  // ---------------------------------------------------------------------------------------
+  typedef struct
+  {
+    float m_a[6], m_b[6], m_c[6], m_d[6];
+  } planes; // end of struct
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Pointers to the bounding sphere arrays a kernel tests, all arrays hold m_count
+  ///        elements
+  // ---------------------------------------------------------------------------------------
+  typedef struct
+  {
+    // ---------------------------------------------------------------------------------------
+    /// @brief Centers of the spheres
+    // ---------------------------------------------------------------------------------------
+    const float *m_x, *m_y, *m_z;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Radii of the spheres
+    // ---------------------------------------------------------------------------------------
+    const float *m_r;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Amount of spheres in the batch
+    // ---------------------------------------------------------------------------------------
+    int m_count;
+  } spheres; // end of struct
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Amount of items drawn and culled during a frame
+  // ---------------------------------------------------------------------------------------
+  typedef struct
+  {
+    int m_visible, m_culled;
+  } counter; // end of struct
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Counters of everything that goes through the culling, reset every frame
+  // ---------------------------------------------------------------------------------------
+  typedef struct
+  {
+    counter m_asteroids, m_trees, m_clouds, m_projectiles;
+  } counters; // end of struct
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Extracts the planes from the combined projection and modelview matrix (Gribb
+  ///        and Hartmann), each plane is the last row of the matrix plus or minus one of
+  ///        the others
+  /// @param[in] _modelView Modelview matrix the items are drawn with
+  /// @param[in] _projection Projection matrix
+  /// @return The normalised planes in the space the modelview matrix transforms from
+  // ---------------------------------------------------------------------------------------
+  planes extract(
+                 const Mat4 &_modelView,
+                 const Mat4 &_projection
+                );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Planes of the frustum in a space uniformly scaled by _s, e.g. for the planet
+  ///        drawn under glScalef
+  /// @param[in] _p Planes to scale
+  /// @param[in] _s Scale of the space
+  /// @return The planes in the scaled space
+  // ---------------------------------------------------------------------------------------
+  planes scale(
+               const planes &_p,
+               const float _s
+              );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Focal length of the projection the planes were extracted from, i.e. the
+  ///        cotangent of half the vertical field of view. The angle between the top and
+  ///        near planes is 90 degrees plus half the field of view, which doesn't change
+  ///        with the space the planes are in.
+  /// @param[in] _p Planes of the frustum
+  /// @return Focal length, the projected height of an object is its height times this
+  ///         divided by its depth in the half height of the viewport
+  // ---------------------------------------------------------------------------------------
+  float focalLength(
+                    const planes &_p
+                   );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Distance of a point in front of the near plane
+  /// @param[in] _p Planes of the frustum
+  /// @param[in] _x Position of the point in x
+  /// @param[in] _y Position of the point in y
+  /// @param[in] _z Position of the point in z
+  /// @return Signed distance from the near plane, negative behind it
+  // ---------------------------------------------------------------------------------------
+  float depth(
+              const planes &_p,
+              const float _x,
+              const float _y,
+              const float _z
+             );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Kernel function signature
+  /// @param[in] _p Planes of the frustum
+  /// @param[in] _s Spheres to test
+  /// @param[out] o_visible Indices of the spheres at least partly inside the frustum, in
+  ///             the order they're in the batch. Has to have room for _s.m_count indices.
+  /// @return Amount of visible spheres
+  // ---------------------------------------------------------------------------------------
+  typedef int (*kernel)(const planes &_p,
+                        const spheres &_s,
+                        int *o_visible);
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Plain C++ version of the kernel
+  // ---------------------------------------------------------------------------------------
+  int cullScalar(
+                 const planes &_p,
+                 const spheres &_s,
+                 int *o_visible
+                );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief SSE version of the kernel, 4 spheres at a time. Only call if supported.
+  // ---------------------------------------------------------------------------------------
+  int cullSSE(
+              const planes &_p,
+              const spheres &_s,
+              int *o_visible
+             );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief AVX2 version of the kernel, 8 spheres at a time. Only call if supported.
+  // ---------------------------------------------------------------------------------------
+  int cullAVX2(
+               const planes &_p,
+               const spheres &_s,
+               int *o_visible
+              );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Checks the cpu features (CPUID) and returns the fastest supported kernel
+  /// @return The kernel to use
+  // ---------------------------------------------------------------------------------------
+  kernel select();
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Checks whether the cpu supports the given kernel
+  /// @param[in] _k Kernel to check
+  /// @return True if the kernel can be run on this cpu
+  // ---------------------------------------------------------------------------------------
+  bool supported(
+                 const kernel _k
+                );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Name of a kernel for printing
+  /// @param[in] _k Kernel to get the name of
+  /// @return "scalar", "sse" or "avx2"
+  // ---------------------------------------------------------------------------------------
+  const char *name(
+                   const kernel _k
+                  );
+} // end of namespace
+
+#endif // end of FRUSTUM_H
@@ -0,0 +1,88 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#ifndef ICOSPHERE_H
+#define ICOSPHERE_H
+
+// ---------------------------------------------------------------------------------------
+/// @file Icosphere.h
+/// @brief Geodesic sphere built by subdividing an icosahedron. Every subdivision splits
+///        each triangle in to four at the midpoints of its edges and pushes the midpoints
+///        out on to the unit sphere. The midpoint of an edge is only created once and
+///        looked up by the edge afterwards, so the triangles share their vertices and
+///        refer to them by index. Used for the atmosphere and anything else round.
+/// @version 1.0
+/// @author Teemu Lindborg
+/// @date 03/05/15
+/// Revision History:
+///   -
+/// @todo Texture coordinates, the seam needs its vertices split
+// ---------------------------------------------------------------------------------------
+
+#include <vector>
+#include <unordered_map>
+
+#include "Mesh.h"
+#include "NCCA/Vec4.h"
+
+class Icosphere
+{
+  public:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Ctor, builds the sphere
+    /// @param[in] _subdivisions Amount of times the icosahedron is subdivided, the sphere
+    ///            has 20 * 4^n triangles and 10 * 4^n + 2 vertices
+    // ---------------------------------------------------------------------------------------
+    Icosphere(
+              const int _subdivisions
+             );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Default dtor
+    // ---------------------------------------------------------------------------------------
+    ~Icosphere() {}
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Adds the vertices and the triangles' indices in to a mesh as they are, with
+    ///        the normals pointing away from the centre and the current colour of the mesh.
+    ///        The triangles are wound counter clockwise seen from the outside.
+    /// @param[io] io_m Mesh the triangles are added to
+    /// @param[in] _radius Radius of the sphere
+    // ---------------------------------------------------------------------------------------
+    void addTo(
+               Mesh &io_m,
+               const float _radius = 1.0f
+              ) const;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the amount of triangles
+    /// @return Amount of triangles
+    // ---------------------------------------------------------------------------------------
+    int triangleCount() const { return (int)m_indices.size() / 3; }
+
+  protected:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Vertices on the unit sphere and the indices of the triangles
+    // ---------------------------------------------------------------------------------------
+    std::vector<Vec4> m_vertices;
+    std::vector<unsigned int> m_indices;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the vertex in the middle of an edge pushed out on to the sphere,
+    ///        creating it if the edge hasn't been split yet
+    /// @param[in] _a First end of the edge
+    /// @param[in] _b Second end of the edge
+    /// @param[io] io_midpoints Vertex in the middle of each edge split so far, keyed by the
+    ///            ends of the edge
+    /// @return Index of the vertex
+    // ---------------------------------------------------------------------------------------
+    unsigned int midpoint(
+                          const unsigned int _a,
+                          const unsigned int _b,
+                          std::unordered_map<unsigned long long, unsigned int> &io_midpoints
+                         );
+}; // end of class
+
+#endif // end of ICOSPHERE_H
@@ -15,7 +15,15 @@
 /// @author Teemu Lindborg
 /// @date 03/05/15
 /// Revision History:
-///   -
+///   - The parsed model data is written to a binary cache file next to the OBJ-file,
+///     later loads map the cache in and copy the arrays from it instead of parsing the
+///     text again.
+///   - The OBJ-files are parsed in place from a memory mapped file without allocating
+///     per line. The components are stored in the same order as the tokenizing parser
+///     did, which is the compiler's argument evaluation order.
+///   - The components are read in the order they're in the file on every compiler, gcc
+///     evaluated the tokenizing parser's arguments right to left which swapped x and z
+///     (and u and v) and rotated the ship and the skybox on Linux.
 /// @todo Nothing for now, maybe use namespaces and possibly tidy up the code. Possibly
 ///       turn this in to a mesh class that would have draw functions etc. For now
 ///       as depending on the mesh it might be handled differently the drawing will be
@@ -23,12 +31,11 @@
 // ---------------------------------------------------------------------------------------
 
 #include <string>
-#include <boost/tokenizer.hpp>
+#include <vector>
+#include <stdint.h>
 
 #include "NCCA/Vec4.h"
 
-typedef boost::tokenizer<boost::char_separator<char> >tokenizer;
-
 typedef struct
 {
   // ---------------------------------------------------------------------------------------
@@ -53,8 +60,32 @@ typedef struct
   std::vector<int> m_Ind;
 } model; // end of struct
 
+// Identifies the binary model cache files and the version of their layout, the version
+// needs to be bumped whenever the layout or the parsed data changes so the old caches
+// get rebuilt
+#define MODELCACHEMAGIC "SSMC"
+#define MODELCACHEVERSION 4
+
+// ---------------------------------------------------------------------------------------
+/// @brief Header of a binary model cache file. The header is followed by the vertices and
+///        normals as xyz floats, the texture coordinates as uv floats and the indices as
+///        uint32s, all tightly packed. The source OBJ-file's size, modification time and
+///        hash are stored so a stale cache is never used.
+// ---------------------------------------------------------------------------------------
+typedef struct
+{
+  char m_magic[4];
+  uint32_t m_version;
+  uint64_t m_sourceSize;
+  int64_t m_sourceMtime;
+  uint64_t m_sourceHash;
+  uint32_t m_vertCount, m_normCount, m_textCount, m_indCount;
+} modelCacheHeader; // end of struct
+
 // ---------------------------------------------------------------------------------------
-/// @brief Parse an OBJ-file and store the data in to the provided model structure
+/// @brief Loads the model data of an OBJ-file in to the provided model structure. The
+///        binary cache of the file is used if it's up to date, otherwise the OBJ-file is
+///        parsed and the cache is written for the next time.
 /// @param[in] _n Path to the OBJ-file
 /// @param[out] o_m Model structure to store the data in
 // ---------------------------------------------------------------------------------------
@@ -63,6 +94,50 @@ void loadModel(
                model &o_m
               );
 
+// ---------------------------------------------------------------------------------------
+/// @brief Parse an OBJ-file and store the data in to the provided model structure. The
+///        file is mapped in to memory and parsed in place in a single pass after a quick
+///        count of the elements to reserve the vectors with.
+/// @param[in] _n Path to the OBJ-file
+/// @param[out] o_m Model structure to store the data in
+// ---------------------------------------------------------------------------------------
+void parseOBJ(
+              const std::string &_n,
+              model &o_m
+             );
+
+// ---------------------------------------------------------------------------------------
+/// @brief Path of the binary cache file of an OBJ-file
+/// @param[in] _n Path to the OBJ-file
+/// @return Path to the cache file
+// ---------------------------------------------------------------------------------------
+std::string modelCachePath(
+                           const std::string &_n
+                          );
+
+// ---------------------------------------------------------------------------------------
+/// @brief Maps in the binary cache of an OBJ-file and copies the model data from it
+/// @param[in] _n Path to the OBJ-file
+/// @param[out] o_m Model structure to store the data in
+/// @return False if there's no cache or it doesn't match the current OBJ-file, o_m is
+///         left untouched then
+// ---------------------------------------------------------------------------------------
+bool loadModelCache(
+                    const std::string &_n,
+                    model &o_m
+                   );
+
+// ---------------------------------------------------------------------------------------
+/// @brief Writes the binary cache of an OBJ-file, failing to write it (e.g. read only
+///        directory) is not an error, the OBJ-file just gets parsed again next time
+/// @param[in] _n Path to the OBJ-file the model was loaded from
+/// @param[in] _m Model data to store
+// ---------------------------------------------------------------------------------------
+void saveModelCache(
+                    const std::string &_n,
+                    const model &_m
+                   );
+
 // ---------------------------------------------------------------------------------------
 /// @brief Function to clear the stl vectors and freeing up the memory used to store
 ///        the model data.
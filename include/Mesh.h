@@ -0,0 +1,466 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#ifndef MESH_H
+#define MESH_H
+
+// ---------------------------------------------------------------------------------------
+/// @file Mesh.h
+/// @brief Indexed triangle mesh stored in vertex and index buffers on the GPU. The mesh
+///        is built like an immediate mode glBegin(GL_TRIANGLES) stream, the colour, normal
+///        and texture coordinate are set as the current state and every vertex() call
+///        emits a vertex with it. Vertices with all the same attributes are only stored
+///        once and referred to with an index, so the shared vertices of a model go through
+///        the vertex cache instead of being sent for every triangle.
+/// @version 1.0
+/// @author Teemu Lindborg
+/// @date 03/05/15
+/// Revision History:
+///   - The triangles are reordered for the post-transform vertex cache before uploading
+///     (Tom Forsyth's linear-speed vertex cache optimisation) and the vertices are
+///     renumbered in the order they're first used. Meshes with up to 65536 vertices get
+///     16-bit indices. The builder keeps count of the vertices before and after
+///     welding and the ACMR before and after the reordering.
+///   - Meshes around the origin can be split in to spatial patches, each with a cone
+///     bounding the directions of its vertices and one bounding its face normals, so the
+///     patches behind the horizon of a sphere or facing away from the eye can be skipped
+///     when drawing.
+///   - The patches outside the view frustum are skipped as well and the mesh keeps the
+///     radius of the sphere around the origin bounding its vertices.
+///   - Simplified copies of a mesh can be built for levels of detail by collapsing the
+///     edges that change the surface the least (quadric error metrics).
+///   - Triangles that already share their vertices can be added with their indices as
+///     they are, skipping the welding.
+/// @todo Vertex array objects, the macOS 2.1 context only has the APPLE version of them
+// ---------------------------------------------------------------------------------------
+
+#ifdef LINUX
+  #include <GL/gl.h>
+#endif
+#ifdef DARWIN
+  #include <OpenGL/gl.h>
+  #include <OpenGL/glext.h>
+#endif
+
+#include <vector>
+#include <unordered_map>
+
+#include "Frustum.h"
+#include "LoadOBJ.h"
+#include "NCCA/Vec4.h"
+
+// Size of the LRU post-transform cache the triangle order is optimised for
+#define MESHCACHESIZE 32
+
+// Size of the FIFO cache the ACMR (average cache miss ratio, transformed vertices per
+// triangle) is measured with, about what the hardware of the time had
+#define MESHACMRCACHESIZE 16
+
+// Weight of the planes holding the open borders of a mesh in place when simplifying,
+// relative to the squared length of the border edge
+#define MESHBORDERWEIGHT 100.0
+
+// ---------------------------------------------------------------------------------------
+/// @brief Interleaved vertex of a mesh, the struct has no padding so the vertices can be
+///        hashed and compared as raw memory
+// ---------------------------------------------------------------------------------------
+typedef struct
+{
+  GLfloat m_x, m_y, m_z;
+  GLfloat m_nx, m_ny, m_nz;
+  GLfloat m_u, m_v;
+  GLubyte m_r, m_g, m_b, m_a;
+} meshVertex;
+
+// ---------------------------------------------------------------------------------------
+/// @brief Contiguous range of triangles in the index buffer with the cone around the
+///        origin bounding the directions of their vertices, the cone bounding their face
+///        normals and their bounding sphere
+// ---------------------------------------------------------------------------------------
+typedef struct
+{
+  // ---------------------------------------------------------------------------------------
+  /// @brief First index and amount of indices of the patch
+  // ---------------------------------------------------------------------------------------
+  int m_first, m_count;
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Unit axis of the direction cone
+  // ---------------------------------------------------------------------------------------
+  GLfloat m_x, m_y, m_z;
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Angle (radians) between the axis and the vertex furthest away from it
+  // ---------------------------------------------------------------------------------------
+  GLfloat m_angle;
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Distance of the furthest vertex from the origin
+  // ---------------------------------------------------------------------------------------
+  GLfloat m_radius;
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Unit axis of the normal cone and the angle (radians) between it and the face
+  ///        normal furthest away from it
+  // ---------------------------------------------------------------------------------------
+  GLfloat m_nx, m_ny, m_nz;
+  GLfloat m_normalAngle;
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Centre and radius of the bounding sphere
+  // ---------------------------------------------------------------------------------------
+  GLfloat m_cx, m_cy, m_cz;
+  GLfloat m_sphereRadius;
+} meshPatch;
+
+// ---------------------------------------------------------------------------------------
+/// @brief Hash of the raw bytes of a vertex (FNV-1a)
+// ---------------------------------------------------------------------------------------
+struct meshVertexHash
+{
+  size_t operator()(const meshVertex &_v) const;
+};
+
+// ---------------------------------------------------------------------------------------
+/// @brief Compares the raw bytes of two vertices
+// ---------------------------------------------------------------------------------------
+struct meshVertexEqual
+{
+  bool operator()(const meshVertex &_a, const meshVertex &_b) const;
+};
+
+class Mesh
+{
+  public:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Default ctor, the buffers are created when the mesh is uploaded
+    // ---------------------------------------------------------------------------------------
+    Mesh();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Dtor, deletes the buffers
+    // ---------------------------------------------------------------------------------------
+    ~Mesh();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Sets the colour of the following vertices, like glColor. The mesh only gets a
+    ///        colour array if this is called, otherwise the current GL colour is used when
+    ///        drawing.
+    /// @param[in] _r Red
+    /// @param[in] _g Green
+    /// @param[in] _b Blue
+    /// @param[in] _a Alpha
+    // ---------------------------------------------------------------------------------------
+    void colour(
+                const float _r,
+                const float _g,
+                const float _b,
+                const float _a = 1.0f
+               );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Sets the normal of the following vertices, like glNormal
+    /// @param[in] _n Normal
+    // ---------------------------------------------------------------------------------------
+    void normal(
+                const Vec4 &_n
+               );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Sets the texture coordinate of the following vertices, like glTexCoord. The
+    ///        mesh only gets a texture coordinate array if this is called.
+    /// @param[in] _t Texture coordinate in x and y
+    // ---------------------------------------------------------------------------------------
+    void texCoord(
+                  const Vec4 &_t
+                 );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Emits a vertex with the current colour, normal and texture coordinate, like
+    ///        glVertex. Every three vertices make a triangle.
+    /// @param[in] _p Position
+    // ---------------------------------------------------------------------------------------
+    void vertex(
+                const Vec4 &_p
+               );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Adds triangles that already share their vertices, the vertices are stored as
+    ///        they are with the current colour and texture coordinate and the indices are
+    ///        kept, so nothing needs to be welded. Later vertex() calls aren't welded with
+    ///        these vertices.
+    /// @param[in] _positions Position of each vertex
+    /// @param[in] _normals Normal of each vertex
+    /// @param[in] _vertexCount Amount of vertices
+    /// @param[in] _indices Three indices to the vertices for each triangle
+    /// @param[in] _indexCount Amount of indices
+    // ---------------------------------------------------------------------------------------
+    void addIndexed(
+                    const Vec4 *_positions,
+                    const Vec4 *_normals,
+                    const int _vertexCount,
+                    const GLuint *_indices,
+                    const int _indexCount
+                   );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Emits the triangles of a model with the vertex, texture coordinate and normal
+    ///        of each corner and the current colour
+    /// @param[in] _m Model to add
+    /// @param[in] _texCoords Whether to use the texture coordinates of the model
+    // ---------------------------------------------------------------------------------------
+    void addModel(
+                  const model &_m,
+                  const bool _texCoords
+                 );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Reorders the triangles for the vertex cache and renumbers the vertices in the
+    ///        order they're first used, measuring the ACMR before and after. Nothing can
+    ///        be added after this.
+    // ---------------------------------------------------------------------------------------
+    void optimize();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Splits the triangles in to spatial patches around the origin. Each triangle
+    ///        goes to a cell of a grid projected on the faces of a cube by the direction of
+    ///        its centre and the triangles are sorted so each cell is a contiguous range.
+    ///        Needs to be called before optimize(), which then keeps the ranges intact.
+    /// @param[in] _divisions Amount of cells along each edge of a cube face
+    // ---------------------------------------------------------------------------------------
+    void splitPatches(
+                      const int _divisions
+                     );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Builds a simplified copy of the mesh by collapsing edges in the order of the
+    ///        error they cause (Garland and Heckbert, Surface Simplification Using Quadric
+    ///        Error Metrics). Each vertex keeps the sum of the squared distances from the
+    ///        planes of its original triangles and an edge collapses on to whichever end
+    ///        is closer to the planes of both. Collapses that would flip a triangle or
+    ///        pinch the surface are skipped. The vertices are welded by position only, the
+    ///        corners keep their own attributes. Needs to be called before upload().
+    /// @param[in] _triangles Amount of triangles to simplify down to, fewer may be left
+    ///            as the collapses remove two triangles at a time or more if no more edges
+    ///            can be collapsed
+    /// @param[out] o_lod Empty mesh the simplified triangles are emitted in to
+    // ---------------------------------------------------------------------------------------
+    void simplify(
+                  const int _triangles,
+                  Mesh &o_lod
+                 ) const;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Finds the patches inside the view frustum and not hidden behind an opaque
+    ///        sphere around the origin. A
+    ///        point at distance r is behind the horizon when the angle between it and the
+    ///        eye is more than acos(R/d) + acos(R/r), d being the distance of the eye and
+    ///        R the radius of the sphere. Widened by the angle of the patch's cone this
+    ///        covers every vertex in the patch. The patches of a closed opaque mesh are
+    ///        also hidden when every triangle in them faces away from the eye, which is
+    ///        checked with the normal cone and the bounding sphere.
+    /// @param[in] _eye Position of the eye in the mesh's space
+    /// @param[in] _occluder Radius of the opaque sphere
+    /// @param[in] _closed Whether the mesh is part of a closed opaque surface, so the
+    ///            back facing patches can't be seen either
+    /// @param[in] _frustum Planes of the view frustum in the mesh's space
+    /// @param[out] o_visible 1 for the visible patches and 0 for the hidden ones
+    /// @return Amount of indices in the visible patches
+    // ---------------------------------------------------------------------------------------
+    int visiblePatches(
+                       const Vec4 &_eye,
+                       const float _occluder,
+                       const bool _closed,
+                       const frustum::planes &_frustum,
+                       std::vector<char> &o_visible
+                      ) const;
+
+#ifndef HEADLESS
+    // ---------------------------------------------------------------------------------------
+    /// @brief Optimizes the mesh if it hasn't been yet, creates the buffers from the emitted
+    ///        vertices and frees the memory used to build the mesh, nothing can be added
+    ///        after this
+    // ---------------------------------------------------------------------------------------
+    void upload();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Draws the mesh
+    // ---------------------------------------------------------------------------------------
+    void draw() const;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Draws the given amount of instances of the mesh, the per instance attributes
+    ///        need to be set up by the caller
+    /// @param[in] _instances Amount of instances
+    // ---------------------------------------------------------------------------------------
+    void drawInstanced(
+                       const int _instances
+                      ) const;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Draws the patches visiblePatches() finds, adjacent visible patches are drawn
+    ///        in one call. Draws the whole mesh if it hasn't been split.
+    /// @param[in] _eye Position of the eye in the mesh's space
+    /// @param[in] _occluder Radius of the opaque sphere
+    /// @param[in] _closed Whether the back facing patches can be skipped
+    /// @param[in] _frustum Planes of the view frustum in the mesh's space
+    /// @return Amount of patches drawn
+    // ---------------------------------------------------------------------------------------
+    int drawVisible(
+                    const Vec4 &_eye,
+                    const float _occluder,
+                    const bool _closed,
+                    const frustum::planes &_frustum
+                   ) const;
+#endif
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the amount of vertices handed to the mesh with vertex() and
+    ///        addIndexed(), i.e. the amount of vertices the mesh would have without welding
+    /// @return Amount of emitted vertices
+    // ---------------------------------------------------------------------------------------
+    int emittedCount() const { return m_emittedCount; }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the amount of unique vertices in the mesh
+    /// @return Amount of vertices
+    // ---------------------------------------------------------------------------------------
+    int vertexCount() const { return m_vertexCount; }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the amount of indices in the mesh, three for each triangle
+    /// @return Amount of indices
+    // ---------------------------------------------------------------------------------------
+    int indexCount() const { return m_indexCount; }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the amount of patches the mesh has been split in to
+    /// @return Amount of patches, 0 if the mesh hasn't been split
+    // ---------------------------------------------------------------------------------------
+    int patchCount() const { return (int)m_patches.size(); }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the radius of the sphere around the origin bounding the vertices
+    /// @return Distance of the furthest vertex from the origin
+    // ---------------------------------------------------------------------------------------
+    float radius() const { return m_radius; }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the ACMR of the triangles in the order they were emitted, valid after
+    ///        optimize()
+    /// @return Transformed vertices per triangle, between 0.5 and 3
+    // ---------------------------------------------------------------------------------------
+    float acmrBefore() const { return m_acmrBefore; }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the ACMR of the reordered triangles, valid after optimize()
+    /// @return Transformed vertices per triangle, between 0.5 and 3
+    // ---------------------------------------------------------------------------------------
+    float acmrAfter() const { return m_acmrAfter; }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the type of the indices in the index buffer
+    /// @return GL_UNSIGNED_SHORT if the vertices fit in 16 bits, GL_UNSIGNED_INT otherwise
+    // ---------------------------------------------------------------------------------------
+    GLenum indexType() const { return m_vertexCount <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT; }
+
+  protected:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Vertex currently being built, holds the current colour, normal and texture
+    ///        coordinate
+    // ---------------------------------------------------------------------------------------
+    meshVertex m_current;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Unique vertices and the indices of the triangles while building
+    // ---------------------------------------------------------------------------------------
+    std::vector<meshVertex> m_vertices;
+    std::vector<GLuint> m_indices;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Index of each unique vertex while building
+    // ---------------------------------------------------------------------------------------
+    std::unordered_map<meshVertex, GLuint, meshVertexHash, meshVertexEqual> m_lookup;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Whether the colour and texture coordinate arrays are used
+    // ---------------------------------------------------------------------------------------
+    bool m_hasColours, m_hasTexCoords;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Whether the mesh has been optimized
+    // ---------------------------------------------------------------------------------------
+    bool m_optimized;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Vertex and index buffers
+    // ---------------------------------------------------------------------------------------
+    GLuint m_vbo, m_ibo;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Amount of vertices and indices in the buffers
+    // ---------------------------------------------------------------------------------------
+    int m_vertexCount, m_indexCount;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Amount of vertices handed to the mesh before welding
+    // ---------------------------------------------------------------------------------------
+    int m_emittedCount;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief ACMR of the triangles before and after optimizing
+    // ---------------------------------------------------------------------------------------
+    float m_acmrBefore, m_acmrAfter;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Spatial patches of the mesh in the order they are in the index buffer
+    // ---------------------------------------------------------------------------------------
+    std::vector<meshPatch> m_patches;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Bounding spheres of the patches packed for the culling kernel
+    // ---------------------------------------------------------------------------------------
+    std::vector<float> m_sphereX, m_sphereY, m_sphereZ, m_sphereR;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Visibility of each patch, kept around so drawing doesn't allocate
+    // ---------------------------------------------------------------------------------------
+    mutable std::vector<char> m_visible;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Patches inside the frustum, written by the culling kernel
+    // ---------------------------------------------------------------------------------------
+    mutable std::vector<int> m_inside;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Radius of the sphere around the origin bounding the vertices
+    // ---------------------------------------------------------------------------------------
+    float m_radius;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Frustum culling kernel picked for the cpu
+    // ---------------------------------------------------------------------------------------
+    frustum::kernel m_cull;
+
+#ifndef HEADLESS
+    // ---------------------------------------------------------------------------------------
+    /// @brief Binds the buffers and sets up the arrays for drawing
+    // ---------------------------------------------------------------------------------------
+    void bind() const;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Disables the arrays and unbinds the buffers
+    // ---------------------------------------------------------------------------------------
+    void unbind() const;
+#endif
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief The buffers can't be shared between copies
+    // ---------------------------------------------------------------------------------------
+    Mesh(const Mesh &);
+    Mesh &operator=(const Mesh &);
+}; // end of class
+
+#endif // end of MESH_H
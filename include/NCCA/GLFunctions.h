@@ -14,7 +14,7 @@
 /// @author Jonathan Macey, minor modifications made by Teemu Lindborg
 /// @date 03/05/15
 /// Revision History:
-///   -
+///   - perspective() returns the projection matrix it loads so the camera can keep it
 /// @todo Maybe not necessary to have this stuff as an object but just have
 ///       'em in a namespace
 // ---------------------------------------------------------------------------------------
@@ -52,8 +52,9 @@ class GLFunctions
     /// @param[in] _aspect Aspect ratio
     /// @param[in] _zNear Near clipping plane
     /// @param[in] _zFar Far clipping plane
+    /// @return The projection matrix
     // ---------------------------------------------------------------------------------------
-    static void perspective(
+    static Mat4 perspective(
                             const float _fovy,
                             const float _aspect,
                             const float _zNear,
@@ -65,6 +65,7 @@ class Mat4
     // ---------------------------------------------------------------------------------------
     void identity();
 
+#ifndef HEADLESS
     // ---------------------------------------------------------------------------------------
     /// @brief Load gl modelview
     // ---------------------------------------------------------------------------------------
@@ -74,6 +75,7 @@ class Mat4
     /// @brief Load gl projection
     // ---------------------------------------------------------------------------------------
     void loadProjection() const;
+#endif
 
     // ---------------------------------------------------------------------------------------
     /// @brief Transpose matrix, switch from col major to row major and vice versa
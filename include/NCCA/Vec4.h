@@ -50,10 +50,12 @@ class Vec4
          m_z(_z),
          m_w(_w) {;}
 
+#ifndef HEADLESS
     // ---------------------------------------------------------------------------------------
     /// @brief Calls the current Vector as glColor4fv();
     // ---------------------------------------------------------------------------------------
     void colourGL() const;
+#endif
 
     // ---------------------------------------------------------------------------------------
     /// @brief Calculates the cross product between two vectors
@@ -85,6 +87,7 @@ class Vec4
     // ---------------------------------------------------------------------------------------
     float lengthSquared() const;
 
+#ifndef HEADLESS
     // ---------------------------------------------------------------------------------------
     /// @brief Calls the current vector as glNormal3f(m_x, m_y, m_z)
     // ---------------------------------------------------------------------------------------
@@ -104,6 +107,7 @@ class Vec4
     /// @brief Calls the current vector as glVertex3f(m_x, m_y, m_z)
     // ---------------------------------------------------------------------------------------
     void vertexGL() const;
+#endif
 
     // ---------------------------------------------------------------------------------------
     /// @brief Normalizes the vector
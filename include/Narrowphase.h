@@ -0,0 +1,132 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#ifndef NARROWPHASE_H
+#define NARROWPHASE_H
+
+// ---------------------------------------------------------------------------------------
+/// @file Narrowphase.h
+/// @brief Batched point-sphere collision tests. Each kernel tests a point against a batch
+///        of spheres stored as packed arrays using squared distances and writes out the
+///        ids of the spheres that were hit. There's a scalar version that works
+///        everywhere and SSE and AVX2 versions on x86, testing 4 or 8 spheres at a time.
+/// @version 1.0
+/// @author Teemu Lindborg
+/// @date 03/05/15
+/// Revision History:
+///   -
+/// @todo Test several points against a batch at once
+// ---------------------------------------------------------------------------------------
+
+namespace narrowphase
+{
+  // ---------------------------------------------------------------------------------------
+  /// @brief Pointers to the sphere arrays a kernel tests against, all arrays hold m_count
+  ///        elements
+  // ---------------------------------------------------------------------------------------
+  typedef struct
+  {
+    // ---------------------------------------------------------------------------------------
+    /// @brief Centers of the spheres
+    // ---------------------------------------------------------------------------------------
+    const float *m_x, *m_y, *m_z;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Squared radii of the spheres
+    // ---------------------------------------------------------------------------------------
+    const float *m_r2;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Ids written to the hit list for the spheres that are hit
+    // ---------------------------------------------------------------------------------------
+    const int *m_ids;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Amount of spheres in the batch
+    // ---------------------------------------------------------------------------------------
+    int m_count;
+  } spheres; // end of struct
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Kernel function signature
+  /// @param[in] _s Spheres to test against
+  /// @param[in] _x X component of the point to test
+  /// @param[in] _y Y component of the point to test
+  /// @param[in] _z Z component of the point to test
+  /// @param[in] _scale2 Squared scale applied to the radii, e.g. to test against a smaller
+  ///            radius than the spheres were packed with
+  /// @param[out] o_hits Ids of the spheres the point is inside of, in the order they're in
+  ///             the batch. Has to have room for _s.m_count ids.
+  /// @return Amount of hits
+  // ---------------------------------------------------------------------------------------
+  typedef int (*kernel)(const spheres &_s,
+                        const float _x,
+                        const float _y,
+                        const float _z,
+                        const float _scale2,
+                        int *o_hits);
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Plain C++ version of the kernel
+  // ---------------------------------------------------------------------------------------
+  int testScalar(
+                 const spheres &_s,
+                 const float _x,
+                 const float _y,
+                 const float _z,
+                 const float _scale2,
+                 int *o_hits
+                );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief SSE version of the kernel, 4 spheres at a time. Only call if supported.
+  // ---------------------------------------------------------------------------------------
+  int testSSE(
+              const spheres &_s,
+              const float _x,
+              const float _y,
+              const float _z,
+              const float _scale2,
+              int *o_hits
+             );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief AVX2 version of the kernel, 8 spheres at a time. Only call if supported.
+  // ---------------------------------------------------------------------------------------
+  int testAVX2(
+               const spheres &_s,
+               const float _x,
+               const float _y,
+               const float _z,
+               const float _scale2,
+               int *o_hits
+              );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Checks the cpu features (CPUID) and returns the fastest supported kernel
+  /// @return The kernel to use
+  // ---------------------------------------------------------------------------------------
+  kernel select();
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Checks whether the cpu supports the given kernel
+  /// @param[in] _k Kernel to check
+  /// @return True if the kernel can be run on this cpu
+  // ---------------------------------------------------------------------------------------
+  bool supported(
+                 const kernel _k
+                );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Name of a kernel for printing
+  /// @param[in] _k Kernel to get the name of
+  /// @return "scalar", "sse" or "avx2"
+  // ---------------------------------------------------------------------------------------
+  const char *name(
+                   const kernel _k
+                  );
+} // end of namespace
+
+#endif // end of NARROWPHASE_H
@@ -0,0 +1,124 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#ifndef PARTICLEKERNEL_H
+#define PARTICLEKERNEL_H
+
+// ---------------------------------------------------------------------------------------
+/// @file ParticleKernel.h
+/// @brief Batched particle integration kernels. Each kernel moves, ages and colours a
+///        whole batch of particles stored as a structure of arrays. There's a scalar
+///        version that works everywhere and SSE and AVX2 versions on x86, the fastest one
+///        supported by the cpu is chosen at runtime.
+/// @version 1.0
+/// @author Teemu Lindborg
+/// @date 03/05/15
+/// Revision History:
+///   -
+/// @todo Nothing for now
+// ---------------------------------------------------------------------------------------
+
+namespace particleKernel
+{
+  // ---------------------------------------------------------------------------------------
+  /// @brief Pointers to the particle arrays a kernel works on, all arrays hold _count
+  ///        elements
+  // ---------------------------------------------------------------------------------------
+  typedef struct
+  {
+    // ---------------------------------------------------------------------------------------
+    /// @brief Current positions, moved by the kernel
+    // ---------------------------------------------------------------------------------------
+    float *m_x, *m_y, *m_z;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Previous positions, the kernel stores the current positions here before moving
+    // ---------------------------------------------------------------------------------------
+    float *m_prevX, *m_prevY, *m_prevZ;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Movement amount on each axis, per simulation step
+    // ---------------------------------------------------------------------------------------
+    const float *m_velX, *m_velY, *m_velZ;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Elapsed life in simulation steps, increased by the kernel
+    // ---------------------------------------------------------------------------------------
+    float *m_life;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief 1 / maximum life, to avoid divisions when calculating the colours
+    // ---------------------------------------------------------------------------------------
+    const float *m_invMaxLife;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Green and blue colour components written by the kernel, red is always 1 and
+    ///        alpha is the same as green
+    // ---------------------------------------------------------------------------------------
+    float *m_g, *m_b;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Amount of particles in the batch
+    // ---------------------------------------------------------------------------------------
+    int m_count;
+  } batch; // end of struct
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Kernel function signature
+  /// @param[io] io_b Particle arrays to update
+  /// @param[in] _scale Elapsed time relative to the simulation step (_dt / SIMSTEP)
+  // ---------------------------------------------------------------------------------------
+  typedef void (*kernel)(const batch &io_b, const float _scale);
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Plain C++ version of the kernel
+  // ---------------------------------------------------------------------------------------
+  void updateScalar(
+                    const batch &io_b,
+                    const float _scale
+                   );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief SSE version of the kernel, 4 particles at a time. Only call if supported.
+  // ---------------------------------------------------------------------------------------
+  void updateSSE(
+                 const batch &io_b,
+                 const float _scale
+                );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief AVX2 version of the kernel, 8 particles at a time. Only call if supported.
+  // ---------------------------------------------------------------------------------------
+  void updateAVX2(
+                  const batch &io_b,
+                  const float _scale
+                 );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Checks the cpu features (CPUID) and returns the fastest supported kernel
+  /// @return The kernel to use
+  // ---------------------------------------------------------------------------------------
+  kernel select();
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Checks whether the cpu supports the given kernel
+  /// @param[in] _k Kernel to check
+  /// @return True if the kernel can be run on this cpu
+  // ---------------------------------------------------------------------------------------
+  bool supported(
+                 const kernel _k
+                );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Name of a kernel for printing
+  /// @param[in] _k Kernel to get the name of
+  /// @return "scalar", "sse" or "avx2"
+  // ---------------------------------------------------------------------------------------
+  const char *name(
+                   const kernel _k
+                  );
+} // end of namespace
+
+#endif // end of PARTICLEKERNEL_H
@@ -8,12 +8,15 @@
 
 // ---------------------------------------------------------------------------------------
 /// @file Particles.h
-/// @brief Class for a simple particle
+/// @brief Fixed capacity pool for the fire particles, stored as a structure of arrays
 /// @version 1.0
 /// @author Teemu Lindborg
 /// @date 03/05/15
 /// Revision History:
-///   -
+///   - Particles are stored in a preallocated structure of arrays pool instead of an stl
+///     vector of particle objects, dead particles are swap-removed.
+///   - The integration is done in batches by the fastest particle kernel the cpu supports.
+///   - The particles are drawn from a streamed vertex buffer with a single draw call.
 /// @todo Make the "sprouting" of better
 // ---------------------------------------------------------------------------------------
 
@@ -24,69 +27,164 @@
   #include <OpenGL/gl.h>
 #endif
 
-#include <iostream>
+#include <vector>
 
+#include "Defs.h"
+#include "ParticleKernel.h"
 #include "NCCA/Vec4.h"
 
-class Particle
+#ifndef HEADLESS
+// ---------------------------------------------------------------------------------------
+/// @brief Vertex of a particle in the streamed vertex buffer, position and RGBA colour
+// ---------------------------------------------------------------------------------------
+typedef struct
+{
+  GLfloat m_x, m_y, m_z;
+  GLubyte m_r, m_g, m_b, m_a;
+} particleVertex;
+#endif
+
+class ParticlePool
 {
   public:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Ctor for the pool, allocates the space for all the particles up front
+    /// @param[in] _capacity Maximum amount of living particles
+    // ---------------------------------------------------------------------------------------
+    ParticlePool(
+                 const int _capacity = MAX_PARTICLES
+                );
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Holds the elapsed life of a particle
+    /// @brief Dtor, frees the vertex buffer
+    // ---------------------------------------------------------------------------------------
+    ~ParticlePool();
+
     // ---------------------------------------------------------------------------------------
-    int m_life;
+    /// @brief Spawns particles to the given position with random movement. If the pool is
+    ///        full the rest of the particles are not spawned.
+    /// @param[in] _p Initial position of the particles
+    /// @param[in] _amount Amount of particles to spawn
+    /// @param[in] _l Maximum lifetime of the particles, in simulation steps
+    // ---------------------------------------------------------------------------------------
+    void emit(
+              const Vec4 &_p,
+              const int _amount,
+              const float _l
+             );
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Holds the maximum lifetime of a particle
+    /// @brief Moves, ages and colours all the particles with the particle kernel and then
+    ///        kills the ones that have reached their maximum lifetime by swapping the last
+    ///        living particle in to their place
+    /// @param[in] _dt Elapsed time in seconds, the movement is given per SIMSTEP
     // ---------------------------------------------------------------------------------------
-    int m_max_life;
+    void update(
+                const float _dt
+               );
 
+#ifndef HEADLESS
     // ---------------------------------------------------------------------------------------
-    /// @brief Default ctor for a particle
-    /// @param[in] _p Vector for initial position of the particle
-    /// @param[in] _l Maximum lifetime of the given particle
+    /// @brief Writes the interpolated positions and colours of the living particles in to
+    ///        the vertex buffer and draws them as GL_POINTS with a single draw call. The
+    ///        buffer is orphaned every frame so we never wait for the gpu to finish
+    ///        reading the previous frame's particles.
+    /// @param[in] _alpha Interpolation factor between the previous and current positions
     // ---------------------------------------------------------------------------------------
-    Particle(
-             const Vec4 &_p,
-             const int _l = 0
-            ) :
-             m_life(0),
-             m_max_life(_l),
-             m_pos(_p)
-            {
-              // Generate random values on how much the particle moves each frame in which axis
-              m_moveX = 0.01 * (std::rand()/(float)RAND_MAX * 2 - 1);
-              m_moveY = 0.01 * (std::rand()/(float)RAND_MAX * 2 - 1);
-              m_moveZ = 0.01 * (std::rand()/(float)RAND_MAX * 2 - 1);
-            }
+    void draw(
+              const float _alpha
+             ) const;
+#endif
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Default dtor
+    /// @brief Kills all the particles
     // ---------------------------------------------------------------------------------------
-    ~Particle() {}
+    void clear();
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Draws and calculates the color of the particle based on elapsed life
-    ///        relative to its maximum lifetime
+    /// @brief Returns the amount of living particles
+    /// @return Amount of living particles
     // ---------------------------------------------------------------------------------------
-    void draw();
+    int size() const { return m_count; }
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Moves the particle after it's born
+    /// @brief Returns the maximum amount of living particles
+    /// @return Capacity of the pool
     // ---------------------------------------------------------------------------------------
-    void move();
+    int capacity() const { return m_capacity; }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Sets the kernel used for the updates, by default the fastest supported one is
+    ///        selected when the pool is created
+    /// @param[in] _k Kernel to use, must be supported by the cpu
+    // ---------------------------------------------------------------------------------------
+    void setKernel(const particleKernel::kernel _k) { m_kernel = _k; }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the kernel used for the updates
+    /// @return The kernel in use
+    // ---------------------------------------------------------------------------------------
+    particleKernel::kernel getKernel() const { return m_kernel; }
 
   protected:
     // ---------------------------------------------------------------------------------------
-    /// @brief Variables holding the movement amount on each axis for a particle
+    /// @brief Maximum and current amount of living particles
+    // ---------------------------------------------------------------------------------------
+    int m_capacity, m_count;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Positions of the particles
+    // ---------------------------------------------------------------------------------------
+    std::vector<float> m_x, m_y, m_z;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Positions of the particles before the latest update, used for interpolation
+    // ---------------------------------------------------------------------------------------
+    std::vector<float> m_prevX, m_prevY, m_prevZ;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Movement amount on each axis for the particles, per simulation step
+    // ---------------------------------------------------------------------------------------
+    std::vector<float> m_velX, m_velY, m_velZ;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Elapsed and maximum lifetime of the particles, in simulation steps, and the
+    ///        inverse of the maximum lifetime used for the colour calculations
+    // ---------------------------------------------------------------------------------------
+    std::vector<float> m_life, m_maxLife, m_invMaxLife;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Green and blue colour components of the particles, calculated in the updates
+    // ---------------------------------------------------------------------------------------
+    std::vector<float> m_g, m_b;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Kernel used to update the particles
+    // ---------------------------------------------------------------------------------------
+    particleKernel::kernel m_kernel;
+
+#ifndef HEADLESS
+    // ---------------------------------------------------------------------------------------
+    /// @brief Vertex buffer the particles are streamed in to for drawing
+    // ---------------------------------------------------------------------------------------
+    GLuint m_vbo;
+#endif
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Copies the particle from one slot to another
+    /// @param[in] _from Index of the particle to copy
+    /// @param[in] _to Index of the slot to copy the particle to
     // ---------------------------------------------------------------------------------------
-    float m_moveX, m_moveY, m_moveZ;
+    void move(
+              const int _from,
+              const int _to
+             );
 
     // ---------------------------------------------------------------------------------------
-    /// @brief The actual position vector of a particle
+    /// @brief The vertex buffer can't be shared between copies
     // ---------------------------------------------------------------------------------------
-    Vec4 m_pos;
+    ParticlePool(const ParticlePool &);
+    ParticlePool &operator=(const ParticlePool &);
 }; // end of class
 
 #endif // end of PARTICLES_H
@@ -13,7 +13,18 @@
 /// @author Teemu Lindborg
 /// @date 03/05/15
 /// Revision History:
-///   -
+///   - The planet elements are stored in indexed meshes instead of displaylists.
+///   - The models are loaded through the asset loader and the meshes are generated
+///     separately once they've been loaded.
+///   - The trees are baked in to one static mesh when the planet is generated instead of
+///     being oriented and drawn one by one every frame.
+///   - The clouds are drawn instanced in one draw call, the axis, starting angle and scale
+///     of each cloud are in a static instance buffer and the rotation is done in the
+///     vertex shader from the elapsed time.
+///   - The planet meshes are split in to patches and the ones behind the horizon of the
+///     planet's solid core are skipped when drawing.
+///   - The planet and tree patches outside the view frustum are skipped and the clouds
+///     are skipped when the sphere around the whole cloud layer is outside of it.
 /// @todo Fine tune the height based vertex coloring on the surface. Also figure out
 ///       how to have the transparent water accumulate the color of the waterbottoms
 ///       beneath it to give it more depth.
@@ -24,20 +35,33 @@
 #endif
 #ifdef DARWIN
   #include <OpenGL/gl.h>
+  #include <OpenGL/glext.h>
 #endif
 
 #include <vector>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int_distribution.hpp>
 
+#include "Defs.h"
+#include "AssetLoader.h"
+#include "Frustum.h"
 #include "LoadOBJ.h"
+#include "Mesh.h"
 #include "NCCA/Vec4.h"
 
+// Rotation of the clouds (degrees) per simulation step
+#define CLOUDSPEED 0.1f
+
+// Patches along each edge of a cube face the planet meshes are split in to for culling
+// the ones behind the horizon
+#define PLANETPATCHDIVISIONS 6
+
 class Planet
 {
   public:
     // ---------------------------------------------------------------------------------------
-    /// @brief Default ctor for the planet. Loads the models and calls the generator functions
+    /// @brief Default ctor for the planet, picks the amount of clouds. The models are loaded
+    ///        with loadAssets() and the meshes generated with initAssets().
     // ---------------------------------------------------------------------------------------
     Planet();
 
@@ -47,10 +71,38 @@ class Planet
     ~Planet();
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Calls the correct displaylists, translates, performs rotations and scaling and
+    /// @brief Requests the planet, tree and cloud models to be loaded
+    /// @param[io] io_assets Loader to load the models with
+    // ---------------------------------------------------------------------------------------
+    void loadAssets(
+                    AssetLoader &io_assets
+                   );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Calls the generator functions once the models have been loaded
+    // ---------------------------------------------------------------------------------------
+    void initAssets();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Rotates the clouds around the planet
+    /// @param[in] _dt Elapsed time in seconds, the rotation speed is given per SIMSTEP
+    // ---------------------------------------------------------------------------------------
+    void update(
+                const float _dt
+               );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Draws the correct meshes, translates, performs rotations and scaling and
     ///        draws all the planet elements.
+    /// @param[in] _alpha Interpolation factor between the last two updates
+    /// @param[in] _frustum Planes of the view frustum in the planet's space
+    /// @param[io] io_counters The visible and culled tree patches and clouds are added here
     // ---------------------------------------------------------------------------------------
-    void draw();
+    void draw(
+              const float _alpha,
+              const frustum::planes &_frustum,
+              frustum::counters &io_counters
+             ) const;
 
   protected:
     // ---------------------------------------------------------------------------------------
@@ -93,23 +145,26 @@ class Planet
     // ---------------------------------------------------------------------------------------
     model m_cloudGeometry;
 
+    // ---------------------------------------------------------------------------------------
+    /// @brief Per instance attributes of a cloud in the instance buffer
+    // ---------------------------------------------------------------------------------------
     typedef struct
     {
       // ---------------------------------------------------------------------------------------
-      /// @brief Vector for the rotation axis of a cloud
+      /// @brief Rotation axis of a cloud
       // ---------------------------------------------------------------------------------------
-      Vec4 m_rAxis;
+      GLfloat m_x, m_y, m_z;
 
       // ---------------------------------------------------------------------------------------
-      /// @brief Rotation angle of a cloud
+      /// @brief Rotation angle of a cloud at the start in degrees
       // ---------------------------------------------------------------------------------------
-      float m_rot;
+      GLfloat m_rot;
 
       // ---------------------------------------------------------------------------------------
       /// @brief Scale factor of a cloud
       // ---------------------------------------------------------------------------------------
-      float m_scale;
-    } m_cloud;
+      GLfloat m_scale;
+    } cloudInstance;
 
     // ---------------------------------------------------------------------------------------
     /// @brief stl vector used to store the location of each tree
@@ -117,24 +172,53 @@ class Planet
     std::vector<Vec4> tree_positions;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief stl vector used to store the cloud data
+    /// @brief Simulation steps the clouds have rotated for, wrapped to a full turn
+    // ---------------------------------------------------------------------------------------
+    float m_cloudSteps;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Static instance buffer holding the axis, starting angle and scale of each cloud
+    // ---------------------------------------------------------------------------------------
+    GLuint m_cloudVbo;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Radius of the sphere around the planet's centre that all the clouds stay
+    ///        inside of however they're turned
+    // ---------------------------------------------------------------------------------------
+    float m_cloudShellRadius;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Shader program that places and lights the cloud instances and the locations
+    ///        of its attributes and uniforms
+    // ---------------------------------------------------------------------------------------
+    GLuint m_cloudProgram;
+    GLint m_cloudLoc, m_cloudScaleLoc, m_cloudAngleLoc;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Meshes of the planet's elements
+    // ---------------------------------------------------------------------------------------
+    Mesh m_surfaceMesh, m_mountainMesh, m_seabedMesh, m_waterMesh;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Radius of the largest sphere inside the opaque surface and seabeds, anything
+    ///        behind its horizon is hidden
     // ---------------------------------------------------------------------------------------
-    std::vector<m_cloud> clouds;
+    float m_occluderRadius;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief stl vector holding the displaylists for the planet's elements
+    /// @brief Frustum culling kernel picked for the cpu
     // ---------------------------------------------------------------------------------------
-    std::vector<GLuint> p_displayList;
+    frustum::kernel m_cull;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief stl vector holding the displaylists for the clouds
+    /// @brief Mesh of the clouds
     // ---------------------------------------------------------------------------------------
-    std::vector<GLuint> c_displayList;
+    Mesh m_cloudMesh;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief stl vector holding the displaylists for the trees
+    /// @brief All the trees on the surface baked in to one mesh
     // ---------------------------------------------------------------------------------------
-    std::vector<GLuint> t_displayList;
+    Mesh m_treeMesh;
 
     // ---------------------------------------------------------------------------------------
     /// @brief Boost random number generator
@@ -142,35 +226,38 @@ class Planet
     boost::mt19937 rng;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Loads the the planet's surface to a displaylist and adjusts the vertex colors
+    /// @brief Loads the the planet's surface to a mesh and adjusts the vertex colors
     ///        based on the distance/"height" of the vertex
     // ---------------------------------------------------------------------------------------
     void genSurface();
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Loads the planet's mountains to a displaylist and does some minor height
+    /// @brief Loads the planet's mountains to a mesh and does some minor height
     ///        based coloring
     // ---------------------------------------------------------------------------------------
     void genMountains();
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Loads the water surfaces to a displaylist and sets 'em to be a bit transparent
+    /// @brief Loads the water surfaces to a mesh and sets 'em to be a bit transparent
     // ---------------------------------------------------------------------------------------
     void genWaters();
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Loads the seabeds to a displaylist and does minor height based coloring
+    /// @brief Loads the seabeds to a mesh and does minor height based coloring
     // ---------------------------------------------------------------------------------------
     void genSeabeds();
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Loads the tree leaves and trunk data to a displaylist
+    /// @brief Bakes a tree at every position in tree_positions in to one mesh, oriented to
+    ///        point away from the planet's centre with the leaf colours alternating. Needs
+    ///        to be called after genSurface().
     // ---------------------------------------------------------------------------------------
     void genTree();
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Loads the cloud model(s) to a displaylist and generates the positions and
-    ///        random rotation axes for each cloud
+    /// @brief Loads the cloud model(s) to a mesh, generates the random rotation axes,
+    ///        angles and sizes for each cloud in to the instance buffer and loads the
+    ///        cloud shader
     // ---------------------------------------------------------------------------------------
     void genClouds();
 }; // end of class
@@ -15,7 +15,10 @@
 /// @author Teemu Lindborg
 /// @date 03/05/15
 /// Revision History:
-///   -
+///   - Collisions are tested against the asteroids in the same atmosphere grid cell with
+///     the packed narrowphase kernels.
+///   - The model, textures and sounds are loaded through the asset loader.
+///   - The projectiles outside the view frustum aren't drawn.
 /// @todo Tidy the code a lot. Reorganize and possibly divide some of the functionality to
 ///       separate classes/files, like explosions, collision detection.
 // ---------------------------------------------------------------------------------------
@@ -27,18 +30,27 @@
   #include <OpenGL/gl.h>
 #endif
 
-#include <SDL2/SDL.h>
+#ifndef HEADLESS
+  #include <SDL2/SDL.h>
+#endif
+
 #include <vector>
-#include <list>
 
 #include "Camera.h"
-#include "Audio.h"
+#include "Particles.h"
 #include "Projectile.h"
 #include "LoadOBJ.h"
-#include "TextureOBJ.h"
 #include "Asteroids.h"
+#include "SphereGrid.h"
 #include "NCCA/Vec4.h"
 
+#ifndef HEADLESS
+  #include "Audio.h"
+  #include "AssetLoader.h"
+  #include "Mesh.h"
+  #include "TextureOBJ.h"
+#endif
+
 // This will be used to lift the player a bit above the planet's surface
 #define PLAYEROFFSET 0.1f
 
@@ -50,11 +62,11 @@ class Player
 {
   public:
     // ---------------------------------------------------------------------------------------
-    /// @brief stl vector holding the live particles that are born from collision:
+    /// @brief Pool holding the live particles that are born from collision:
     ///        asteroid-projectile &
     ///        asteroid-player
     // ---------------------------------------------------------------------------------------
-    std::vector<Particle> m_particles;
+    ParticlePool m_particles;
 
     // ---------------------------------------------------------------------------------------
     /// @brief Player's score
@@ -62,8 +74,8 @@ class Player
     int m_score;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Constructor for the player that loads the model, textures, audio and initialises
-    ///        the player class member variables
+    /// @brief Constructor for the player that initialises the player class member variables.
+    ///        The model, textures and audio are loaded with loadAssets() and initAssets().
     /// @param[in] _x Initial x pos
     /// @param[in] _y Initial y pos
     /// @param[in] _z Initial z pos
@@ -87,10 +99,52 @@ class Player
     bool isAlive();
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Calls the displaylist with the ship model in and handles the translates and
+    /// @brief Returns the pool of the living projectiles
+    /// @return Projectile pool of the player
+    // ---------------------------------------------------------------------------------------
+    const ProjectilePool &getProjectiles() const { return m_p; }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Sets the aim direction and whether the player is firing. Used by the input
+    ///        handling and by the headless simulation to drive the player.
+    /// @param[in] _dir Aim direction angle in radians
+    /// @param[in] _fire True if the player should be firing
+    // ---------------------------------------------------------------------------------------
+    void setAim(
+                const float _dir,
+                const bool _fire
+               );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Advances the player's simulation by one step: fires a new projectile if the
+    ///        player is shooting, updates the projectiles and particles and kills the ones
+    ///        that have reached their maximum lifetime. Does no rendering.
+    /// @param[in] _dt Elapsed time in seconds, normally SIMSTEP
+    // ---------------------------------------------------------------------------------------
+    void update(
+                const float _dt
+               );
+
+#ifndef HEADLESS
+    // ---------------------------------------------------------------------------------------
+    /// @brief Requests the ship model, textures and sounds to be loaded
+    /// @param[io] io_assets Loader to load the assets with
+    // ---------------------------------------------------------------------------------------
+    void loadAssets(
+                    AssetLoader &io_assets
+                   );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Generates the ship's mesh and starts the background noise once the assets
+    ///        have been loaded
+    // ---------------------------------------------------------------------------------------
+    void initAssets();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Draws the ship mesh and handles the translates and
     ///        rotations of the player
     // ---------------------------------------------------------------------------------------
-    void drawPlayer();
+    void drawPlayer() const;
 
     // ---------------------------------------------------------------------------------------
     /// @brief Handles the movement of the player (camera) and calculates the new up and side
@@ -105,27 +159,43 @@ class Player
                         SDL_GameController *_c,
                         Camera &io_cam
                        );
+#endif
 
     // ---------------------------------------------------------------------------------------
     /// @brief Checks for collisions between player-asteroids and projectiles-asteroids.
-    ///        A primitive spatial partitioning is used where the collisions are only
-    ///        checked against asteroids that have reached the atmosphere.
-    /// @param[io] io_a stl vector holding all the asteroids
-    /// @param[io] io_aInd stl list holding the indices of the asteroids that have reached
-    ///                the atmosphere
+    ///        The collisions are only checked against the asteroids on the atmosphere
+    ///        that are binned in to the same grid cell as the projectile or the player.
+    /// @param[io] io_a Field holding all the asteroids
+    /// @param[in] _grid Grid the asteroids that have reached the atmosphere are binned in to
+    ///            by their slot index
     // ---------------------------------------------------------------------------------------
     void checkCollisions(
-                         std::vector<Asteroid> &io_a,
-                         std::list<int> &io_aInd
+                         AsteroidField &io_a,
+                         const SphereGrid &_grid
                         );
 
+#ifndef HEADLESS
+    // ---------------------------------------------------------------------------------------
+    /// @brief Draws the living projectiles in the view frustum as point sprites with a
+    ///        single draw call, the sprites are sized by the shader
+    /// @param[in] _alpha Interpolation factor between the last two updates
+    /// @param[in] _frustum Planes of the view frustum
+    /// @param[io] io_counter The visible and culled projectiles are added here
+    // ---------------------------------------------------------------------------------------
+    void drawProjectiles(
+                         const float _alpha,
+                         const frustum::planes &_frustum,
+                         frustum::counter &io_counter
+                        ) const;
+
     // ---------------------------------------------------------------------------------------
-    /// @brief Runs through the living particles vector calls for the draw and move functions
-    ///        of a particle, also increases the elapsed life and checks whether it has reached
-    ///        the max lifespan of the particle. Kills the particles when they've reach the max
-    ///        life.
+    /// @brief Sets up the point sprites and calls the draw function of the particle pool
+    /// @param[in] _alpha Interpolation factor between the last two updates
     // ---------------------------------------------------------------------------------------
-    void drawParticles();
+    void drawParticles(
+                       const float _alpha
+                      ) const;
+#endif
 
   protected:
     // ---------------------------------------------------------------------------------------
@@ -140,19 +210,26 @@ class Player
     Mat4 m_orientation;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Model structure holding the ship model data.
+    /// @brief Camera's up and left vectors from the latest movement update, used to fire
+    ///        the projectiles
     // ---------------------------------------------------------------------------------------
-    model m_ship;
+    Vec4 m_camUp, m_camLeft;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Pool storing the living projectile data.
+    // ---------------------------------------------------------------------------------------
+    ProjectilePool m_p;
 
+#ifndef HEADLESS
     // ---------------------------------------------------------------------------------------
-    /// @brief stl vector storing the living projectile data.
+    /// @brief Model structure holding the ship model data.
     // ---------------------------------------------------------------------------------------
-    std::vector<Projectile> m_p;
+    model m_ship;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief stl vector holding displaylist for the ship
+    /// @brief Mesh of the ship
     // ---------------------------------------------------------------------------------------
-    std::vector<GLuint> m_displayList;
+    Mesh m_shipMesh;
 
     // ---------------------------------------------------------------------------------------
     /// @brief Audio chunk for the firing sound
@@ -163,6 +240,7 @@ class Player
     /// @brief Music data storing the noise that's played when the player moves
     // ---------------------------------------------------------------------------------------
     Mix_Music *s_bgSound;
+#endif
 
     // ---------------------------------------------------------------------------------------
     /// @brief Aim direction angle for shooting
@@ -190,6 +268,23 @@ class Player
     // ---------------------------------------------------------------------------------------
     int m_life;
 
+    // ---------------------------------------------------------------------------------------
+    /// @brief Whether the player is currently shooting
+    // ---------------------------------------------------------------------------------------
+    bool m_firing;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Narrowphase kernel used for the collision tests, the fastest one the cpu
+    ///        supports
+    // ---------------------------------------------------------------------------------------
+    narrowphase::kernel m_narrowphase;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Hit list written by the narrowphase, grown to the size of the largest cell
+    // ---------------------------------------------------------------------------------------
+    std::vector<int> m_hits;
+
+#ifndef HEADLESS
     // ---------------------------------------------------------------------------------------
     /// @brief Used to store the texture data of the ship
     // ---------------------------------------------------------------------------------------
@@ -206,9 +301,10 @@ class Player
     GLuint m_particleTexId;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Generates the ship's displaylist from the model data
+    /// @brief Generates the ship's mesh from the model data
     // ---------------------------------------------------------------------------------------
     void ship();
+#endif
 
     // ---------------------------------------------------------------------------------------
     /// @brief Wraps degrees to positive values between 0 & 360
@@ -219,19 +315,23 @@ class Player
                      );
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Handles the actual shooting, whenever the player is shooting pushes projectiles
-    ///        in to the stl vector and stores the players current position, up, left and
-    ///        normal vectors, aim direction
+    /// @brief Spawns a new projectile in to the fixed capacity projectile pool with the
+    ///        players current position, camera up, left and normal vectors and the aim
+    ///        direction. The shot is dropped if the pool is full.
+    // ---------------------------------------------------------------------------------------
+    void fire();
+
+#ifndef HEADLESS
+    // ---------------------------------------------------------------------------------------
+    /// @brief Reads the shooting input and updates the aim direction and whether the player
+    ///        is shooting
     /// @param[in] _c Game controller structure, used as the primary device controlling device
     ///               if it's not NULL
-    /// @param[in] _cu Camera's current up vector
-    /// @param[in] _cl Camera's current left vector
     // ---------------------------------------------------------------------------------------
     void shoot(
-               SDL_GameController *_c,
-               const Vec4 &_cu,
-               const Vec4 &_cl
+               SDL_GameController *_c
               );
+#endif
 
 };
 
@@ -14,20 +14,58 @@
 /// @author Teemu Lindborg
 /// @date 03/05/15
 /// Revision History:
-///   -
+///   - Living projectiles are kept in a fixed capacity pool, dead ones are retired by
+///     swapping the last living projectile in to their slot.
+///   - All the projectiles are drawn with a single draw call of point sprites that are
+///     sized and mapped to the sprite sheet in shaders.
+///   - Only the projectiles with their trails in the view frustum are written to the
+///     vertex buffer.
 /// @todo Tidying up. Changing the projectiles so that they would look like more of a
 ///       stream of particles (slow moving laser sort of effect)
 // ---------------------------------------------------------------------------------------
 
+#ifdef LINUX
+  #include <GL/gl.h>
+#endif
+#ifdef DARWIN
+  #include <OpenGL/gl.h>
+#endif
+
 #include <vector>
 
-#include "LoadOBJ.h"
-#include "Particles.h"
+#include "Defs.h"
 #include "NCCA/Vec4.h"
 
+#ifndef HEADLESS
+  #include "Frustum.h"
+#endif
+
 // Set the projectile movement speed
 #define PROJECTILESPEED 0.1
 
+// Amount of iterations per update for a projectile to have it move "smoothly" between two
+// points rather than skipping certain positions, also the amount of sprites in the trail
+#define PROJECTILESTEPS 3
+
+// Side length of a projectile sprite in world units
+#define PROJECTILESIZE 0.1f
+
+// Amount of sprites on each row and column of the projectile sprite sheet
+#define PROJECTILESHEETDIM 5
+
+#ifndef HEADLESS
+// ---------------------------------------------------------------------------------------
+/// @brief Vertex of a projectile sprite in the streamed vertex buffer, position, corner
+///        of the sprite's cell in the sprite sheet and RGBA colour
+// ---------------------------------------------------------------------------------------
+typedef struct
+{
+  GLfloat m_x, m_y, m_z;
+  GLfloat m_u, m_v;
+  GLubyte m_r, m_g, m_b, m_a;
+} projectileVertex;
+#endif
+
 class Projectile
 {
   public:
@@ -36,6 +74,12 @@ class Projectile
     // ---------------------------------------------------------------------------------------
     Vec4 m_pos;
 
+    // ---------------------------------------------------------------------------------------
+    /// @brief Position of the projectile before the latest move, used to draw the trail
+    ///        between the two positions
+    // ---------------------------------------------------------------------------------------
+    Vec4 m_prevPos;
+
     // ---------------------------------------------------------------------------------------
     /// @brief Up vector of a projectile
     // ---------------------------------------------------------------------------------------
@@ -57,14 +101,14 @@ class Projectile
     float m_dir;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Elapsed life of a particle
+    /// @brief Elapsed life of a projectile, in simulation steps
     // ---------------------------------------------------------------------------------------
-    int m_life;
+    float m_life;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Maximum life of a particle
+    /// @brief Maximum life of a projectile, in simulation steps
     // ---------------------------------------------------------------------------------------
-    int m_maxLife;
+    float m_maxLife;
 
     // ---------------------------------------------------------------------------------------
     /// @brief Constructor for a projectile, initialises all the attributes
@@ -94,6 +138,7 @@ class Projectile
                const float &_ml
               ) :
                m_pos(_px, _py, _pz),
+               m_prevPos(_px, _py, _pz),
                m_up(_u),
                m_left(_l),
                m_normal(_nx, _ny, _nz),
@@ -107,17 +152,161 @@ class Projectile
     ~Projectile() {}
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Function that moves, animates the sprite and draws a projectile
-    /// @param[in] _itAmt Amount of iterations to for a projectile to have it move "smoothly"
-    ///                   move between two points rather than skipping certain positions
-    /// @param[in] _cu Up vector of the camera, used to bilboard the projectile
-    /// @param[in] _cl Up vector of the camera, used to bilboard the projectile
+    /// @brief Moves the projectile along the atmosphere and increases its elapsed life
+    /// @param[in] _dt Elapsed time in seconds, the speed is given per SIMSTEP
+    // ---------------------------------------------------------------------------------------
+    void update(
+                const float _dt
+               );
+
+#ifndef HEADLESS
+    // ---------------------------------------------------------------------------------------
+    /// @brief Writes the projectile as a trail of PROJECTILESTEPS sprites between the
+    ///        previous and the current position. The sprite is animated based on the
+    ///        elapsed life of the projectile.
+    /// @param[in] _alpha Interpolation factor between the previous and current position
+    /// @param[out] o_v Vertices to write the PROJECTILESTEPS sprites in to
+    // ---------------------------------------------------------------------------------------
+    void writeSprites(
+                      const float _alpha,
+                      projectileVertex *o_v
+                     ) const;
+#endif
+}; // end of class
+
+class ProjectilePool
+{
+  public:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Ctor for the pool, reserves the space for all the projectiles up front so
+    ///        the storage is never reallocated during play
+    /// @param[in] _capacity Maximum amount of living projectiles
+    // ---------------------------------------------------------------------------------------
+    ProjectilePool(
+                   const int _capacity = MAX_PROJECTILES
+                  );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Default dtor
+    // ---------------------------------------------------------------------------------------
+    ~ProjectilePool();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Adds a projectile to the first free slot at the end of the living ones
+    /// @param[in] _p Projectile to add
+    /// @return False if the pool was full and the projectile was dropped
+    // ---------------------------------------------------------------------------------------
+    bool spawn(
+               const Projectile &_p
+              );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Retires a projectile by moving the last living one in to its slot, the
+    ///        order of the projectiles is not kept
+    /// @param[in] _i Index of the projectile to retire
+    // ---------------------------------------------------------------------------------------
+    void kill(
+              const int _i
+             );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Moves all the projectiles and retires the ones that have reached their
+    ///        maximum lifetime
+    /// @param[in] _dt Elapsed time in seconds
+    // ---------------------------------------------------------------------------------------
+    void update(
+                const float _dt
+               );
+
+#ifndef HEADLESS
+    // ---------------------------------------------------------------------------------------
+    /// @brief Writes the sprites of the living projectiles in the view frustum in to the
+    ///        vertex buffer and draws them with a single draw call. The vertex shader
+    ///        sizes the point sprites and the fragment shader maps them to their cell in
+    ///        the sprite sheet that's bound to the texture unit 0.
+    /// @param[in] _alpha Interpolation factor between the last two updates
+    /// @param[in] _frustum Planes of the view frustum
+    /// @param[io] io_counter The visible and culled projectiles are added here
+    // ---------------------------------------------------------------------------------------
+    void draw(
+              const float _alpha,
+              const frustum::planes &_frustum,
+              frustum::counter &io_counter
+             ) const;
+#endif
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Retires all the projectiles, the high-water mark is kept
+    // ---------------------------------------------------------------------------------------
+    void clear() { m_p.clear(); }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the amount of living projectiles
+    /// @return Amount of living projectiles
+    // ---------------------------------------------------------------------------------------
+    int size() const { return (int)m_p.size(); }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the maximum amount of living projectiles
+    /// @return Capacity of the pool
+    // ---------------------------------------------------------------------------------------
+    int capacity() const { return m_capacity; }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the largest amount of projectiles that have been alive at once
+    /// @return High-water mark of the pool
+    // ---------------------------------------------------------------------------------------
+    int highWaterMark() const { return m_highWater; }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Access to the living projectiles, valid indices are [0, size())
+    /// @param[in] _i Index of the projectile
+    /// @return Reference to the projectile
+    // ---------------------------------------------------------------------------------------
+    Projectile &operator[](const int _i) { return m_p[_i]; }
+    const Projectile &operator[](const int _i) const { return m_p[_i]; }
+
+  protected:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Maximum amount of living projectiles and the most that have been alive at once
+    // ---------------------------------------------------------------------------------------
+    int m_capacity, m_highWater;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Living projectiles packed to the start of the reserved storage, the reserved
+    ///        slots past the end are the free ones and get reused by spawn()
+    // ---------------------------------------------------------------------------------------
+    std::vector<Projectile> m_p;
+
+#ifndef HEADLESS
+    // ---------------------------------------------------------------------------------------
+    /// @brief Vertex buffer the sprites are streamed in to and the program drawing them
+    // ---------------------------------------------------------------------------------------
+    GLuint m_vbo, m_program;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Locations of the uniforms of the program
+    // ---------------------------------------------------------------------------------------
+    GLint m_sizeLoc, m_viewportLoc, m_cellLoc, m_texLoc;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Spheres bounding the trails packed for the culling kernel and the indices of
+    ///        the visible projectiles, filled in every frame
+    // ---------------------------------------------------------------------------------------
+    mutable std::vector<float> m_drawX, m_drawY, m_drawZ, m_drawR;
+    mutable std::vector<int> m_visible;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Frustum culling kernel picked for the cpu
+    // ---------------------------------------------------------------------------------------
+    frustum::kernel m_cull;
+#endif
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief The vertex buffer and the shader program can't be shared between copies
     // ---------------------------------------------------------------------------------------
-    void drawProjectile(
-                        const int _itAmt,
-                        const Vec4 &_cu,
-                        const Vec4 &_cl
-                       );
+    ProjectilePool(const ProjectilePool &);
+    ProjectilePool &operator=(const ProjectilePool &);
 }; // end of class
 
 #endif // end of PROJECTILE_H
@@ -85,14 +85,16 @@ class SDL_GL
     bool isActive() const;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Handles basic input and calls the functions that handle movement etc.
-    /// @param[io] io_p Player object so we can call the movement functions
-    /// @param[io] io_cam Camera object to be used for movement and calculations
-    // ---------------------------------------------------------------------------------------
-    void handleInput(
-                     Player &io_p,
-                     Camera &io_cam
-                    );
+    /// @brief Checks if the window is minimized, used to skip the rendering
+    /// @return True if the window is minimized
+    // ---------------------------------------------------------------------------------------
+    bool isMinimized() const;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Handles the basic input events (quitting, polygon mode), called once per
+    ///        rendered frame. The player movement is handled in the simulation updates.
+    // ---------------------------------------------------------------------------------------
+    void handleInput();
 
   protected:
     // ---------------------------------------------------------------------------------------
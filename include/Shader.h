@@ -0,0 +1,39 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#ifndef SHADER_H
+#define SHADER_H
+
+// ---------------------------------------------------------------------------------------
+/// @file Shader.h
+/// @brief Function that loads, compiles and links a GLSL program from a vertex and a
+///        fragment shader file
+/// @version 1.0
+/// @author Teemu Lindborg
+/// @date 03/05/15
+/// Revision History:
+///   -
+/// @todo Cache the uniform locations by name
+// ---------------------------------------------------------------------------------------
+
+#ifdef LINUX
+  #include <GL/gl.h>
+#endif
+#ifdef DARWIN
+  #include <OpenGL/gl.h>
+#endif
+
+#include <string>
+
+// ---------------------------------------------------------------------------------------
+/// @brief Loads and compiles the shaders and links them in to a program, prints out the
+///        info log and exits if anything fails
+/// @param[in] _vert Path to the vertex shader source
+/// @param[in] _frag Path to the fragment shader source
+/// @return Id of the linked program
+// ---------------------------------------------------------------------------------------
+GLuint loadShaderProgram(const std::string &_vert, const std::string &_frag);
+
+#endif // end of SHADER_H
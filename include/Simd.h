@@ -0,0 +1,116 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#ifndef SIMD_H
+#define SIMD_H
+
+// ---------------------------------------------------------------------------------------
+/// @file Simd.h
+/// @brief Runtime selection shared by the batched kernels. Each kernel module has a
+///        scalar, an SSE and an AVX2 version of its kernel, these check which of them the
+///        cpu can run, pick the fastest one and name them for printing.
+/// @version 1.0
+/// @author Teemu Lindborg
+/// @date 03/05/15
+/// Revision History:
+///   -
+/// @todo Nothing for now
+// ---------------------------------------------------------------------------------------
+
+// The SSE and AVX2 kernels are only compiled for x86, elsewhere they fall back to the
+// scalar ones
+#if defined(__x86_64__) || defined(__i386__)
+  #define SIMD_X86
+  #include <immintrin.h>
+#endif
+
+namespace simd
+{
+  // ---------------------------------------------------------------------------------------
+  /// @brief Instruction sets the kernels are written for
+  // ---------------------------------------------------------------------------------------
+  typedef enum
+  {
+    SCALAR,
+    SSE,
+    AVX2
+  } level; // end of enum
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Checks the cpu features (CPUID) for an instruction set
+  /// @param[in] _l Instruction set to check
+  /// @return True if the cpu supports it
+  // ---------------------------------------------------------------------------------------
+  bool supported(
+                 const level _l
+                );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Name of an instruction set for printing
+  /// @param[in] _l Instruction set to get the name of
+  /// @return "scalar", "sse" or "avx2"
+  // ---------------------------------------------------------------------------------------
+  const char *name(
+                   const level _l
+                  );
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Finds which version of a kernel a kernel pointer is
+  /// @param[in] _k Kernel to check
+  /// @param[in] _sse SSE version of the kernel
+  /// @param[in] _avx2 AVX2 version of the kernel
+  /// @return The instruction set of the kernel, anything else is taken as scalar
+  // ---------------------------------------------------------------------------------------
+  template <typename kernel>
+  level levelOf(
+                const kernel _k,
+                const kernel _sse,
+                const kernel _avx2
+               )
+  {
+    if(_k == _avx2)
+      return AVX2;
+    if(_k == _sse)
+      return SSE;
+    return SCALAR;
+  }
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Picks the fastest version of a kernel the cpu supports
+  /// @param[in] _scalar Plain C++ version of the kernel
+  /// @param[in] _sse SSE version of the kernel
+  /// @param[in] _avx2 AVX2 version of the kernel
+  /// @return The kernel to use
+  // ---------------------------------------------------------------------------------------
+  template <typename kernel>
+  kernel select(
+                const kernel _scalar,
+                const kernel _sse,
+                const kernel _avx2
+               )
+  {
+    if(supported(AVX2))
+      return _avx2;
+    if(supported(SSE))
+      return _sse;
+    return _scalar;
+  }
+
+#ifdef SIMD_X86
+  // ---------------------------------------------------------------------------------------
+  /// @brief Clears the upper halves of the AVX registers. gcc doesn't add vzeroupper to
+  ///        functions that only get AVX through the target attribute, so the AVX2 kernels
+  ///        call this before they run the scalar kernel on their tail and return to the
+  ///        non-VEX code, which would otherwise pay for the AVX-SSE transitions.
+  // ---------------------------------------------------------------------------------------
+  __attribute__((target("avx")))
+  inline void zeroUpper()
+  {
+    _mm256_zeroupper();
+  }
+#endif
+} // end of namespace
+
+#endif // end of SIMD_H
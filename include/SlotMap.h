@@ -0,0 +1,196 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+// ---------------------------------------------------------------------------------------
+/// @file SlotMap.h
+/// @brief Generational slot map. The elements are stored densely for iteration and are
+///        referred to with handles made of a slot index and a generation. The map only
+///        keeps the slots, the owner stores the elements in its own dense arrays (e.g. a
+///        structure of arrays) and moves them the same way the map says. A slot keeps its
+///        index while its element is alive and the generation is bumped when the element
+///        is removed, so a handle to a removed element is detected as invalid instead of
+///        pointing to whatever got stored in the slot afterwards. Inserting and removing
+///        are O(1), removing moves the last element in to the removed one's place.
+/// @version 1.0
+/// @author Teemu Lindborg
+/// @date 03/05/15
+/// Revision History:
+///   - The map only does the slot and generation bookkeeping so the asteroid field can
+///     keep its attributes in separate arrays, the element storage was dropped.
+/// @todo Nothing for now
+// ---------------------------------------------------------------------------------------
+
+#include <vector>
+
+// ---------------------------------------------------------------------------------------
+/// @brief Handle to an element of a slot map
+// ---------------------------------------------------------------------------------------
+typedef struct
+{
+  // ---------------------------------------------------------------------------------------
+  /// @brief Index of the slot, stays the same as long as the element is alive
+  // ---------------------------------------------------------------------------------------
+  int m_index;
+
+  // ---------------------------------------------------------------------------------------
+  /// @brief Generation of the slot when the handle was created
+  // ---------------------------------------------------------------------------------------
+  unsigned int m_generation;
+} handle;
+
+class SlotMap
+{
+  public:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Ctor, reserves the space for the given amount of elements
+    /// @param[in] _capacity Amount of elements to reserve space for
+    // ---------------------------------------------------------------------------------------
+    SlotMap(
+            const int _capacity = 0
+           )
+    {
+      m_dataSlot.reserve(_capacity);
+      m_slots.reserve(_capacity);
+    }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Default dtor
+    // ---------------------------------------------------------------------------------------
+    ~SlotMap() {}
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Gives a slot to an element added to the end of the dense arrays, reusing a
+    ///        free slot if there is one. The caller appends the element's data.
+    /// @return Handle to the added element
+    // ---------------------------------------------------------------------------------------
+    handle insert()
+    {
+      int s;
+      if(m_free.empty())
+      {
+        s = (int)m_slots.size();
+        slot n = {0, 0u};
+        m_slots.push_back(n);
+      }
+      else
+      {
+        s = m_free.back();
+        m_free.pop_back();
+      }
+
+      m_slots[s].m_dense = size();
+      m_dataSlot.push_back(s);
+
+      handle h = {s, m_slots[s].m_generation};
+      return h;
+    }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Frees the slot of an element and moves the last element in to its place in
+    ///        the dense arrays, does nothing if the handle is invalid. The caller moves the
+    ///        last element's data to the returned index the same way and drops the last.
+    /// @param[in] _h Handle to the element to remove
+    /// @return Index of the removed element in the dense arrays, -1 if the handle was
+    ///         invalid
+    // ---------------------------------------------------------------------------------------
+    int remove(
+               const handle &_h
+              )
+    {
+      if(!valid(_h))
+        return -1;
+
+      int dense = m_slots[_h.m_index].m_dense;
+      m_dataSlot[dense] = m_dataSlot.back();
+      m_dataSlot.pop_back();
+      if(dense < size())
+        m_slots[m_dataSlot[dense]].m_dense = dense;
+
+      // Bumping the generation invalidates all the handles to the removed element
+      ++m_slots[_h.m_index].m_generation;
+      m_free.push_back(_h.m_index);
+
+      return dense;
+    }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Checks whether a handle still refers to a living element
+    /// @param[in] _h Handle to check
+    /// @return True if the element is alive
+    // ---------------------------------------------------------------------------------------
+    bool valid(
+               const handle &_h
+              ) const
+    {
+      return _h.m_index >= 0 && _h.m_index < (int)m_slots.size() &&
+             m_slots[_h.m_index].m_generation == _h.m_generation;
+    }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the dense index of the element in a slot without checking the
+    ///        generation, only for slot indices known to be alive, e.g. ones collected
+    ///        from the map during this update
+    /// @param[in] _s Slot index of the element
+    /// @return Index in the dense arrays
+    // ---------------------------------------------------------------------------------------
+    int indexOf(const int _s) const { return m_slots[_s].m_dense; }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the handle of an element in the dense arrays
+    /// @param[in] _i Index in the dense arrays
+    /// @return Handle to the element
+    // ---------------------------------------------------------------------------------------
+    handle handleAt(
+                    const int _i
+                   ) const
+    {
+      handle h = {m_dataSlot[_i], m_slots[m_dataSlot[_i]].m_generation};
+      return h;
+    }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the slot index of an element in the dense arrays
+    /// @param[in] _i Index in the dense arrays
+    /// @return Slot index of the element
+    // ---------------------------------------------------------------------------------------
+    int slotAt(const int _i) const { return m_dataSlot[_i]; }
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the amount of living elements
+    /// @return Amount of elements
+    // ---------------------------------------------------------------------------------------
+    int size() const { return (int)m_dataSlot.size(); }
+
+  protected:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Slot of the map, position of its element in the dense arrays and the current
+    ///        generation
+    // ---------------------------------------------------------------------------------------
+    typedef struct
+    {
+      int m_dense;
+      unsigned int m_generation;
+    } slot;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Slot index of each element in the dense arrays
+    // ---------------------------------------------------------------------------------------
+    std::vector<int> m_dataSlot;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief All the slots ever used
+    // ---------------------------------------------------------------------------------------
+    std::vector<slot> m_slots;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Indices of the slots without an element
+    // ---------------------------------------------------------------------------------------
+    std::vector<int> m_free;
+}; // end of class
+
+#endif // end of SLOTMAP_H
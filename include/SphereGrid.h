@@ -0,0 +1,149 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#ifndef SPHEREGRID_H
+#define SPHEREGRID_H
+
+// ---------------------------------------------------------------------------------------
+/// @file SphereGrid.h
+/// @brief Spatial hash over the surface of a sphere used as the collision broadphase on
+///        the atmosphere. The sphere is divided in to the six faces of a cube map and each
+///        face in to a grid of cells. Objects are binned in to every cell their bounding
+///        box projects on to so a point only needs to be tested against its own cell.
+/// @version 1.0
+/// @author Teemu Lindborg
+/// @date 03/05/15
+/// Revision History:
+///   - The centers and squared radii are packed per cell so the narrowphase can test a
+///     whole cell at once.
+/// @todo Bin the projectiles as well and walk the cells instead of the projectiles
+// ---------------------------------------------------------------------------------------
+
+#include <vector>
+
+#include "Narrowphase.h"
+#include "NCCA/Vec4.h"
+
+// Amount of cells on each row and column of a cube map face
+#define SPHEREGRIDRES 8
+
+class SphereGrid
+{
+  public:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Ctor for the grid
+    /// @param[in] _res Amount of cells on each row and column of a cube map face
+    // ---------------------------------------------------------------------------------------
+    SphereGrid(
+               const int _res = SPHEREGRIDRES
+              );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Default dtor
+    // ---------------------------------------------------------------------------------------
+    ~SphereGrid() {}
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Removes all the objects from the grid, the allocated memory is kept for the
+    ///        next frame
+    // ---------------------------------------------------------------------------------------
+    void clear();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Bins an object in to all the cells its bounding box projects on to. Any
+    ///        point within the radius of the object, at any distance from the origin, falls
+    ///        in to one of the cells. build() has to be called after all the objects are
+    ///        inserted.
+    /// @param[in] _id Id of the object, e.g. index to an array
+    /// @param[in] _pos Position of the object
+    /// @param[in] _r Radius of the object
+    // ---------------------------------------------------------------------------------------
+    void insert(
+                const int _id,
+                const Vec4 &_pos,
+                const float _r
+               );
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Sorts the inserted objects by their cells so they can be queried
+    // ---------------------------------------------------------------------------------------
+    void build();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the objects whose bounding box projects on to the cell of a point
+    /// @param[in] _pos Point to query, only the direction from the origin is used
+    /// @return Packed ids, centers and squared radii of the objects in the cell
+    // ---------------------------------------------------------------------------------------
+    narrowphase::spheres query(
+                               const Vec4 &_pos
+                              ) const;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the index of the cell the direction of a point falls in to
+    /// @param[in] _x X component of the point
+    /// @param[in] _y Y component of the point
+    /// @param[in] _z Z component of the point
+    /// @return Index of the cell, face * res * res + row * res + column
+    // ---------------------------------------------------------------------------------------
+    int cellOf(
+               const float _x,
+               const float _y,
+               const float _z
+              ) const;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the total amount of cells
+    /// @return Amount of cells on all the six faces
+    // ---------------------------------------------------------------------------------------
+    int cells() const { return 6 * m_res * m_res; }
+
+  protected:
+    // ---------------------------------------------------------------------------------------
+    /// @brief Amount of cells on each row and column of a face
+    // ---------------------------------------------------------------------------------------
+    int m_res;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Cell and id of each inserted (object, cell) pair before they're sorted
+    // ---------------------------------------------------------------------------------------
+    std::vector<int> m_pairCell, m_pairId;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Center and squared radius of each inserted object
+    // ---------------------------------------------------------------------------------------
+    std::vector<float> m_objX, m_objY, m_objZ, m_objR2;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Index of the inserted object of each pair
+    // ---------------------------------------------------------------------------------------
+    std::vector<int> m_pairObj;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Index of the first object of each cell in m_ids, the objects of cell c are
+    ///        in [m_cellStart[c], m_cellStart[c + 1])
+    // ---------------------------------------------------------------------------------------
+    std::vector<int> m_cellStart;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Ids, centers and squared radii of the objects sorted by their cells
+    // ---------------------------------------------------------------------------------------
+    std::vector<int> m_ids;
+    std::vector<float> m_x, m_y, m_z, m_r2;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Returns the row or column of a projected face coordinate
+    /// @param[in] _c Face coordinate, clamped to [-1, 1]
+    /// @return Row or column index
+    // ---------------------------------------------------------------------------------------
+    int toCell(
+               const float _c
+              ) const
+    {
+      int i = (int)((_c + 1.0f) * 0.5f * m_res);
+      return (i < 0 ? 0 : (i >= m_res ? m_res - 1 : i));
+    }
+}; // end of class
+
+#endif // end of SPHEREGRID_H
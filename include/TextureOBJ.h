@@ -13,7 +13,7 @@
 /// @author Teemu Lindborg
 /// @date 03/05/15
 /// Revision History:
-///   -
+///   - Split in to decoding and uploading so the images can be decoded on other threads
 /// @todo Use namespaces here maybe. Name of the files might be misleading at the moment
 ///       as this is not only used to texture objs
 // ---------------------------------------------------------------------------------------
@@ -26,6 +26,7 @@
 #endif
 
 #include <iostream>
+#include <SDL2/SDL_image.h>
 
 // ---------------------------------------------------------------------------------------
 /// @brief Loads the texture and cleans up afterwards
@@ -34,4 +35,19 @@
 // ---------------------------------------------------------------------------------------
 void loadTexture(const std::string &_n, GLuint &o_id);
 
+// ---------------------------------------------------------------------------------------
+/// @brief Loads and decodes the image of a texture, doesn't touch GL so this can be
+///        called from any thread
+/// @param[in] _n Path to the texture to be loaded
+/// @return The decoded image
+// ---------------------------------------------------------------------------------------
+SDL_Surface *decodeTexture(const std::string &_n);
+
+// ---------------------------------------------------------------------------------------
+/// @brief Creates a texture from a decoded image and frees the image
+/// @param[in] _texture Image returned by decodeTexture
+/// @param[out] o_id GLuint that the texture data will be loaded in to
+// ---------------------------------------------------------------------------------------
+void uploadTexture(SDL_Surface *_texture, GLuint &o_id);
+
 #endif // end of TEXTUREOBJ_H
@@ -14,28 +14,52 @@
 #endif
 
 #include <vector>
-#include <list>
 #include <string>
 #include <cmath>
-#include <SDL2/SDL_mixer.h>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int_distribution.hpp>
 
 #include "Asteroids.h"
-#include "Planet.h"
-#include "LoadOBJ.h"
+#include "ActiveSet.h"
+#include "SphereGrid.h"
 #include "NCCA/Vec4.h"
 
+#ifndef HEADLESS
+  #include <SDL2/SDL_mixer.h>
+
+  #include "Planet.h"
+  #include "AssetLoader.h"
+  #include "LoadOBJ.h"
+  #include "Mesh.h"
+#endif
+
 // ---------------------------------------------------------------------------------------
 /// @file World.h
-/// @brief Class that handles the building of the world, stars, asteroids, triangle
-///        subdivision, asteroid spatial partitioning, loading and playing of the
+/// @brief Class that handles the building of the world, stars, asteroids, the
+///        atmosphere, asteroid spatial partitioning, loading and playing of the
 ///        background music.
 /// @version 1.0
 /// @author Teemu Lindborg
 /// @date 03/05/15
 /// Revision History:
-///   -
+///   - The asteroids on the atmosphere are binned in to a grid over the atmosphere
+///     surface for the collision broadphase.
+///   - The asteroids on the atmosphere are kept in an active set that's updated when
+///     they reach the atmosphere or get destroyed, destroyed asteroids are swap-removed.
+///   - The asteroids are stored in a generational slot map so they can be referred to
+///     with handles that stay valid while the asteroid is alive.
+///   - The asteroids are stored in an asteroid field (structure of arrays) and moved in
+///     one batch every update.
+///   - The asteroid models are stored in vertex buffers and drawn instanced.
+///   - The skybox, atmosphere and asteroid models are stored in indexed meshes instead of
+///     displaylists.
+///   - The models, textures and sounds are loaded through the asset loader and the meshes
+///     are generated separately once they've been loaded.
+///   - The asteroids, planet, trees and clouds are culled against the camera's view
+///     frustum and the visible and culled ones counted.
+///   - The asteroid models get simplified levels of detail when their meshes are built.
+///   - The atmosphere is built from an indexed icosphere instead of subdividing the
+///     icosahedron triangles in to separate ones.
 /// @todo Tidying up. Some functionality could be separated in to their own classes.
 // ---------------------------------------------------------------------------------------
 
@@ -46,15 +70,21 @@ class World
 {
   public:
     // ---------------------------------------------------------------------------------------
-    /// @brief stl vector holding the living asteroids
+    /// @brief Field holding the living asteroids
     // ---------------------------------------------------------------------------------------
-    std::vector<Asteroid> m_asteroids;
+    AsteroidField m_asteroids;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief stl list holding the indices of living asteroids that have reached the
-    ///        atmosphere. Used for collision detection.
+    /// @brief Set of the slot indices of living asteroids that have reached the atmosphere.
+    ///        Used for collision detection.
     // ---------------------------------------------------------------------------------------
-    std::list<int> m_aColIndices;
+    ActiveSet m_aColIndices;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Grid over the atmosphere surface the asteroids in m_aColIndices are binned in
+    ///        to by their slot index, rebuilt every update. Used as the collision broadphase.
+    // ---------------------------------------------------------------------------------------
+    SphereGrid m_aGrid;
 
     // ---------------------------------------------------------------------------------------
     /// @brief Variable telling how many asteroids can be alive at the same time, if this
@@ -63,8 +93,8 @@ class World
     int m_maxAsteroids;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief World constructor initialises and calls the building functions that are needed
-    ///        to draw/generate the world. Loads in the required models, textures and sounds.
+    /// @brief World constructor, initialises the simulation. The models, textures and sounds
+    ///        needed to draw the world are loaded with loadAssets() and initAssets().
     // ---------------------------------------------------------------------------------------
     World();
 
@@ -84,27 +114,46 @@ class World
                   );
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Calls all the functions and displaylists that render and display the world.
-    ///        Also calls the function that generates asteroids.
+    /// @brief Advances the world's simulation by one step. Generates, moves and destroys
+    ///        the asteroids and does the spatial partitioning. Does no rendering.
+    /// @param[in] _dt Elapsed time in seconds, normally SIMSTEP
+    // ---------------------------------------------------------------------------------------
+    void update(
+                const float _dt
+               );
+
+#ifndef HEADLESS
+    // ---------------------------------------------------------------------------------------
+    /// @brief Requests the models, textures and sounds of the world and the planet to be
+    ///        loaded
+    /// @param[io] io_assets Loader to load the assets with
     // ---------------------------------------------------------------------------------------
-    void drawWorld();
+    void loadAssets(
+                    AssetLoader &io_assets
+                   );
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Subdivides a triangle as many times as the user wants and calls the drawing
-    ///        function in the end.
-    /// @param[in] _a Point A of a triangle
-    /// @param[in] _b Point B of a triangle
-    /// @param[in] _c Point C of a triangle
-    /// @param[in] _d Desired subdivisions / subdivision level
+    /// @brief Calls the building functions that generate the meshes of the world and starts
+    ///        the background music once the assets have been loaded
     // ---------------------------------------------------------------------------------------
-    void subd(
-              const Vec4 &_a,
-              const Vec4 &_b,
-              const Vec4 &_c,
-              const int _d
-             ) const;
+    void initAssets();
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Calls all the functions and meshes that render and display the world.
+    /// @param[in] _alpha Interpolation factor between the last two updates
+    /// @param[in] _frustum Planes of the view frustum the world is drawn with
+    /// @param[io] io_counters The visible and culled asteroids, tree patches and clouds
+    ///            are added here
+    // ---------------------------------------------------------------------------------------
+    void drawWorld(
+                   const float _alpha,
+                   const frustum::planes &_frustum,
+                   frustum::counters &io_counters
+                  ) const;
+#endif
 
   protected:
+#ifndef HEADLESS
     // ---------------------------------------------------------------------------------------
     /// @brief Planet object that will generate the planet related stuff and that's used to
     ///        call the planet drawing inside drawWorld
@@ -119,7 +168,8 @@ class World
     // ---------------------------------------------------------------------------------------
     /// @brief Model structure array holding the different asteroid meshes
     // ---------------------------------------------------------------------------------------
-    model m_asteroid[2];
+    model m_asteroid[ASTEROIDTYPES];
+#endif
 
     // ---------------------------------------------------------------------------------------
     /// @brief stl vector holding the star positions
@@ -127,14 +177,22 @@ class World
     std::vector<Vec4> m_stars;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief stl vector holding the world displaylist (atmosphere, skybox)
+    /// @brief Indices of the asteroids that reached the atmosphere during the latest update
+    // ---------------------------------------------------------------------------------------
+    std::vector<int> m_reached;
+
+#ifndef HEADLESS
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Meshes of the skybox and the atmosphere
     // ---------------------------------------------------------------------------------------
-    std::vector<GLuint> m_wDisplayList;
+    Mesh m_skyboxMesh, m_atmosphereMesh;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief stl vector holding the displaylist of the asteroids
+    /// @brief Vertex buffers of the asteroid models, the full model first followed by the
+    ///        simplified levels of detail
     // ---------------------------------------------------------------------------------------
-    std::vector<GLuint> m_aDisplayList;
+    Mesh m_aMesh[ASTEROIDTYPES][ASTEROIDLODS];
 
     // ---------------------------------------------------------------------------------------
     /// @brief Audio chunk holding the asteroid explosion sound data
@@ -150,12 +208,14 @@ class World
     /// @brief GLuints that'll contain the skybox and asteroid textures respectively
     // ---------------------------------------------------------------------------------------
     GLuint m_skyBoxTexId, m_aTexId;
+#endif
 
     // ---------------------------------------------------------------------------------------
     /// @brief Random number generator from boost random library
     // ---------------------------------------------------------------------------------------
     boost::mt19937 m_rng;
 
+#ifndef HEADLESS
     // ---------------------------------------------------------------------------------------
     /// @brief Function that will draw the generated stars and set the opacity which for now
     ///        is only randomly generated, could implement the opacity (visibility) to depend
@@ -165,25 +225,54 @@ class World
 
     // ---------------------------------------------------------------------------------------
     /// @brief Scales and calls the draw function from the planet object
+    /// @param[in] _alpha Interpolation factor between the last two updates
+    /// @param[in] _frustum Planes of the view frustum in world space
+    /// @param[io] io_counters The visible and culled tree patches and clouds are added here
     // ---------------------------------------------------------------------------------------
-    void drawPlanet();
+    void drawPlanet(
+                    const float _alpha,
+                    const frustum::planes &_frustum,
+                    frustum::counters &io_counters
+                   ) const;
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Calls the tSphere function that subdivides an icosahedron to generate a
-    ///        geodesic dome that will be displayed in wireframe mode (to have the look of the
-    ///        original game for the atmosphere). Also scales the sphere and restores the fill
-    ///        mode.
+    /// @brief Builds the geodesic sphere of the atmosphere that will be displayed in
+    ///        wireframe mode (to have the look of the original game for the atmosphere).
     // ---------------------------------------------------------------------------------------
     void atmosphere();
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Generates the displaylist from the skybox model (using a mesh here for the easy
-    ///        texture coordinates), scales it and attaches a texture to it. Also disables
-    ///        depth mask as nothing's behind the skybox so no need to check for what's behind
-    ///        it.
+    /// @brief Generates the mesh from the skybox model (using a model here for the easy
+    ///        texture coordinates), the normals are flipped to point inwards.
     // ---------------------------------------------------------------------------------------
     void skybox();
 
+    // ---------------------------------------------------------------------------------------
+    /// @brief Draws the skybox and the atmosphere. The skybox is drawn scaled, textured and
+    ///        without lighting and depth mask as nothing's behind the skybox so no need to
+    ///        check for what's behind it. The atmosphere is drawn scaled in wireframe mode.
+    // ---------------------------------------------------------------------------------------
+    void drawSkyAndAtmosphere() const;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Binds the asteroid texture and calls the draw function of each living asteroid
+    /// @param[in] _alpha Interpolation factor between the last two updates
+    /// @param[in] _frustum Planes of the view frustum
+    /// @param[io] io_counter The visible and culled asteroids are added here
+    // ---------------------------------------------------------------------------------------
+    void drawAsteroids(
+                       const float _alpha,
+                       const frustum::planes &_frustum,
+                       frustum::counter &io_counter
+                      ) const;
+
+    // ---------------------------------------------------------------------------------------
+    /// @brief Generates the meshes from the asteroid models loaded in when the World
+    ///        object was created along with the simplified levels of detail of each
+    // ---------------------------------------------------------------------------------------
+    void genAMeshes();
+#endif
+
     // ---------------------------------------------------------------------------------------
     /// @brief Uses boost random uniform int distribution to have asteroids spawn every now
     ///        and then if the amount of living asteroids has not exceeded the maximum value.
@@ -192,47 +281,29 @@ class World
     ///        and calculates the up vector by taking the cross product of the position and
     ///        side vectors. The up and side vectors are used to calculate the movement when
     ///        the asteroid reaches the atmosphere. Also randomly generates a scale factor and
-    ///        chooses the asteroid type. Lastly it the function handles the drawing and
+    ///        chooses the asteroid type. Lastly it the function handles the movement and
     ///        destroyal of the asteroids.
+    /// @param[in] _dt Elapsed time in seconds
     // ---------------------------------------------------------------------------------------
-    void generate_Asteroids();
-
-    // ---------------------------------------------------------------------------------------
-    /// @brief Generates the displaylists from the asteroid meshes loaded in when the World
-    ///        object was created
-    // ---------------------------------------------------------------------------------------
-    void genALists();
-
-    // ---------------------------------------------------------------------------------------
-    /// @brief Geodesic sphere "generator". Uses the icosahedron shape define in Icosahedron.h
-    ///        to run through the triangles defined, subdivides them and normalises the new
-    ///        verts to generate a spherical shape.
-    /// @param[in] _d Desired subdivision levels
-    // ---------------------------------------------------------------------------------------
-    void tSphere(
-                 const int _d
-                ) const;
+    void generate_Asteroids(
+                            const float _dt
+                           );
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Draws a triangle from the given vertices (Vec4), also generates a normal vector
-    ///        by adding the three vertex vectors together and normalising the resulting vector.
-    /// @param[in] _a First vertex of the triangle
-    /// @param[in] _b Second vertex of the triangle
-    /// @param[in] _c Third vertex of the triangle
+    /// @brief Bins the asteroids that have reached the atmosphere in to the atmosphere
+    ///        grid, this is then used to only check collisions on the asteroids that are
+    ///        on the atmosphere and near the projectile or the player.
     // ---------------------------------------------------------------------------------------
-    void drawTriangle(
-                      const Vec4 &_a,
-                      const Vec4 &_b,
-                      const Vec4 &_c
-                     ) const;
+    void binAsteroids();
 
     // ---------------------------------------------------------------------------------------
-    /// @brief Does simple spatial partitioning on the asteroids by checking the distance of
-    ///        each asteroid from the origin and records the indices of the asteroids that
-    ///        have reached the atmosphere, this is then used to only check collisions on the
-    ///        asteroids are on the atmosphere.
+    /// @brief Removes an asteroid from the field, which moves the last asteroid in to its
+    ///        place, and from the set of asteroids on the atmosphere
+    /// @param[in] _i Index of the asteroid to remove
     // ---------------------------------------------------------------------------------------
-    void partByDist();
+    void removeAsteroid(
+                        const int _i
+                       );
 
 }; // end of class
 
@@ -60,10 +60,12 @@
 #include <SDL2/SDL.h>
 #include <sys/time.h>
 
-#define MAX_FPS 100.0f
+// Rendering fps limit, 0 for uncapped. The simulation runs at a fixed rate (SIMRATE)
+// regardless of this, so this only limits the rendering.
+#define MAX_FPS 0.0f
 
 /// @brief FPS counter
-/// Modified from : Added a fps limiter using SDL_Delay
+/// Modified from : Added an optional fps limiter using SDL_Delay
 /// Toby Howard toby.howardy@manchester.ac.uk (January 3, 2013). General purpose frames per second counter for OpenGL/GLUT GNU/Linux programs.
 /// [Accessed 2015]. Available from: <http://studentnet.cs.manchester.ac.uk/ugt/COMP27112/OpenGL/frames.txt>.
 
@@ -90,7 +92,7 @@ void frameEnd(void *font, GLclampf r, GLclampf g, GLclampf b,
 
   elapsedTime = frameEndTime.tv_sec - frameStartTime.tv_sec +
              ((frameEndTime.tv_usec - frameStartTime.tv_usec)/1.0E6);
-  if(elapsedTime < 1.0/MAX_FPS)
+  if(MAX_FPS > 0.0f && elapsedTime < 1.0/MAX_FPS)
   {
     SDL_Delay((1.0/MAX_FPS - elapsedTime) * 1000);
     gettimeofday(&frameEndTime, NULL);
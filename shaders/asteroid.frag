@@ -0,0 +1,12 @@
+#version 120
+
+// Modulates the asteroid texture with the lit colour
+
+uniform sampler2D u_tex;
+
+varying vec2 v_uv;
+
+void main()
+{
+  gl_FragColor = gl_Color * texture2D(u_tex, v_uv);
+}
@@ -0,0 +1,37 @@
+#version 120
+
+// Places an instance of an asteroid model. The model is rotated around the (1, 1, 1) axis,
+// scaled and translated by the per instance attributes, the same transformations the
+// asteroids used to get with glRotatef, glScalef and glTranslatef. The lighting is the
+// fixed function lighting of the two directional lights with the colour material.
+
+attribute vec4 a_instance; // xyz position, w scale factor
+attribute float a_rot;     // rotation angle in degrees
+
+varying vec2 v_uv;
+
+void main()
+{
+  // Rodrigues' rotation around the normalised (1, 1, 1) axis
+  vec3 axis = vec3(0.57735027);
+  float c = cos(radians(a_rot));
+  float s = sin(radians(a_rot));
+  vec3 p = gl_Vertex.xyz * c + cross(axis, gl_Vertex.xyz) * s + axis * dot(axis, gl_Vertex.xyz) * (1.0 - c);
+  vec3 n = gl_Normal * c + cross(axis, gl_Normal) * s + axis * dot(axis, gl_Normal) * (1.0 - c);
+
+  gl_Position = gl_ModelViewProjectionMatrix * vec4(p * a_instance.w + a_instance.xyz, 1.0);
+
+  vec3 normal = normalize(gl_NormalMatrix * n);
+  vec4 colour = gl_LightModel.ambient * gl_Color;
+  for(int i = 0; i < 2; ++i)
+  {
+    float nDotL = max(dot(normal, normalize(gl_LightSource[i].position.xyz)), 0.0);
+    colour += gl_LightSource[i].ambient * gl_Color + gl_LightSource[i].diffuse * gl_Color * nDotL;
+    if(nDotL > 0.0)
+      colour += gl_FrontMaterial.specular * gl_LightSource[i].specular *
+                pow(max(dot(normal, normalize(gl_LightSource[i].halfVector.xyz)), 0.0), gl_FrontMaterial.shininess);
+  }
+
+  gl_FrontColor = clamp(vec4(colour.rgb, gl_Color.a), 0.0, 1.0);
+  v_uv = gl_MultiTexCoord0.xy;
+}
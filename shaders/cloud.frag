@@ -0,0 +1,8 @@
+#version 120
+
+// The clouds are just the lit colour
+
+void main()
+{
+  gl_FragColor = gl_Color;
+}
@@ -0,0 +1,41 @@
+#version 120
+
+// Places an instance of the cloud model. The cloud is scaled, moved up to the surface of
+// the unit sphere and rotated around its own axis, the same transformations the clouds
+// used to get one by one with glScalef, glTranslatef and glRotatef. All the clouds turn
+// at the same rate so the angle is the starting angle of the cloud plus u_angle. The
+// lighting is the same fixed function lighting as in asteroid.vert.
+
+attribute vec4 a_cloud;  // xyz rotation axis, w starting angle in degrees
+attribute float a_scale; // scale factor
+
+uniform float u_angle;   // angle all the clouds have turned since the start in degrees
+
+// Rodrigues' rotation of _v around the unit axis _k
+vec3 rotate(vec3 _v, vec3 _k, float _c, float _s)
+{
+  return _v * _c + cross(_k, _v) * _s + _k * dot(_k, _v) * (1.0 - _c);
+}
+
+void main()
+{
+  float c = cos(radians(a_cloud.w + u_angle));
+  float s = sin(radians(a_cloud.w + u_angle));
+  vec3 p = rotate(gl_Vertex.xyz * a_scale + vec3(0.0, 1.0, 0.0), a_cloud.xyz, c, s);
+  vec3 n = rotate(gl_Normal, a_cloud.xyz, c, s);
+
+  gl_Position = gl_ModelViewProjectionMatrix * vec4(p, 1.0);
+
+  vec3 normal = normalize(gl_NormalMatrix * n);
+  vec4 colour = gl_LightModel.ambient * gl_Color;
+  for(int i = 0; i < 2; ++i)
+  {
+    float nDotL = max(dot(normal, normalize(gl_LightSource[i].position.xyz)), 0.0);
+    colour += gl_LightSource[i].ambient * gl_Color + gl_LightSource[i].diffuse * gl_Color * nDotL;
+    if(nDotL > 0.0)
+      colour += gl_FrontMaterial.specular * gl_LightSource[i].specular *
+                pow(max(dot(normal, normalize(gl_LightSource[i].halfVector.xyz)), 0.0), gl_FrontMaterial.shininess);
+  }
+
+  gl_FrontColor = clamp(vec4(colour.rgb, gl_Color.a), 0.0, 1.0);
+}
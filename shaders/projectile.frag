@@ -0,0 +1,13 @@
+#version 120
+
+// Maps the point sprite on to its cell in the sprite sheet
+
+uniform sampler2D u_tex;
+uniform float u_cellSize;
+
+varying vec2 v_cell;
+
+void main()
+{
+  gl_FragColor = gl_Color * texture2D(u_tex, v_cell + gl_PointCoord * u_cellSize);
+}
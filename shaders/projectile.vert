@@ -0,0 +1,18 @@
+#version 120
+
+// Draws a projectile sprite as a point sprite, the point size is the world space size of
+// the sprite projected on to the screen. The texture coordinate is the corner of the
+// sprite's cell in the sprite sheet.
+
+uniform float u_size;
+uniform float u_viewportHeight;
+
+varying vec2 v_cell;
+
+void main()
+{
+  gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
+  gl_PointSize = u_size * gl_ProjectionMatrix[1][1] * u_viewportHeight * 0.5 / gl_Position.w;
+  gl_FrontColor = gl_Color;
+  v_cell = gl_MultiTexCoord0.xy;
+}
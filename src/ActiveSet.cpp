@@ -0,0 +1,84 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#include <algorithm>
+
+#include "ActiveSet.h"
+
+// ---------------------------------------------------------------------------------------
+/// @file ActiveSet.cpp
+/// @brief Implementation of the active set functions
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+ActiveSet::ActiveSet(
+                     const int _capacity
+                    )
+{
+  m_members.reserve(_capacity);
+  if(_capacity > 0)
+    grow(_capacity - 1);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void ActiveSet::grow(
+                     const int _i
+                    )
+{
+  if(_i < (int)m_slot.size())
+    return;
+
+  // Grow by doubling so a slowly increasing index doesn't reallocate every time
+  int size = std::max(_i + 1, 2 * (int)m_slot.size());
+  m_slot.resize(size, 0);
+  m_bits.resize((size + 31) / 32, 0u);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void ActiveSet::insert(
+                       const int _i
+                      )
+{
+  grow(_i);
+  if(contains(_i))
+    return;
+
+  m_slot[_i] = (int)m_members.size();
+  m_members.push_back(_i);
+  m_bits[_i >> 5] |= 1u << (_i & 31);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void ActiveSet::erase(
+                      const int _i
+                     )
+{
+  if(!contains(_i))
+    return;
+
+  // Move the last member in to the removed one's place
+  int slot = m_slot[_i];
+  int last = m_members.back();
+  m_members[slot] = last;
+  m_slot[last] = slot;
+  m_members.pop_back();
+
+  m_bits[_i >> 5] &= ~(1u << (_i & 31));
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void ActiveSet::clear()
+{
+  // Only the bits of the members are set so clearing those is enough
+  for(int n = 0; n < (int)m_members.size(); ++n)
+    m_bits[m_members[n] >> 5] &= ~(1u << (m_members[n] & 31));
+
+  m_members.clear();
+}
+// ---------------------------------------------------------------------------------------
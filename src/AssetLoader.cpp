@@ -0,0 +1,159 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#include "AssetLoader.h"
+#include "Audio.h"
+#include "TextureOBJ.h"
+
+// ---------------------------------------------------------------------------------------
+/// @file AssetLoader.cpp
+/// @brief Implementation of the threaded asset loading
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+AssetLoader::AssetLoader(
+                         const int _threads
+                        ) :
+  m_pending(0),
+  m_quit(false)
+{
+  // SDL_image initialises the image libraries lazily on the first load of each format,
+  // which isn't thread safe, so do it here before any of the workers start decoding
+  IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
+
+  int threads = _threads > 0 ? _threads : (int)std::thread::hardware_concurrency();
+  if(threads < 1)
+    threads = 1;
+
+  for(int i = 0; i < threads; ++i)
+    m_threads.push_back(std::thread(&AssetLoader::worker, this));
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+AssetLoader::~AssetLoader()
+{
+  finish();
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_quit = true;
+  }
+  m_wake.notify_all();
+
+  for(size_t i = 0; i < m_threads.size(); ++i)
+    m_threads[i].join();
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void AssetLoader::requestModel(
+                               const std::string &_n,
+                               model &o_m
+                              )
+{
+  model *m = &o_m;
+  push([_n, m]() { loadModel(_n, *m); });
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void AssetLoader::requestTexture(
+                                 const std::string &_n,
+                                 GLuint &o_id
+                                )
+{
+  GLuint *id = &o_id;
+  push([this, _n, id]()
+  {
+    decodedTexture t = {decodeTexture(_n), id};
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_decoded.push_back(t);
+  });
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void AssetLoader::requestSound(
+                               const std::string &_n,
+                               Mix_Chunk **o_sound
+                              )
+{
+  push([_n, o_sound]() { audio::loadSound(_n, o_sound); });
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void AssetLoader::requestSound(
+                               const std::string &_n,
+                               Mix_Music **o_music
+                              )
+{
+  push([_n, o_music]() { audio::loadSound(_n, o_music); });
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void AssetLoader::finish()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for(;;)
+  {
+    // Upload the images decoded so far while the workers carry on with the rest
+    while(!m_decoded.empty())
+    {
+      decodedTexture t = m_decoded.back();
+      m_decoded.pop_back();
+
+      lock.unlock();
+      uploadTexture(t.m_surface, *t.m_id);
+      lock.lock();
+    }
+
+    if(!m_pending)
+      break;
+    m_done.wait(lock);
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void AssetLoader::push(
+                       const std::function<void()> &_job
+                      )
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs.push_back(_job);
+    ++m_pending;
+  }
+  m_wake.notify_one();
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void AssetLoader::worker()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for(;;)
+  {
+    while(m_jobs.empty() && !m_quit)
+      m_wake.wait(lock);
+    if(m_jobs.empty())
+      return;
+
+    std::function<void()> job = m_jobs.front();
+    m_jobs.pop_front();
+
+    // Run the load without holding the lock so the other workers can go on
+    lock.unlock();
+    job();
+    lock.lock();
+
+    --m_pending;
+    m_done.notify_one();
+  }
+}
+// ---------------------------------------------------------------------------------------
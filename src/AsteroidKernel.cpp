@@ -0,0 +1,351 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#include <cmath>
+
+#include "Defs.h"
+#include "AsteroidKernel.h"
+#include "Simd.h"
+
+// ---------------------------------------------------------------------------------------
+/// @file AsteroidKernel.cpp
+/// @brief Implementation of the asteroid kernels and the runtime kernel selection. The
+///        SIMD versions calculate the approaching and the orbiting movement for every
+///        asteroid and pick the right one with the phase mask, the asteroids that just
+///        reached the atmosphere are compacted from the mask one set bit at a time.
+// ---------------------------------------------------------------------------------------
+
+// An asteroid keeps approaching the planet while it's further away than the atmosphere
+// and faster than this, after that it orbits with ASTEROIDORBITSPEED
+#define ASTEROIDAPPROACHSPEED 0.031f
+#define ASTEROIDORBITSPEED 0.03f
+
+// ---------------------------------------------------------------------------------------
+int asteroidKernel::updateScalar(
+                                 const batch &io_b,
+                                 const float _scale,
+                                 int *o_reached
+                                )
+{
+  const float radius = WORLDRADIUS*ASPHERERADIUS;
+  int reached = 0;
+
+  for(int i = 0; i < io_b.m_count; ++i)
+  {
+    float x = io_b.m_x[i];
+    float y = io_b.m_y[i];
+    float z = io_b.m_z[i];
+
+    // Store the current state for the interpolation
+    io_b.m_prevX[i] = x;
+    io_b.m_prevY[i] = y;
+    io_b.m_prevZ[i] = z;
+    io_b.m_prevRot[i] = io_b.m_rot[i];
+
+    // Comparing the squared length saves the square root for the approaching asteroids
+    float len2 = x*x + y*y + z*z;
+    if(len2 > radius*radius && io_b.m_speed[i] > ASTEROIDAPPROACHSPEED)
+    {
+      // Still heading towards the planet
+      float step = io_b.m_speed[i] * _scale;
+      io_b.m_x[i] = x + io_b.m_dirX[i] * step;
+      io_b.m_y[i] = y + io_b.m_dirY[i] * step;
+      io_b.m_z[i] = z + io_b.m_dirZ[i] * step;
+      io_b.m_rot[i] += 5 * _scale;
+    }
+    else
+    {
+      // On the atmosphere, slow down and move along the side vector (position x up)
+      // keeping the asteroid on the atmosphere surface
+      io_b.m_speed[i] = ASTEROIDORBITSPEED;
+
+      float inv = 1.0f / std::sqrt(len2);
+      float nx = x * inv, ny = y * inv, nz = z * inv;
+
+      float sx = ny * io_b.m_upZ[i] - nz * io_b.m_upY[i];
+      float sy = nz * io_b.m_upX[i] - nx * io_b.m_upZ[i];
+      float sz = nx * io_b.m_upY[i] - ny * io_b.m_upX[i];
+      float step = ASTEROIDORBITSPEED * _scale / std::sqrt(sx*sx + sy*sy + sz*sz);
+
+      io_b.m_x[i] = nx * radius + sx * step;
+      io_b.m_y[i] = ny * radius + sy * step;
+      io_b.m_z[i] = nz * radius + sz * step;
+      io_b.m_rot[i] += _scale;
+
+      // Only report reaching the atmosphere once
+      if(!io_b.m_onAtmosphere[i])
+      {
+        io_b.m_onAtmosphere[i] = 1;
+        o_reached[reached++] = i;
+      }
+    }
+  }
+
+  return reached;
+}
+// ---------------------------------------------------------------------------------------
+
+#ifdef SIMD_X86
+// ---------------------------------------------------------------------------------------
+/// @brief Runs the scalar kernel on the asteroids from _first onwards, used by the SIMD
+///        kernels for the asteroids that didn't fit in to a full register
+/// @param[io] io_b Whole batch
+/// @param[in] _first Index of the first asteroid to update
+/// @param[in] _scale Elapsed time relative to the simulation step
+/// @param[out] o_reached Where to write the indices of the asteroids that reached the
+///             atmosphere, the indices are relative to the whole batch
+/// @return Amount of indices written to o_reached
+// ---------------------------------------------------------------------------------------
+static int updateTail(
+                      const asteroidKernel::batch &io_b,
+                      const int _first,
+                      const float _scale,
+                      int *o_reached
+                     )
+{
+  asteroidKernel::batch tail = io_b;
+  tail.m_x += _first; tail.m_y += _first; tail.m_z += _first;
+  tail.m_prevX += _first; tail.m_prevY += _first; tail.m_prevZ += _first;
+  tail.m_dirX += _first; tail.m_dirY += _first; tail.m_dirZ += _first;
+  tail.m_upX += _first; tail.m_upY += _first; tail.m_upZ += _first;
+  tail.m_speed += _first;
+  tail.m_rot += _first; tail.m_prevRot += _first;
+  tail.m_onAtmosphere += _first;
+  tail.m_count -= _first;
+
+  int reached = asteroidKernel::updateScalar(tail, _scale, o_reached);
+  for(int i = 0; i < reached; ++i)
+    o_reached[i] += _first;
+
+  return reached;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+__attribute__((target("sse2")))
+int asteroidKernel::updateSSE(
+                              const batch &io_b,
+                              const float _scale,
+                              int *o_reached
+                             )
+{
+  const float radius = WORLDRADIUS*ASPHERERADIUS;
+  const __m128 r = _mm_set1_ps(radius);
+  const __m128 r2 = _mm_set1_ps(radius*radius);
+  const __m128 scale = _mm_set1_ps(_scale);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 approachSpeed = _mm_set1_ps(ASTEROIDAPPROACHSPEED);
+  const __m128 orbitSpeed = _mm_set1_ps(ASTEROIDORBITSPEED);
+  const __m128 orbitStep = _mm_set1_ps(ASTEROIDORBITSPEED * _scale);
+  const __m128 approachRot = _mm_set1_ps(5 * _scale);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i onei = _mm_set1_epi32(1);
+
+  int reached = 0;
+  int i = 0;
+  for(; i + 4 <= io_b.m_count; i += 4)
+  {
+    __m128 x = _mm_loadu_ps(io_b.m_x + i);
+    __m128 y = _mm_loadu_ps(io_b.m_y + i);
+    __m128 z = _mm_loadu_ps(io_b.m_z + i);
+    __m128 speed = _mm_loadu_ps(io_b.m_speed + i);
+    __m128 rot = _mm_loadu_ps(io_b.m_rot + i);
+
+    _mm_storeu_ps(io_b.m_prevX + i, x);
+    _mm_storeu_ps(io_b.m_prevY + i, y);
+    _mm_storeu_ps(io_b.m_prevZ + i, z);
+    _mm_storeu_ps(io_b.m_prevRot + i, rot);
+
+    __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+    __m128 approach = _mm_and_ps(_mm_cmpgt_ps(len2, r2), _mm_cmpgt_ps(speed, approachSpeed));
+
+    // Approaching movement along the direction
+    __m128 step = _mm_mul_ps(speed, scale);
+    __m128 ax = _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(io_b.m_dirX + i), step));
+    __m128 ay = _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(io_b.m_dirY + i), step));
+    __m128 az = _mm_add_ps(z, _mm_mul_ps(_mm_loadu_ps(io_b.m_dirZ + i), step));
+
+    // Orbiting movement along position x up on the atmosphere surface
+    __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(len2));
+    __m128 nx = _mm_mul_ps(x, inv);
+    __m128 ny = _mm_mul_ps(y, inv);
+    __m128 nz = _mm_mul_ps(z, inv);
+
+    __m128 ux = _mm_loadu_ps(io_b.m_upX + i);
+    __m128 uy = _mm_loadu_ps(io_b.m_upY + i);
+    __m128 uz = _mm_loadu_ps(io_b.m_upZ + i);
+    __m128 sx = _mm_sub_ps(_mm_mul_ps(ny, uz), _mm_mul_ps(nz, uy));
+    __m128 sy = _mm_sub_ps(_mm_mul_ps(nz, ux), _mm_mul_ps(nx, uz));
+    __m128 sz = _mm_sub_ps(_mm_mul_ps(nx, uy), _mm_mul_ps(ny, ux));
+    __m128 s2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, sx), _mm_mul_ps(sy, sy)), _mm_mul_ps(sz, sz));
+    __m128 sStep = _mm_div_ps(orbitStep, _mm_sqrt_ps(s2));
+
+    __m128 ox = _mm_add_ps(_mm_mul_ps(nx, r), _mm_mul_ps(sx, sStep));
+    __m128 oy = _mm_add_ps(_mm_mul_ps(ny, r), _mm_mul_ps(sy, sStep));
+    __m128 oz = _mm_add_ps(_mm_mul_ps(nz, r), _mm_mul_ps(sz, sStep));
+
+    // Pick the movement by the phase, SSE2 has no blend so it's done with the masks
+    _mm_storeu_ps(io_b.m_x + i, _mm_or_ps(_mm_and_ps(approach, ax), _mm_andnot_ps(approach, ox)));
+    _mm_storeu_ps(io_b.m_y + i, _mm_or_ps(_mm_and_ps(approach, ay), _mm_andnot_ps(approach, oy)));
+    _mm_storeu_ps(io_b.m_z + i, _mm_or_ps(_mm_and_ps(approach, az), _mm_andnot_ps(approach, oz)));
+    _mm_storeu_ps(io_b.m_speed + i, _mm_or_ps(_mm_and_ps(approach, speed), _mm_andnot_ps(approach, orbitSpeed)));
+    _mm_storeu_ps(io_b.m_rot + i, _mm_add_ps(rot, _mm_or_ps(_mm_and_ps(approach, approachRot), _mm_andnot_ps(approach, scale))));
+
+    // The orbiting asteroids that weren't on the atmosphere yet have just reached it
+    __m128i orbit = _mm_castps_si128(approach);
+    __m128i onAtmosphere = _mm_loadu_si128((const __m128i *)(io_b.m_onAtmosphere + i));
+    __m128i arrived = _mm_andnot_si128(orbit, _mm_cmpeq_epi32(onAtmosphere, zero));
+    _mm_storeu_si128((__m128i *)(io_b.m_onAtmosphere + i), _mm_or_si128(onAtmosphere, _mm_andnot_si128(orbit, onei)));
+
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(arrived));
+    while(mask)
+    {
+      o_reached[reached++] = i + __builtin_ctz(mask);
+      mask &= mask - 1;
+    }
+  }
+
+  // The rest of the asteroids are moved one by one
+  return reached + updateTail(io_b, i, _scale, o_reached + reached);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+__attribute__((target("avx2")))
+int asteroidKernel::updateAVX2(
+                               const batch &io_b,
+                               const float _scale,
+                               int *o_reached
+                              )
+{
+  const float radius = WORLDRADIUS*ASPHERERADIUS;
+  const __m256 r = _mm256_set1_ps(radius);
+  const __m256 r2 = _mm256_set1_ps(radius*radius);
+  const __m256 scale = _mm256_set1_ps(_scale);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 approachSpeed = _mm256_set1_ps(ASTEROIDAPPROACHSPEED);
+  const __m256 orbitSpeed = _mm256_set1_ps(ASTEROIDORBITSPEED);
+  const __m256 orbitStep = _mm256_set1_ps(ASTEROIDORBITSPEED * _scale);
+  const __m256 approachRot = _mm256_set1_ps(5 * _scale);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i onei = _mm256_set1_epi32(1);
+
+  int reached = 0;
+  int i = 0;
+  for(; i + 8 <= io_b.m_count; i += 8)
+  {
+    __m256 x = _mm256_loadu_ps(io_b.m_x + i);
+    __m256 y = _mm256_loadu_ps(io_b.m_y + i);
+    __m256 z = _mm256_loadu_ps(io_b.m_z + i);
+    __m256 speed = _mm256_loadu_ps(io_b.m_speed + i);
+    __m256 rot = _mm256_loadu_ps(io_b.m_rot + i);
+
+    _mm256_storeu_ps(io_b.m_prevX + i, x);
+    _mm256_storeu_ps(io_b.m_prevY + i, y);
+    _mm256_storeu_ps(io_b.m_prevZ + i, z);
+    _mm256_storeu_ps(io_b.m_prevRot + i, rot);
+
+    __m256 len2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+    __m256 approach = _mm256_and_ps(_mm256_cmp_ps(len2, r2, _CMP_GT_OQ), _mm256_cmp_ps(speed, approachSpeed, _CMP_GT_OQ));
+
+    // Approaching movement along the direction
+    __m256 step = _mm256_mul_ps(speed, scale);
+    __m256 ax = _mm256_add_ps(x, _mm256_mul_ps(_mm256_loadu_ps(io_b.m_dirX + i), step));
+    __m256 ay = _mm256_add_ps(y, _mm256_mul_ps(_mm256_loadu_ps(io_b.m_dirY + i), step));
+    __m256 az = _mm256_add_ps(z, _mm256_mul_ps(_mm256_loadu_ps(io_b.m_dirZ + i), step));
+
+    // Orbiting movement along position x up on the atmosphere surface
+    __m256 inv = _mm256_div_ps(one, _mm256_sqrt_ps(len2));
+    __m256 nx = _mm256_mul_ps(x, inv);
+    __m256 ny = _mm256_mul_ps(y, inv);
+    __m256 nz = _mm256_mul_ps(z, inv);
+
+    __m256 ux = _mm256_loadu_ps(io_b.m_upX + i);
+    __m256 uy = _mm256_loadu_ps(io_b.m_upY + i);
+    __m256 uz = _mm256_loadu_ps(io_b.m_upZ + i);
+    __m256 sx = _mm256_sub_ps(_mm256_mul_ps(ny, uz), _mm256_mul_ps(nz, uy));
+    __m256 sy = _mm256_sub_ps(_mm256_mul_ps(nz, ux), _mm256_mul_ps(nx, uz));
+    __m256 sz = _mm256_sub_ps(_mm256_mul_ps(nx, uy), _mm256_mul_ps(ny, ux));
+    __m256 s2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, sx), _mm256_mul_ps(sy, sy)), _mm256_mul_ps(sz, sz));
+    __m256 sStep = _mm256_div_ps(orbitStep, _mm256_sqrt_ps(s2));
+
+    __m256 ox = _mm256_add_ps(_mm256_mul_ps(nx, r), _mm256_mul_ps(sx, sStep));
+    __m256 oy = _mm256_add_ps(_mm256_mul_ps(ny, r), _mm256_mul_ps(sy, sStep));
+    __m256 oz = _mm256_add_ps(_mm256_mul_ps(nz, r), _mm256_mul_ps(sz, sStep));
+
+    // Pick the movement by the phase, blendv takes the second operand where the mask is set
+    _mm256_storeu_ps(io_b.m_x + i, _mm256_blendv_ps(ox, ax, approach));
+    _mm256_storeu_ps(io_b.m_y + i, _mm256_blendv_ps(oy, ay, approach));
+    _mm256_storeu_ps(io_b.m_z + i, _mm256_blendv_ps(oz, az, approach));
+    _mm256_storeu_ps(io_b.m_speed + i, _mm256_blendv_ps(orbitSpeed, speed, approach));
+    _mm256_storeu_ps(io_b.m_rot + i, _mm256_add_ps(rot, _mm256_blendv_ps(scale, approachRot, approach)));
+
+    // The orbiting asteroids that weren't on the atmosphere yet have just reached it
+    __m256i orbit = _mm256_castps_si256(approach);
+    __m256i onAtmosphere = _mm256_loadu_si256((const __m256i *)(io_b.m_onAtmosphere + i));
+    __m256i arrived = _mm256_andnot_si256(orbit, _mm256_cmpeq_epi32(onAtmosphere, zero));
+    _mm256_storeu_si256((__m256i *)(io_b.m_onAtmosphere + i), _mm256_or_si256(onAtmosphere, _mm256_andnot_si256(orbit, onei)));
+
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(arrived));
+    while(mask)
+    {
+      o_reached[reached++] = i + __builtin_ctz(mask);
+      mask &= mask - 1;
+    }
+  }
+
+  // The rest of the asteroids are moved one by one
+  simd::zeroUpper();
+  return reached + updateTail(io_b, i, _scale, o_reached + reached);
+}
+// ---------------------------------------------------------------------------------------
+#else
+// ---------------------------------------------------------------------------------------
+int asteroidKernel::updateSSE(
+                              const batch &io_b,
+                              const float _scale,
+                              int *o_reached
+                             )
+{
+  return updateScalar(io_b, _scale, o_reached);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+int asteroidKernel::updateAVX2(
+                               const batch &io_b,
+                               const float _scale,
+                               int *o_reached
+                              )
+{
+  return updateScalar(io_b, _scale, o_reached);
+}
+// ---------------------------------------------------------------------------------------
+#endif
+
+// ---------------------------------------------------------------------------------------
+bool asteroidKernel::supported(
+                               const kernel _k
+                              )
+{
+  return simd::supported(simd::levelOf(_k, updateSSE, updateAVX2));
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+asteroidKernel::kernel asteroidKernel::select()
+{
+  return simd::select<kernel>(updateScalar, updateSSE, updateAVX2);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+const char *asteroidKernel::name(
+                                 const kernel _k
+                                )
+{
+  return simd::name(simd::levelOf(_k, updateSSE, updateAVX2));
+}
+// ---------------------------------------------------------------------------------------
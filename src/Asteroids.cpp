@@ -3,64 +3,301 @@
  SDAGE 1st year 2nd PPP Assignment
 */
 
+#include <algorithm>
 #include <iostream>
 
 #include "Asteroids.h"
 
+#ifndef HEADLESS
+  #include "Shader.h"
+#endif
+
 // ---------------------------------------------------------------------------------------
 /// @file Asteroids.cpp
-/// @brief Implementation of the asteroid drawing and moving
+/// @brief Implementation of the asteroid field drawing, updating and bookkeeping
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+AsteroidField::AsteroidField(
+                             const int _capacity
+                            ) :
+                             m_slots(_capacity),
+                             m_kernel(asteroidKernel::select())
+{
+  m_x.reserve(_capacity); m_y.reserve(_capacity); m_z.reserve(_capacity);
+  m_prevX.reserve(_capacity); m_prevY.reserve(_capacity); m_prevZ.reserve(_capacity);
+  m_dirX.reserve(_capacity); m_dirY.reserve(_capacity); m_dirZ.reserve(_capacity);
+  m_upX.reserve(_capacity); m_upY.reserve(_capacity); m_upZ.reserve(_capacity);
+  m_speed.reserve(_capacity);
+  m_rot.reserve(_capacity);
+  m_prevRot.reserve(_capacity);
+  m_size.reserve(_capacity);
+  m_onAtmosphere.reserve(_capacity);
+  m_life.reserve(_capacity);
+  m_type.reserve(_capacity);
+
+#ifndef HEADLESS
+  // The storage for the buffer is allocated when drawing as it's orphaned every frame
+  glGenBuffers(1, &m_vbo);
+
+  m_cull = frustum::select();
+
+  m_program = loadShaderProgram("shaders/asteroid.vert", "shaders/asteroid.frag");
+  m_instanceLoc = glGetAttribLocation(m_program, "a_instance");
+  m_rotLoc = glGetAttribLocation(m_program, "a_rot");
+  m_texLoc = glGetUniformLocation(m_program, "u_tex");
+#endif
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+AsteroidField::~AsteroidField()
+{
+#ifndef HEADLESS
+  glDeleteBuffers(1, &m_vbo);
+  glDeleteProgram(m_program);
+#endif
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+handle AsteroidField::insert(
+                             const Vec4 &_p,
+                             const Vec4 &_d,
+                             const Vec4 &_up,
+                             const float _s,
+                             const float _sp,
+                             const int _l,
+                             const int _t
+                            )
+{
+  handle h = m_slots.insert();
+
+  m_x.push_back(_p.m_x); m_y.push_back(_p.m_y); m_z.push_back(_p.m_z);
+  m_prevX.push_back(_p.m_x); m_prevY.push_back(_p.m_y); m_prevZ.push_back(_p.m_z);
+  m_dirX.push_back(_d.m_x); m_dirY.push_back(_d.m_y); m_dirZ.push_back(_d.m_z);
+  m_upX.push_back(_up.m_x); m_upY.push_back(_up.m_y); m_upZ.push_back(_up.m_z);
+  m_speed.push_back(_sp);
+  m_rot.push_back(0.0f);
+  m_prevRot.push_back(0.0f);
+  m_size.push_back(_s);
+  m_onAtmosphere.push_back(0);
+  m_life.push_back(_l);
+  m_type.push_back(_t);
+
+  return h;
+}
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void Asteroid::draw(
-                    const std::vector<GLuint> &_dL
+/// @brief Moves the last element of an array in to the given index and drops the last one
+/// @param[io] io_v Array to modify
+/// @param[in] _i Index to move the last element to
+// ---------------------------------------------------------------------------------------
+template <class V>
+static void swapPop(
+                    V &io_v,
+                    const int _i
                    )
 {
-  // Call the move function
-  move();
-  glPushMatrix();
+  io_v[_i] = io_v.back();
+  io_v.pop_back();
+}
+// ---------------------------------------------------------------------------------------
 
-    // Rotate the asteroid, scale it and translate it to its correct position
-    glTranslatef(m_pos.m_x, m_pos.m_y, m_pos.m_z);
-    glScalef(m_size, m_size, m_size);
-    glRotatef(m_rot, 1.0f, 1.0f, 1.0f);
+// ---------------------------------------------------------------------------------------
+bool AsteroidField::remove(
+                           const handle &_h
+                          )
+{
+  int i = m_slots.remove(_h);
+  if(i < 0)
+    return false;
 
-    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-    // Call the displaylist with the wanted asteroid model
-    glCallList(_dL[c_aType]);
+  // Move the last asteroid in to the removed one's place in every array like the slots
+  swapPop(m_x, i); swapPop(m_y, i); swapPop(m_z, i);
+  swapPop(m_prevX, i); swapPop(m_prevY, i); swapPop(m_prevZ, i);
+  swapPop(m_dirX, i); swapPop(m_dirY, i); swapPop(m_dirZ, i);
+  swapPop(m_upX, i); swapPop(m_upY, i); swapPop(m_upZ, i);
+  swapPop(m_speed, i);
+  swapPop(m_rot, i);
+  swapPop(m_prevRot, i);
+  swapPop(m_size, i);
+  swapPop(m_onAtmosphere, i);
+  swapPop(m_life, i);
+  swapPop(m_type, i);
+
+  return true;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+bool AsteroidField::valid(
+                          const handle &_h
+                         ) const
+{
+  return m_slots.valid(_h);
+}
+// ---------------------------------------------------------------------------------------
 
-  glPopMatrix();
+// ---------------------------------------------------------------------------------------
+void AsteroidField::clear()
+{
+  while(size())
+    remove(handleAt(size() - 1));
 }
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void Asteroid::move()
+int AsteroidField::update(
+                          const float _dt,
+                          std::vector<int> &io_reached
+                         )
 {
-  // Check if asteroid is yet to reach the atmosphere
-  // and move it towards the planet if so
-  if(m_pos.length() > WORLDRADIUS*ASPHERERADIUS && m_speed > 0.031f)
+  if((int)io_reached.size() < size())
+    io_reached.resize(size());
+  if(!size())
+    return 0;
+
+  asteroidKernel::batch b = {
+    &m_x[0], &m_y[0], &m_z[0],
+    &m_prevX[0], &m_prevY[0], &m_prevZ[0],
+    &m_dirX[0], &m_dirY[0], &m_dirZ[0],
+    &m_upX[0], &m_upY[0], &m_upZ[0],
+    &m_speed[0],
+    &m_rot[0], &m_prevRot[0],
+    &m_onAtmosphere[0],
+    size()
+  };
+
+  // The speeds are given per simulation step so scale them by the elapsed time
+  return m_kernel(b, _dt / SIMSTEP, &io_reached[0]);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+int AsteroidField::lodLevel(
+                            const float _pixels
+                           )
+{
+  int level = 0;
+  for(float limit = ASTEROIDLODPIXELS; level < ASTEROIDLODS - 1 && _pixels < limit; limit *= 0.5f)
+    ++level;
+  return level;
+}
+// ---------------------------------------------------------------------------------------
+
+#ifndef HEADLESS
+// ---------------------------------------------------------------------------------------
+void AsteroidField::draw(
+                         const Mesh _meshes[ASTEROIDTYPES][ASTEROIDLODS],
+                         const float _alpha,
+                         const frustum::planes &_frustum,
+                         frustum::counter &io_counter
+                        ) const
+{
+  if(!size())
+    return;
+
+  // Interpolate between the last two updates to keep the movement smooth regardless of
+  // the rendering rate, then cull the asteroids by the spheres bounding their models
+  m_drawX.resize(size()); m_drawY.resize(size()); m_drawZ.resize(size());
+  m_drawR.resize(size());
+  m_visible.resize(size());
+  for(int i = 0; i < size(); ++i)
+  {
+    m_drawX[i] = m_prevX[i] + (m_x[i] - m_prevX[i]) * _alpha;
+    m_drawY[i] = m_prevY[i] + (m_y[i] - m_prevY[i]) * _alpha;
+    m_drawZ[i] = m_prevZ[i] + (m_z[i] - m_prevZ[i]) * _alpha;
+    m_drawR[i] = m_size[i] * _meshes[m_type[i]][0].radius();
+  }
+
+  frustum::spheres spheres = {&m_drawX[0], &m_drawY[0], &m_drawZ[0], &m_drawR[0], size()};
+  int visible = m_cull(_frustum, spheres, &m_visible[0]);
+  io_counter.m_visible += visible;
+  io_counter.m_culled += size() - visible;
+  if(!visible)
+    return;
+
+  // Pick the level of each visible asteroid by the radius of its bounding sphere on the
+  // screen, the ones reaching past the near plane are as big as they get. The size is
+  // measured in the viewport the same way the projectiles' point sizes are.
+  GLint viewport[4];
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  const float pixels = frustum::focalLength(_frustum) * viewport[3] * 0.5f;
+  int start[ASTEROIDTYPES * ASTEROIDLODS] = {0};
+  int count[ASTEROIDTYPES * ASTEROIDLODS] = {0};
+  m_batch.resize(visible);
+  for(int k = 0; k < visible; ++k)
   {
-    m_pos += m_dir * m_speed;
-    m_rot += 5;
+    int i = m_visible[k];
+    float depth = std::max(frustum::depth(_frustum, m_drawX[i], m_drawY[i], m_drawZ[i]), m_drawR[i]);
+    m_batch[k] = m_type[i] * ASTEROIDLODS + lodLevel(m_drawR[i] * pixels / depth);
+    ++count[m_batch[k]];
   }
-  else
+  for(int b = 1; b < ASTEROIDTYPES * ASTEROIDLODS; ++b)
+    start[b] = start[b - 1] + count[b - 1];
+
+  // Orphan the old storage and write the visible instances straight in to the new one
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+  glBufferData(GL_ARRAY_BUFFER, visible * sizeof(asteroidInstance), NULL, GL_STREAM_DRAW);
+
+  asteroidInstance *v = static_cast<asteroidInstance *>(glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY));
+  if(!v)
   {
-    // If the asteroid has reached the atmosphere we reduce the speed and
-    // calculate new up and side vectors to move the asteroid around the
-    // planet but keeping it on the atmosphere surface
-    m_speed = 0.03f;
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return;
+  }
 
-    m_pos.normalize();
-    m_side = m_pos.cross(m_up);
-    m_side.normalize();
-    m_pos *= WORLDRADIUS*ASPHERERADIUS;
+  // Each batch's instances end up next to each other in the buffer
+  int next[ASTEROIDTYPES * ASTEROIDLODS];
+  std::copy(start, start + ASTEROIDTYPES * ASTEROIDLODS, next);
+  for(int k = 0; k < visible; ++k)
+  {
+    int i = m_visible[k];
+    asteroidInstance &inst = v[next[m_batch[k]]++];
 
-    m_pos.m_x += m_speed * m_side.m_x;
-    m_pos.m_y += m_speed * m_side.m_y;
-    m_pos.m_z += m_speed * m_side.m_z;
+    inst.m_x = m_drawX[i];
+    inst.m_y = m_drawY[i];
+    inst.m_z = m_drawZ[i];
+    inst.m_size = m_size[i];
+    inst.m_rot = m_prevRot[i] + (m_rot[i] - m_prevRot[i]) * _alpha;
+  }
 
-    ++m_rot;
+  if(glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE)
+  {
+    glUseProgram(m_program);
+    glUniform1i(m_texLoc, 0);
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+    glEnableVertexAttribArray(m_instanceLoc);
+    glEnableVertexAttribArray(m_rotLoc);
+    glVertexAttribDivisorARB(m_instanceLoc, 1);
+    glVertexAttribDivisorARB(m_rotLoc, 1);
+
+    for(int b = 0; b < ASTEROIDTYPES * ASTEROIDLODS; ++b)
+    {
+      if(!count[b])
+        continue;
+
+      // Point the instance attributes at the batch's range of the instance buffer
+      glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+      size_t offset = start[b] * sizeof(asteroidInstance);
+      glVertexAttribPointer(m_instanceLoc, 4, GL_FLOAT, GL_FALSE, sizeof(asteroidInstance), (const GLvoid *)offset);
+      glVertexAttribPointer(m_rotLoc, 1, GL_FLOAT, GL_FALSE, sizeof(asteroidInstance), (const GLvoid *)(offset + 4 * sizeof(GLfloat)));
+
+      _meshes[b / ASTEROIDLODS][b % ASTEROIDLODS].drawInstanced(count[b]);
+    }
+
+    glVertexAttribDivisorARB(m_instanceLoc, 0);
+    glVertexAttribDivisorARB(m_rotLoc, 0);
+    glDisableVertexAttribArray(m_rotLoc);
+    glDisableVertexAttribArray(m_instanceLoc);
+
+    glUseProgram(0);
   }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 // ---------------------------------------------------------------------------------------
+#endif
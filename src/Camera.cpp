@@ -18,21 +18,31 @@ void Camera::initCamera()
   this->orient = GLFunctions::orientation(m_eye,
                                           m_look,
                                           m_up);
-  // Load the modelview and projection
+  // Load the modelview and projection and get the frustum they make
   this->orient.loadModelView();
-  GLFunctions::perspective(m_fov, m_a, m_n, m_f);
+  m_project = GLFunctions::perspective(m_fov, m_a, m_n, m_f);
+  m_frustum = frustum::extract(orient, m_project);
 }
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void Camera::updateCamera()
+void Camera::updateCamera(
+                          const float _alpha
+                         )
 {
+  // Interpolate the position between the last two updates and keep it on
+  // the orbit around the planet
+  Vec4 eye = m_prevEye + (m_eye - m_prevEye) * _alpha;
+  eye.normalize();
+  eye *= CAMRADIUS;
+
   // Get the MV matrix from the pos, lookat and up vectors
-  this->orient = GLFunctions::orientation(m_eye,
+  this->orient = GLFunctions::orientation(eye,
                                           m_look,
                                           m_up);
-  // Load the modelview and projection
+  // Load the modelview and projection and get the frustum they make
   this->orient.loadModelView();
-  GLFunctions::perspective(m_fov, m_a, m_n, m_f);
+  m_project = GLFunctions::perspective(m_fov, m_a, m_n, m_f);
+  m_frustum = frustum::extract(orient, m_project);
 }
 // ---------------------------------------------------------------------------------------
@@ -0,0 +1,269 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#include <cmath>
+
+#include "Frustum.h"
+#include "Simd.h"
+
+// ---------------------------------------------------------------------------------------
+/// @file Frustum.cpp
+/// @brief Implementation of the frustum plane extraction, the culling kernels and the
+///        runtime kernel selection. The visible spheres are compacted from the comparison
+///        masks one set bit at a time like the narrowphase hits.
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+frustum::planes frustum::extract(
+                                 const Mat4 &_modelView,
+                                 const Mat4 &_projection
+                                )
+{
+  // The matrices are column major, m_m[column][row]
+  float clip[4][4];
+  for(int r = 0; r < 4; ++r)
+    for(int c = 0; c < 4; ++c)
+    {
+      clip[r][c] = 0.0f;
+      for(int k = 0; k < 4; ++k)
+        clip[r][c] += _projection.m_m[k][r] * _modelView.m_m[c][k];
+    }
+
+  // Left and right come from the x row, bottom and top from y and near and far from z
+  planes p;
+  for(int i = 0; i < 6; ++i)
+  {
+    const float sign = (i % 2) ? -1.0f : 1.0f;
+    const float *row = clip[i / 2];
+    float a = clip[3][0] + sign * row[0];
+    float b = clip[3][1] + sign * row[1];
+    float c = clip[3][2] + sign * row[2];
+    float d = clip[3][3] + sign * row[3];
+
+    float length = sqrtf(a*a + b*b + c*c);
+    p.m_a[i] = a / length;
+    p.m_b[i] = b / length;
+    p.m_c[i] = c / length;
+    p.m_d[i] = d / length;
+  }
+
+  return p;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+frustum::planes frustum::scale(
+                               const planes &_p,
+                               const float _s
+                              )
+{
+  // A point p in the scaled space is at s * p, the normals stay the same and the
+  // distances shrink by the scale
+  planes p = _p;
+  for(int i = 0; i < 6; ++i)
+    p.m_d[i] /= _s;
+
+  return p;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+float frustum::focalLength(
+                           const planes &_p
+                          )
+{
+  // The cosine of the angle between the top (3) and near (4) plane normals is the sine
+  // of half the field of view
+  float sine = _p.m_a[3] * _p.m_a[4] + _p.m_b[3] * _p.m_b[4] + _p.m_c[3] * _p.m_c[4];
+  return sqrtf(1.0f - sine * sine) / sine;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+float frustum::depth(
+                     const planes &_p,
+                     const float _x,
+                     const float _y,
+                     const float _z
+                    )
+{
+  return _p.m_a[4] * _x + _p.m_b[4] * _y + _p.m_c[4] * _z + _p.m_d[4];
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+int frustum::cullScalar(
+                        const planes &_p,
+                        const spheres &_s,
+                        int *o_visible
+                       )
+{
+  int visible = 0;
+  for(int i = 0; i < _s.m_count; ++i)
+  {
+    // The sphere is culled when it's completely outside any of the planes
+    bool inside = true;
+    for(int j = 0; j < 6; ++j)
+      inside &= _p.m_a[j] * _s.m_x[i] + _p.m_b[j] * _s.m_y[i] + _p.m_c[j] * _s.m_z[i] + _p.m_d[j] >= -_s.m_r[i];
+
+    // Always write the index and only advance the count when visible
+    o_visible[visible] = i;
+    visible += inside;
+  }
+
+  return visible;
+}
+// ---------------------------------------------------------------------------------------
+
+#ifdef SIMD_X86
+// ---------------------------------------------------------------------------------------
+__attribute__((target("sse2")))
+int frustum::cullSSE(
+                     const planes &_p,
+                     const spheres &_s,
+                     int *o_visible
+                    )
+{
+  int visible = 0;
+  int i = 0;
+  for(; i + 4 <= _s.m_count; i += 4)
+  {
+    __m128 x = _mm_loadu_ps(_s.m_x + i);
+    __m128 y = _mm_loadu_ps(_s.m_y + i);
+    __m128 z = _mm_loadu_ps(_s.m_z + i);
+    __m128 r = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(_s.m_r + i));
+
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for(int j = 0; j < 6; ++j)
+    {
+      // Summed in the same order as the scalar kernel so they agree on the edges
+      __m128 d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(_p.m_a[j]), x),
+                            _mm_mul_ps(_mm_set1_ps(_p.m_b[j]), y));
+      d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(_p.m_c[j]), z));
+      d = _mm_add_ps(d, _mm_set1_ps(_p.m_d[j]));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(d, r));
+    }
+
+    int mask = _mm_movemask_ps(inside);
+    while(mask)
+    {
+      o_visible[visible++] = i + __builtin_ctz(mask);
+      mask &= mask - 1;
+    }
+  }
+
+  // Cull the leftover spheres with the scalar kernel, the indices it writes count from
+  // the start of the tail so they're moved along by i
+  spheres tail = _s;
+  tail.m_x += i; tail.m_y += i; tail.m_z += i;
+  tail.m_r += i;
+  tail.m_count -= i;
+
+  int tailVisible = cullScalar(_p, tail, o_visible + visible);
+  for(int k = visible; k < visible + tailVisible; ++k)
+    o_visible[k] += i;
+
+  return visible + tailVisible;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+__attribute__((target("avx2")))
+int frustum::cullAVX2(
+                      const planes &_p,
+                      const spheres &_s,
+                      int *o_visible
+                     )
+{
+  int visible = 0;
+  int i = 0;
+  for(; i + 8 <= _s.m_count; i += 8)
+  {
+    __m256 x = _mm256_loadu_ps(_s.m_x + i);
+    __m256 y = _mm256_loadu_ps(_s.m_y + i);
+    __m256 z = _mm256_loadu_ps(_s.m_z + i);
+    __m256 r = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(_s.m_r + i));
+
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for(int j = 0; j < 6; ++j)
+    {
+      __m256 d = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(_p.m_a[j]), x),
+                               _mm256_mul_ps(_mm256_set1_ps(_p.m_b[j]), y));
+      d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(_p.m_c[j]), z));
+      d = _mm256_add_ps(d, _mm256_set1_ps(_p.m_d[j]));
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, r, _CMP_GE_OQ));
+    }
+
+    int mask = _mm256_movemask_ps(inside);
+    while(mask)
+    {
+      o_visible[visible++] = i + __builtin_ctz(mask);
+      mask &= mask - 1;
+    }
+  }
+
+  // Cull the leftover spheres with the scalar kernel, the indices it writes count from
+  // the start of the tail so they're moved along by i
+  spheres tail = _s;
+  tail.m_x += i; tail.m_y += i; tail.m_z += i;
+  tail.m_r += i;
+  tail.m_count -= i;
+
+  simd::zeroUpper();
+  int tailVisible = cullScalar(_p, tail, o_visible + visible);
+  for(int k = visible; k < visible + tailVisible; ++k)
+    o_visible[k] += i;
+
+  return visible + tailVisible;
+}
+// ---------------------------------------------------------------------------------------
+#else
+// ---------------------------------------------------------------------------------------
+int frustum::cullSSE(
+                     const planes &_p,
+                     const spheres &_s,
+                     int *o_visible
+                    )
+{
+  return cullScalar(_p, _s, o_visible);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+int frustum::cullAVX2(
+                      const planes &_p,
+                      const spheres &_s,
+                      int *o_visible
+                     )
+{
+  return cullScalar(_p, _s, o_visible);
+}
+// ---------------------------------------------------------------------------------------
+#endif
+
+// ---------------------------------------------------------------------------------------
+bool frustum::supported(
+                        const kernel _k
+                       )
+{
+  return simd::supported(simd::levelOf(_k, cullSSE, cullAVX2));
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+frustum::kernel frustum::select()
+{
+  return simd::select<kernel>(cullScalar, cullSSE, cullAVX2);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+const char *frustum::name(
+                          const kernel _k
+                         )
+{
+  return simd::name(simd::levelOf(_k, cullSSE, cullAVX2));
+}
+// ---------------------------------------------------------------------------------------
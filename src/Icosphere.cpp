@@ -0,0 +1,122 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#include <algorithm>
+
+#include "Icosphere.h"
+
+// ---------------------------------------------------------------------------------------
+/// @file Icosphere.cpp
+/// @brief Implementation of the geodesic sphere subdivision
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Coordinates of the icosahedron's vertices, (0, ±c, ±s) and its rotations are on
+///        the unit sphere
+// ---------------------------------------------------------------------------------------
+static const float icosC = 0.525731f;
+static const float icosS = 0.850651f;
+
+// ---------------------------------------------------------------------------------------
+/// @brief Triangles of the icosahedron as indices to the vertices made in the ctor
+// ---------------------------------------------------------------------------------------
+static const unsigned int icosTriangles[20][3] = {
+  {0, 1, 4}, {0, 6, 1}, {3, 2, 5}, {2, 3, 7},
+  {4, 5, 8}, {5, 4, 10}, {11, 10, 1}, {10, 11, 3},
+  {6, 7, 11}, {7, 6, 9}, {8, 9, 0}, {9, 8, 2},
+  {4, 1, 10}, {0, 4, 8}, {3, 5, 10}, {5, 2, 8},
+  {1, 6, 11}, {6, 0, 9}, {3, 11, 7}, {2, 7, 9}
+};
+
+// ---------------------------------------------------------------------------------------
+Icosphere::Icosphere(
+                     const int _subdivisions
+                    )
+{
+  const Vec4 base[12] = {
+    Vec4(icosS, 0.0f, icosC, 0.0f), Vec4(icosS, 0.0f, -icosC, 0.0f),
+    Vec4(-icosS, 0.0f, icosC, 0.0f), Vec4(-icosS, 0.0f, -icosC, 0.0f),
+    Vec4(icosC, icosS, 0.0f, 0.0f), Vec4(-icosC, icosS, 0.0f, 0.0f),
+    Vec4(icosC, -icosS, 0.0f, 0.0f), Vec4(-icosC, -icosS, 0.0f, 0.0f),
+    Vec4(0.0f, icosC, icosS, 0.0f), Vec4(0.0f, -icosC, icosS, 0.0f),
+    Vec4(0.0f, icosC, -icosS, 0.0f), Vec4(0.0f, -icosC, -icosS, 0.0f)
+  };
+
+  // Every level quadruples the triangles and adds a vertex for each edge, of which there
+  // are one and a half per triangle
+  m_vertices.reserve(10 * (1 << (2 * _subdivisions)) + 2);
+  m_vertices.assign(base, base + 12);
+  m_indices.assign(&icosTriangles[0][0], &icosTriangles[0][0] + 60);
+
+  std::vector<unsigned int> split;
+  std::unordered_map<unsigned long long, unsigned int> midpoints;
+  for(int d = 0; d < _subdivisions; ++d)
+  {
+    // The edges of the previous level are gone, so are their midpoints
+    midpoints.clear();
+    split.clear();
+    split.reserve(m_indices.size() * 4);
+
+    for(size_t t = 0; t < m_indices.size(); t += 3)
+    {
+      unsigned int a = m_indices[t];
+      unsigned int b = m_indices[t + 1];
+      unsigned int c = m_indices[t + 2];
+      unsigned int ab = midpoint(a, b, midpoints);
+      unsigned int bc = midpoint(b, c, midpoints);
+      unsigned int ca = midpoint(c, a, midpoints);
+
+      /*   /\      /\
+          /  \ => /__\
+         /____\  /_\/_\ */
+      const unsigned int children[12] = {a, ab, ca,
+                                         ab, b, bc,
+                                         ca, bc, c,
+                                         ab, bc, ca};
+      split.insert(split.end(), children, children + 12);
+    }
+
+    m_indices.swap(split);
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+unsigned int Icosphere::midpoint(
+                                 const unsigned int _a,
+                                 const unsigned int _b,
+                                 std::unordered_map<unsigned long long, unsigned int> &io_midpoints
+                                )
+{
+  // Both triangles on an edge see it the other way round, so key it by the smaller end
+  unsigned long long key = ((unsigned long long)std::min(_a, _b) << 32) | std::max(_a, _b);
+  std::pair<std::unordered_map<unsigned long long, unsigned int>::iterator, bool> found =
+    io_midpoints.insert(std::make_pair(key, (unsigned int)m_vertices.size()));
+
+  if(found.second)
+  {
+    Vec4 p = (m_vertices[_a] + m_vertices[_b]) / 2.0f;
+    p.normalize();
+    m_vertices.push_back(p);
+  }
+  return found.first->second;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Icosphere::addTo(
+                      Mesh &io_m,
+                      const float _radius
+                     ) const
+{
+  // The vertices are on the unit sphere so they're their own normals
+  std::vector<Vec4> positions(m_vertices.size());
+  for(size_t i = 0; i < m_vertices.size(); ++i)
+    positions[i] = m_vertices[i] * _radius;
+
+  io_m.addIndexed(&positions[0], &m_vertices[0], (int)m_vertices.size(),
+                  &m_indices[0], (int)m_indices.size());
+}
+// ---------------------------------------------------------------------------------------
@@ -4,10 +4,15 @@
  Initial file parsing code © by Jonathan Macey
 */
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <boost/lexical_cast.hpp>
-#include <boost/format.hpp>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "LoadOBJ.h"
 
@@ -16,89 +21,470 @@
 /// @brief Implementation mesh loading functions
 // ---------------------------------------------------------------------------------------
 
+// ---------------------------------------------------------------------------------------
+/// @brief Maps a whole file in to memory for reading
+/// @param[in] _n Path to the file
+/// @param[out] o_size Size of the file
+/// @param[out] o_st Status of the file
+/// @return Pointer to the mapped file or NULL if it couldn't be mapped, needs to be
+///         unmapped with munmap
+// ---------------------------------------------------------------------------------------
+static const unsigned char *mapFile(
+                                    const std::string &_n,
+                                    size_t &o_size,
+                                    struct stat &o_st
+                                   )
+{
+  int fd = open(_n.c_str(), O_RDONLY);
+  if(fd < 0)
+    return NULL;
+
+  void *p = MAP_FAILED;
+  if(!fstat(fd, &o_st) && o_st.st_size > 0)
+  {
+    o_size = (size_t)o_st.st_size;
+    p = mmap(NULL, o_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+
+  // The mapping stays valid after the file is closed
+  close(fd);
+  return p == MAP_FAILED ? NULL : static_cast<const unsigned char *>(p);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Gets the size, modification time and hash (FNV-1a) of an OBJ-file to key the
+///        cache with
+/// @param[in] _n Path to the OBJ-file
+/// @param[out] o_h Cache header to store the values in
+/// @return False if the file couldn't be read
+// ---------------------------------------------------------------------------------------
+static bool sourceKey(
+                      const std::string &_n,
+                      modelCacheHeader &o_h
+                     )
+{
+  struct stat st;
+  size_t size = 0;
+  const unsigned char *p = mapFile(_n, size, st);
+  if(!p)
+    return false;
+
+  uint64_t h = 14695981039346656037ull;
+  for(size_t i = 0; i < size; ++i)
+  {
+    h ^= p[i];
+    h *= 1099511628211ull;
+  }
+  munmap(const_cast<unsigned char *>(p), size);
+
+  o_h.m_sourceSize = size;
+  o_h.m_sourceMtime = (int64_t)st.st_mtime;
+  o_h.m_sourceHash = h;
+  return true;
+}
+// ---------------------------------------------------------------------------------------
+
 // ---------------------------------------------------------------------------------------
 void loadModel(
                const std::string &_n,
                model &o_m
               )
 {
-  // Open the filestream for reading a file
-  std::fstream fileIn;
-  fileIn.open(_n.c_str(), std::ios::in);
+  if(loadModelCache(_n, o_m))
+    return;
+
+  parseOBJ(_n, o_m);
+  saveModelCache(_n, o_m);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Checks whether a character separates the tokens of an OBJ-line, the same
+///        separators the old tokenizer used
+/// @param[in] _c Character to check
+/// @return True for spaces, slashes, tabs and line endings
+// ---------------------------------------------------------------------------------------
+static inline bool isSeparator(
+                               const char _c
+                              )
+{
+  return _c == ' ' || _c == '/' || _c == '\t' || _c == '\r' || _c == '\n';
+}
+// ---------------------------------------------------------------------------------------
 
-  // Make sure that the file was opened
-  if(!fileIn.is_open())
+// ---------------------------------------------------------------------------------------
+/// @brief Skips the separators before the next token on the line
+/// @param[in] _p Current position
+/// @param[in] _end End of the line
+/// @return Start of the next token or _end
+// ---------------------------------------------------------------------------------------
+static inline const char *nextToken(
+                                    const char *_p,
+                                    const char *_end
+                                   )
+{
+  while(_p < _end && isSeparator(*_p))
+    ++_p;
+  return _p;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Parses a float token in place, like from_chars. Plain decimals with up to 7
+///        significant digits (every OBJ exporter writes those) are converted exactly with
+///        a single float multiply or divide, which gives the correctly rounded value.
+///        Anything else is copied in to a small stack buffer and converted with strtof.
+/// @param[in] _p Start of the token
+/// @param[in] _end End of the line
+/// @param[out] o_f Parsed value
+/// @return End of the token or NULL if the token isn't a valid float
+// ---------------------------------------------------------------------------------------
+static const char *parseFloat(
+                              const char *_p,
+                              const char *_end,
+                              float &o_f
+                             )
+{
+  // Powers of ten that are exact in a float
+  static const float pow10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                                1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+  const char *p = _p;
+  bool negative = false;
+  if(p < _end && (*p == '-' || *p == '+'))
+    negative = *p++ == '-';
+
+  uint32_t mantissa = 0;
+  int digits = 0, scale = 0;
+  bool fast = true;
+  while(p < _end && *p >= '0' && *p <= '9')
   {
+    mantissa = mantissa * 10 + (*p++ - '0');
+    fast &= ++digits <= 8;
+  }
+  if(p < _end && *p == '.')
+  {
+    ++p;
+    while(p < _end && *p >= '0' && *p <= '9')
+    {
+      mantissa = mantissa * 10 + (*p++ - '0');
+      fast &= ++digits <= 8;
+      ++scale;
+    }
+  }
+
+  // Integers up to 2^24 and powers of ten up to 10^10 are exact in a float, so the only
+  // rounding happens in the division
+  if(fast && digits && scale <= 10 && mantissa <= (1u << 24) && (p == _end || isSeparator(*p)))
+  {
+    o_f = (float)mantissa / pow10[scale];
+    if(negative)
+      o_f = -o_f;
+    return p;
+  }
+
+  // Exponents, long mantissas, inf and nan go through the C library
+  char buffer[64];
+  size_t length = 0;
+  while(_p + length < _end && !isSeparator(_p[length]) && length < sizeof(buffer) - 1)
+  {
+    buffer[length] = _p[length];
+    ++length;
+  }
+  buffer[length] = '\0';
+
+  char *parsed = NULL;
+  o_f = strtof(buffer, &parsed);
+  if(!length || parsed != buffer + length)
+    return NULL;
+  return _p + length;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Parses an int token in place, like from_chars
+/// @param[in] _p Start of the token
+/// @param[in] _end End of the line
+/// @param[out] o_i Parsed value
+/// @return End of the token or NULL if the token isn't a valid int
+// ---------------------------------------------------------------------------------------
+static const char *parseInt(
+                            const char *_p,
+                            const char *_end,
+                            int &o_i
+                           )
+{
+  const char *p = _p;
+  bool negative = false;
+  if(p < _end && (*p == '-' || *p == '+'))
+    negative = *p++ == '-';
+
+  const char *digits = p;
+  int value = 0;
+  while(p < _end && *p >= '0' && *p <= '9')
+    value = value * 10 + (*p++ - '0');
+
+  if(p == digits || (p < _end && !isSeparator(*p)))
+    return NULL;
+  o_i = negative ? -value : value;
+  return p;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Parses the next _count floats of a line in to a vector
+/// @param[io] io_p Position on the line, moved past the parsed floats
+/// @param[in] _end End of the line
+/// @param[in] _count Amount of floats to parse, 2 or 3
+/// @param[out] o_v Vector to store the floats in, z is 0 for 2 floats
+/// @return False if there weren't enough valid floats on the line
+// ---------------------------------------------------------------------------------------
+static bool parseVec(
+                     const char *&io_p,
+                     const char *_end,
+                     const int _count,
+                     Vec4 &o_v
+                    )
+{
+  float f[3] = {0.0f, 0.0f, 0.0f};
+  for(int i = 0; i < _count; ++i)
+  {
+    io_p = parseFloat(nextToken(io_p, _end), _end, f[i]);
+    if(!io_p)
+      return false;
+  }
+  o_v = Vec4(f[0], f[1], f[2]);
+  return true;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void parseOBJ(
+              const std::string &_n,
+              model &o_m
+             )
+{
+  // Map the whole file in to memory, the parser works on it in place
+  struct stat st;
+  size_t size = 0;
+  const unsigned char *data = mapFile(_n, size, st);
+  if(!data)
+  {
+    // An empty file just has no data in it
+    if(!stat(_n.c_str(), &st) && st.st_size == 0)
+      return;
     std::cerr << "Could not open " << _n << "\n";
     exit(EXIT_FAILURE);
   }
+  const char *begin = reinterpret_cast<const char *>(data);
+  const char *end = begin + size;
 
-  // Boost parser separator
-  boost::char_separator<char> sep(" /\t\r\n");
+  // Quick pass over the line starts to count the elements so the vectors are only
+  // allocated once
+  size_t verts = 0, norms = 0, texts = 0, faces = 0;
+  for(const char *line = begin; line < end; )
+  {
+    const char *p = nextToken(line, end);
+    if(p + 1 < end && isSeparator(p[1]))
+    {
+      verts += p[0] == 'v';
+      faces += p[0] == 'f';
+    }
+    else if(p + 2 < end && p[0] == 'v' && isSeparator(p[2]))
+    {
+      norms += p[1] == 'n';
+      texts += p[1] == 't';
+    }
 
-  // Read the file till we reach the end
-  std::string lineBuffer;
-  while(!fileIn.eof())
+    const char *next = static_cast<const char *>(memchr(line, '\n', end - line));
+    line = next ? next + 1 : end;
+  }
+  o_m.m_Verts.reserve(o_m.m_Verts.size() + verts);
+  o_m.m_Norms.reserve(o_m.m_Norms.size() + norms);
+  o_m.m_Text.reserve(o_m.m_Text.size() + texts);
+  o_m.m_Ind.reserve(o_m.m_Ind.size() + faces * 9);
+
+  // Parse the lines, the numbers are converted straight from the mapped file without
+  // copying any of the text
+  int lineNumber = 0;
+  for(const char *line = begin; line < end; )
   {
-    // Get a single line from the file and read it to the lineBuffer
-    getline(fileIn, lineBuffer, '\n');
-    if(lineBuffer.size() != 0)
+    ++lineNumber;
+    const char *lineEnd = static_cast<const char *>(memchr(line, '\n', end - line));
+    if(!lineEnd)
+      lineEnd = end;
+
+    // The first token tells what kind of data the line holds
+    const char *p = nextToken(line, lineEnd);
+    const char *token = p;
+    while(p < lineEnd && !isSeparator(*p))
+      ++p;
+    size_t length = p - token;
+
+    bool valid = true;
+    Vec4 v;
+
+    // Check if we found v i.e. vertex data and store it into the vertex data
+    // part of the supplied structure
+    if(length == 1 && token[0] == 'v')
     {
-      // Using boost to parse each line using the separators defined earlier
-      tokenizer tokens(lineBuffer, sep);
-      tokenizer::iterator it = tokens.begin();
-
-      // Check if we found v i.e. vertex data and store it into the vertex data
-      // part of the supplied structure
-      if(*it == "v")
-      {
-        Vec4 v(boost::lexical_cast<float>(*++it),
-               boost::lexical_cast<float>(*++it),
-               boost::lexical_cast<float>(*++it));
+      if((valid = parseVec(p, lineEnd, 3, v)))
         o_m.m_Verts.push_back(v);
-      }
-      // Check if we found vn i.e. vertex normal data and store it into the vertex
-      // normal data part of the supplied structure
-      else if(*it == "vn")
-      {
-        Vec4 n(boost::lexical_cast<float>(*++it),
-               boost::lexical_cast<float>(*++it),
-               boost::lexical_cast<float>(*++it));
-        o_m.m_Norms.push_back(n);
-      }
-      // Check if we found vt i.e. texture coordinate data and store it into the
-      // texture coordinate data part of the supplied structure
-      else if(*it == "vt")
-      {
-        Vec4 t(boost::lexical_cast<float>(*++it),
-               boost::lexical_cast<float>(*++it),
-               0);
-        o_m.m_Text.push_back(t);
-      }
-      // Check if we found f i.e. triangle index data and store it into the
-      // stl vector containing the indice data
-      else if(*it == "f")
-      {
-        // First vert, textcoords & norms
-        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
-        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
-        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
-
-        // Second vert, textcoords & norms
-        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
-        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
-        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
-
-        // Third vert, textcoords & norms
-        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
-        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
-        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
-      }
     }
+    // Check if we found vn i.e. vertex normal data and store it into the vertex
+    // normal data part of the supplied structure
+    else if(length == 2 && token[0] == 'v' && token[1] == 'n')
+    {
+      if((valid = parseVec(p, lineEnd, 3, v)))
+        o_m.m_Norms.push_back(v);
+    }
+    // Check if we found vt i.e. texture coordinate data and store it into the
+    // texture coordinate data part of the supplied structure
+    else if(length == 2 && token[0] == 'v' && token[1] == 't')
+    {
+      if((valid = parseVec(p, lineEnd, 2, v)))
+        o_m.m_Text.push_back(v);
+    }
+    // Check if we found f i.e. triangle index data, the vertex, texture coordinate
+    // and normal indices of each of the three corners
+    else if(length == 1 && token[0] == 'f')
+    {
+      int ind[9];
+      for(int i = 0; i < 9 && valid; ++i)
+        valid = (p = parseInt(nextToken(p, lineEnd), lineEnd, ind[i])) != NULL;
+      if(valid)
+        o_m.m_Ind.insert(o_m.m_Ind.end(), ind, ind + 9);
+    }
+
+    if(!valid)
+    {
+      std::cerr << "Malformed data in " << _n << " on line " << lineNumber << "\n";
+      exit(EXIT_FAILURE);
+    }
+
+    line = lineEnd < end ? lineEnd + 1 : end;
   }
 
-  // Close the file after we've reached the eof
-  fileIn.close();
+  munmap(const_cast<unsigned char *>(data), size);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+std::string modelCachePath(
+                           const std::string &_n
+                          )
+{
+  return _n + ".cache";
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+bool loadModelCache(
+                    const std::string &_n,
+                    model &o_m
+                   )
+{
+  struct stat st;
+  size_t size = 0;
+  const unsigned char *p = mapFile(modelCachePath(_n), size, st);
+  if(!p)
+    return false;
+
+  // The cache is only used if it's complete and was written from the current OBJ-file,
+  // the hash catches edits that keep the size and the mtime (e.g. a checkout)
+  modelCacheHeader key;
+  const modelCacheHeader *h = reinterpret_cast<const modelCacheHeader *>(p);
+  bool valid = size >= sizeof(modelCacheHeader) &&
+               !memcmp(h->m_magic, MODELCACHEMAGIC, 4) &&
+               h->m_version == MODELCACHEVERSION &&
+               size == sizeof(modelCacheHeader) +
+                       ((size_t)h->m_vertCount * 3 + (size_t)h->m_normCount * 3 +
+                        (size_t)h->m_textCount * 2) * sizeof(float) +
+                       (size_t)h->m_indCount * sizeof(uint32_t) &&
+               sourceKey(_n, key) &&
+               h->m_sourceSize == key.m_sourceSize &&
+               h->m_sourceMtime == key.m_sourceMtime &&
+               h->m_sourceHash == key.m_sourceHash;
+
+  if(valid)
+  {
+    // Copy the flat arrays in to the model, built the same way as when parsing
+    const float *f = reinterpret_cast<const float *>(p + sizeof(modelCacheHeader));
+    o_m.m_Verts.reserve(o_m.m_Verts.size() + h->m_vertCount);
+    for(uint32_t i = 0; i < h->m_vertCount; ++i, f += 3)
+      o_m.m_Verts.push_back(Vec4(f[0], f[1], f[2]));
+    o_m.m_Norms.reserve(o_m.m_Norms.size() + h->m_normCount);
+    for(uint32_t i = 0; i < h->m_normCount; ++i, f += 3)
+      o_m.m_Norms.push_back(Vec4(f[0], f[1], f[2]));
+    o_m.m_Text.reserve(o_m.m_Text.size() + h->m_textCount);
+    for(uint32_t i = 0; i < h->m_textCount; ++i, f += 2)
+      o_m.m_Text.push_back(Vec4(f[0], f[1], 0));
+
+    const uint32_t *ind = reinterpret_cast<const uint32_t *>(f);
+    o_m.m_Ind.insert(o_m.m_Ind.end(), ind, ind + h->m_indCount);
+  }
+
+  munmap(const_cast<unsigned char *>(p), size);
+  return valid;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void saveModelCache(
+                    const std::string &_n,
+                    const model &_m
+                   )
+{
+  modelCacheHeader h;
+  if(!sourceKey(_n, h))
+    return;
+  memcpy(h.m_magic, MODELCACHEMAGIC, 4);
+  h.m_version = MODELCACHEVERSION;
+  h.m_vertCount = (uint32_t)_m.m_Verts.size();
+  h.m_normCount = (uint32_t)_m.m_Norms.size();
+  h.m_textCount = (uint32_t)_m.m_Text.size();
+  h.m_indCount = (uint32_t)_m.m_Ind.size();
+
+  // Flatten the data in to one buffer in the order it's stored in the file
+  std::vector<float> data;
+  data.reserve(h.m_vertCount * 3 + h.m_normCount * 3 + h.m_textCount * 2);
+  for(uint32_t i = 0; i < h.m_vertCount; ++i)
+  {
+    data.push_back(_m.m_Verts[i].m_x);
+    data.push_back(_m.m_Verts[i].m_y);
+    data.push_back(_m.m_Verts[i].m_z);
+  }
+  for(uint32_t i = 0; i < h.m_normCount; ++i)
+  {
+    data.push_back(_m.m_Norms[i].m_x);
+    data.push_back(_m.m_Norms[i].m_y);
+    data.push_back(_m.m_Norms[i].m_z);
+  }
+  for(uint32_t i = 0; i < h.m_textCount; ++i)
+  {
+    data.push_back(_m.m_Text[i].m_x);
+    data.push_back(_m.m_Text[i].m_y);
+  }
+  std::vector<uint32_t> ind(_m.m_Ind.begin(), _m.m_Ind.end());
+
+  // Write to a temporary file and rename it over the cache so a partly written cache
+  // is never picked up
+  std::string path = modelCachePath(_n);
+  std::string tmp = path + ".tmp";
+  std::ofstream fileOut(tmp.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if(!fileOut.is_open())
+    return;
+
+  fileOut.write(reinterpret_cast<const char *>(&h), sizeof(modelCacheHeader));
+  if(!data.empty())
+    fileOut.write(reinterpret_cast<const char *>(&data[0]), data.size() * sizeof(float));
+  if(!ind.empty())
+    fileOut.write(reinterpret_cast<const char *>(&ind[0]), ind.size() * sizeof(uint32_t));
+  fileOut.close();
+
+  if(fileOut.fail() || rename(tmp.c_str(), path.c_str()))
+    remove(tmp.c_str());
 }
 // ---------------------------------------------------------------------------------------
 
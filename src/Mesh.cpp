@@ -0,0 +1,1116 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <queue>
+
+#include "Mesh.h"
+
+// ---------------------------------------------------------------------------------------
+/// @file Mesh.cpp
+/// @brief Implementation of the GPU mesh building and drawing
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+size_t meshVertexHash::operator()(
+                                  const meshVertex &_v
+                                 ) const
+{
+  const unsigned char *p = reinterpret_cast<const unsigned char *>(&_v);
+  size_t h = 2166136261u;
+  for(size_t i = 0; i < sizeof(meshVertex); ++i)
+  {
+    h ^= p[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+bool meshVertexEqual::operator()(
+                                 const meshVertex &_a,
+                                 const meshVertex &_b
+                                ) const
+{
+  return !memcmp(&_a, &_b, sizeof(meshVertex));
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+Mesh::Mesh() :
+  m_hasColours(false),
+  m_hasTexCoords(false),
+  m_optimized(false),
+  m_vbo(0),
+  m_ibo(0),
+  m_vertexCount(0),
+  m_indexCount(0),
+  m_emittedCount(0),
+  m_acmrBefore(0.0f),
+  m_acmrAfter(0.0f),
+  m_radius(0.0f),
+  m_cull(frustum::select())
+{
+  // Zero the whole vertex so the unused attributes hash the same way, the colour
+  // defaults to white like the GL colour
+  memset(&m_current, 0, sizeof(meshVertex));
+  m_current.m_r = m_current.m_g = m_current.m_b = m_current.m_a = 255;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+Mesh::~Mesh()
+{
+#ifndef HEADLESS
+  if(m_vbo)
+    glDeleteBuffers(1, &m_vbo);
+  if(m_ibo)
+    glDeleteBuffers(1, &m_ibo);
+#endif
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Mesh::colour(
+                  const float _r,
+                  const float _g,
+                  const float _b,
+                  const float _a
+                 )
+{
+  m_hasColours = true;
+  m_current.m_r = (GLubyte)(_r * 255.0f + 0.5f);
+  m_current.m_g = (GLubyte)(_g * 255.0f + 0.5f);
+  m_current.m_b = (GLubyte)(_b * 255.0f + 0.5f);
+  m_current.m_a = (GLubyte)(_a * 255.0f + 0.5f);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Mesh::normal(
+                  const Vec4 &_n
+                 )
+{
+  m_current.m_nx = _n.m_x;
+  m_current.m_ny = _n.m_y;
+  m_current.m_nz = _n.m_z;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Mesh::texCoord(
+                    const Vec4 &_t
+                   )
+{
+  m_hasTexCoords = true;
+  m_current.m_u = _t.m_x;
+  m_current.m_v = _t.m_y;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Mesh::vertex(
+                  const Vec4 &_p
+                 )
+{
+  m_current.m_x = _p.m_x;
+  m_current.m_y = _p.m_y;
+  m_current.m_z = _p.m_z;
+  m_radius = std::max(m_radius, sqrtf(_p.m_x * _p.m_x + _p.m_y * _p.m_y + _p.m_z * _p.m_z));
+
+  // Reuse the index of an identical vertex if there already is one
+  std::pair<std::unordered_map<meshVertex, GLuint, meshVertexHash, meshVertexEqual>::iterator, bool> found =
+    m_lookup.insert(std::make_pair(m_current, (GLuint)m_vertices.size()));
+  if(found.second)
+    m_vertices.push_back(m_current);
+
+  m_indices.push_back(found.first->second);
+
+  ++m_emittedCount;
+  m_vertexCount = (int)m_vertices.size();
+  m_indexCount = (int)m_indices.size();
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Mesh::addIndexed(
+                      const Vec4 *_positions,
+                      const Vec4 *_normals,
+                      const int _vertexCount,
+                      const GLuint *_indices,
+                      const int _indexCount
+                     )
+{
+  // The new vertices go after the ones already in the mesh
+  GLuint first = (GLuint)m_vertices.size();
+  m_vertices.reserve(m_vertices.size() + _vertexCount);
+  for(int i = 0; i < _vertexCount; ++i)
+  {
+    const Vec4 &p = _positions[i];
+    normal(_normals[i]);
+    m_current.m_x = p.m_x;
+    m_current.m_y = p.m_y;
+    m_current.m_z = p.m_z;
+    m_radius = std::max(m_radius, sqrtf(p.m_x * p.m_x + p.m_y * p.m_y + p.m_z * p.m_z));
+    m_vertices.push_back(m_current);
+  }
+
+  m_indices.reserve(m_indices.size() + _indexCount);
+  for(int i = 0; i < _indexCount; ++i)
+    m_indices.push_back(first + _indices[i]);
+
+  m_emittedCount += _vertexCount;
+  m_vertexCount = (int)m_vertices.size();
+  m_indexCount = (int)m_indices.size();
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Mesh::addModel(
+                    const model &_m,
+                    const bool _texCoords
+                   )
+{
+  // The indices are stored as vertex, texture coordinate and normal for each corner
+  for(int i = 0; i < (int)_m.m_Ind.size(); i += 3)
+  {
+    normal(_m.m_Norms[_m.m_Ind[i + 2] - 1]);
+    if(_texCoords)
+      texCoord(_m.m_Text[_m.m_Ind[i + 1] - 1]);
+    vertex(_m.m_Verts[_m.m_Ind[i] - 1]);
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Measures the average cache miss ratio of a triangle list with a FIFO cache of
+///        MESHACMRCACHESIZE vertices
+/// @param[in] _indices Indices of the triangles
+/// @param[in] _vertexCount Amount of vertices the indices refer to
+/// @return Vertices transformed per triangle
+// ---------------------------------------------------------------------------------------
+static float fifoACMR(
+                      const std::vector<GLuint> &_indices,
+                      const int _vertexCount
+                     )
+{
+  if(_indices.empty())
+    return 0.0f;
+
+  // A vertex is in the cache if less than the cache size of vertices have been added
+  // after it, so only the time each one was added needs to be kept
+  std::vector<int> added(_vertexCount, -MESHACMRCACHESIZE);
+  int misses = 0;
+  for(size_t i = 0; i < _indices.size(); ++i)
+  {
+    if(misses - added[_indices[i]] >= MESHACMRCACHESIZE)
+      added[_indices[i]] = misses++;
+  }
+  return misses / (_indices.size() / 3.0f);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Score of a vertex for the triangle ordering (Tom Forsyth, Linear-Speed Vertex
+///        Cache Optimisation). Vertices used by the last triangle score a fixed amount so
+///        the next triangle doesn't just go back and forth, the rest fall off with their
+///        position in the cache. Vertices with few triangles left get a boost so they get
+///        finished off instead of leaving lone triangles behind.
+/// @param[in] _cachePos Position of the vertex in the cache, -1 if not in it
+/// @param[in] _remaining Amount of triangles still to be emitted using the vertex
+/// @return Score of the vertex
+// ---------------------------------------------------------------------------------------
+static float vertexScore(
+                         const int _cachePos,
+                         const int _remaining
+                        )
+{
+  if(!_remaining)
+    return -1.0f;
+
+  float score = 0.0f;
+  if(_cachePos >= 0)
+  {
+    if(_cachePos < 3)
+      score = 0.75f;
+    else
+      score = powf(1.0f - (_cachePos - 3) / (float)(MESHCACHESIZE - 3), 1.5f);
+  }
+  return score + 2.0f / sqrtf((float)_remaining);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Orders a range of triangles for the vertex cache (Tom Forsyth, Linear-Speed
+///        Vertex Cache Optimisation). The vertices of the range are numbered locally so
+///        the work only depends on the size of the range.
+/// @param[in] _indices Indices of the triangles in the range
+/// @param[in] _count Amount of indices in the range
+/// @param[io] io_local Local number of each vertex of the mesh, all -1 on entry and
+///            restored to -1 on return
+/// @param[io] io_order The reordered indices are appended here
+// ---------------------------------------------------------------------------------------
+static void cacheOrder(
+                       const GLuint *_indices,
+                       const int _count,
+                       std::vector<int> &io_local,
+                       std::vector<GLuint> &io_order
+                      )
+{
+  int triangles = _count / 3;
+  if(!triangles)
+    return;
+
+  // Number the vertices used by the range
+  std::vector<GLuint> global;
+  std::vector<int> indices(_count);
+  for(int i = 0; i < _count; ++i)
+  {
+    if(io_local[_indices[i]] < 0)
+    {
+      io_local[_indices[i]] = (int)global.size();
+      global.push_back(_indices[i]);
+    }
+    indices[i] = io_local[_indices[i]];
+  }
+  int vertexCount = (int)global.size();
+  for(int v = 0; v < vertexCount; ++v)
+    io_local[global[v]] = -1;
+
+  // Triangles using each vertex, the ones still to be emitted are kept at the start of
+  // each vertex's range
+  std::vector<int> remaining(vertexCount, 0);
+  for(int i = 0; i < _count; ++i)
+    ++remaining[indices[i]];
+  std::vector<int> first(vertexCount + 1, 0);
+  for(int v = 0; v < vertexCount; ++v)
+    first[v + 1] = first[v] + remaining[v];
+  std::vector<int> adjacent(_count);
+  std::vector<int> filled(first.begin(), first.end() - 1);
+  for(int i = 0; i < _count; ++i)
+    adjacent[filled[indices[i]]++] = i / 3;
+
+  std::vector<int> cachePos(vertexCount, -1);
+  std::vector<float> score(vertexCount);
+  for(int v = 0; v < vertexCount; ++v)
+    score[v] = vertexScore(-1, remaining[v]);
+
+  std::vector<float> triScore(triangles);
+  std::vector<char> emitted(triangles, 0);
+  int best = 0;
+  for(int t = 0; t < triangles; ++t)
+  {
+    triScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+    if(triScore[t] > triScore[best])
+      best = t;
+  }
+
+  // The cache has room for the vertices of the new triangle on top of a full cache
+  int cache[MESHCACHESIZE + 3];
+  int newCache[MESHCACHESIZE + 3];
+  int cached = 0;
+  int next = 0;
+
+  for(int e = 0; e < triangles; ++e)
+  {
+    // Nothing in the cache has triangles left, carry on from the first triangle that
+    // hasn't been emitted yet
+    if(best < 0)
+    {
+      while(emitted[next])
+        ++next;
+      best = next;
+    }
+
+    const int *tri = &indices[best * 3];
+    emitted[best] = 1;
+    for(int i = 0; i < 3; ++i)
+    {
+      io_order.push_back(global[tri[i]]);
+
+      // Move the triangle out of the remaining range of the vertex
+      int v = tri[i];
+      int *adj = &adjacent[first[v]];
+      int *last = adj + --remaining[v];
+      *std::find(adj, last + 1, best) = *last;
+      *last = best;
+    }
+
+    // The triangle's vertices go to the front of the cache and push the rest back
+    int newCached = 0;
+    for(int i = 0; i < 3; ++i)
+      newCache[newCached++] = tri[i];
+    for(int i = 0; i < cached; ++i)
+    {
+      if(cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2])
+        newCache[newCached++] = cache[i];
+    }
+
+    // Rescore the vertices in the cache and the ones that dropped out of it, then the
+    // triangles using them and pick the best one to go next
+    for(int i = 0; i < newCached; ++i)
+    {
+      int v = newCache[i];
+      cachePos[v] = i < MESHCACHESIZE ? i : -1;
+      score[v] = vertexScore(cachePos[v], remaining[v]);
+    }
+
+    best = -1;
+    float bestScore = -1.0f;
+    for(int i = 0; i < newCached; ++i)
+    {
+      int v = newCache[i];
+      for(int a = first[v]; a < first[v] + remaining[v]; ++a)
+      {
+        int t = adjacent[a];
+        triScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+        if(triScore[t] > bestScore)
+        {
+          bestScore = triScore[t];
+          best = t;
+        }
+      }
+    }
+
+    cached = std::min(newCached, MESHCACHESIZE);
+    std::copy(newCache, newCache + cached, cache);
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Mesh::optimize()
+{
+  if(m_optimized)
+    return;
+  m_optimized = true;
+
+  m_acmrBefore = m_acmrAfter = fifoACMR(m_indices, m_vertexCount);
+  if(!m_indexCount)
+    return;
+
+  // Each patch is ordered on its own so the patches stay contiguous ranges
+  std::vector<int> local(m_vertexCount, -1);
+  std::vector<GLuint> order;
+  order.reserve(m_indexCount);
+  if(m_patches.empty())
+    cacheOrder(&m_indices[0], m_indexCount, local, order);
+  for(size_t p = 0; p < m_patches.size(); ++p)
+    cacheOrder(&m_indices[m_patches[p].m_first], m_patches[p].m_count, local, order);
+
+  // Renumber the vertices in the order the triangles first use them so they're also
+  // fetched from memory mostly in order
+  std::vector<GLuint> remap(m_vertexCount, (GLuint)-1);
+  std::vector<meshVertex> vertices;
+  vertices.reserve(m_vertexCount);
+  for(int i = 0; i < m_indexCount; ++i)
+  {
+    if(remap[order[i]] == (GLuint)-1)
+    {
+      remap[order[i]] = (GLuint)vertices.size();
+      vertices.push_back(m_vertices[order[i]]);
+    }
+    order[i] = remap[order[i]];
+  }
+
+  m_vertices.swap(vertices);
+  m_indices.swap(order);
+  m_acmrAfter = fifoACMR(m_indices, m_vertexCount);
+
+  // The lookup isn't valid for the new numbering and nothing can be added anymore
+  std::unordered_map<meshVertex, GLuint, meshVertexHash, meshVertexEqual>().swap(m_lookup);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Mesh::splitPatches(
+                        const int _divisions
+                       )
+{
+  int triangles = m_indexCount / 3;
+  int cells = 6 * _divisions * _divisions;
+  if(!triangles || m_optimized)
+    return;
+
+  // Find the cell of each triangle from the direction of its centre, the major axis
+  // picks the face of the cube and the other two coordinates the cell on it
+  std::vector<int> cell(triangles);
+  std::vector<int> start(cells + 1, 0);
+  for(int t = 0; t < triangles; ++t)
+  {
+    float c[3] = {0.0f, 0.0f, 0.0f};
+    for(int i = 0; i < 3; ++i)
+    {
+      const meshVertex &v = m_vertices[m_indices[t * 3 + i]];
+      c[0] += v.m_x;
+      c[1] += v.m_y;
+      c[2] += v.m_z;
+    }
+
+    int axis = 0;
+    for(int i = 1; i < 3; ++i)
+    {
+      if(fabsf(c[i]) > fabsf(c[axis]))
+        axis = i;
+    }
+    float major = fabsf(c[axis]) > 0.0f ? fabsf(c[axis]) : 1.0f;
+    int face = axis * 2 + (c[axis] < 0.0f ? 1 : 0);
+    int u = (int)((c[(axis + 1) % 3] / major * 0.5f + 0.5f) * _divisions);
+    int v = (int)((c[(axis + 2) % 3] / major * 0.5f + 0.5f) * _divisions);
+    u = std::max(0, std::min(u, _divisions - 1));
+    v = std::max(0, std::min(v, _divisions - 1));
+
+    cell[t] = (face * _divisions + u) * _divisions + v;
+    ++start[cell[t] + 1];
+  }
+
+  // Sort the triangles by their cell
+  for(int c = 0; c < cells; ++c)
+    start[c + 1] += start[c];
+  std::vector<GLuint> indices(m_indexCount);
+  std::vector<int> filled(start.begin(), start.end() - 1);
+  for(int t = 0; t < triangles; ++t)
+  {
+    int to = filled[cell[t]]++;
+    std::copy(&m_indices[t * 3], &m_indices[t * 3] + 3, &indices[to * 3]);
+  }
+  m_indices.swap(indices);
+
+  // Bound the vertex directions and the face normals of each non-empty cell with cones
+  // around their averages and the vertices with a sphere around their average
+  m_patches.clear();
+  m_sphereX.clear();
+  m_sphereY.clear();
+  m_sphereZ.clear();
+  m_sphereR.clear();
+  for(int c = 0; c < cells; ++c)
+  {
+    if(start[c] == start[c + 1])
+      continue;
+
+    meshPatch patch;
+    patch.m_first = start[c] * 3;
+    patch.m_count = (start[c + 1] - start[c]) * 3;
+    int last = patch.m_first + patch.m_count;
+
+    Vec4 axis(0.0f, 0.0f, 0.0f, 0.0f);
+    Vec4 centre(0.0f, 0.0f, 0.0f, 0.0f);
+    patch.m_radius = 0.0f;
+    for(int i = patch.m_first; i < last; ++i)
+    {
+      const meshVertex &v = m_vertices[m_indices[i]];
+      Vec4 p(v.m_x, v.m_y, v.m_z, 0.0f);
+      float length = p.length();
+      patch.m_radius = std::max(patch.m_radius, length);
+      if(length > 0.0f)
+        axis += p / length;
+      centre += p;
+    }
+    if(axis.length() > 0.0f)
+      axis.normalize();
+    centre = centre / (float)patch.m_count;
+
+    // The face normals point to the same side as the vertex normals, i.e. outwards
+    std::vector<Vec4> normals;
+    Vec4 normalAxis(0.0f, 0.0f, 0.0f, 0.0f);
+    for(int i = patch.m_first; i < last; i += 3)
+    {
+      const meshVertex &a = m_vertices[m_indices[i]];
+      const meshVertex &b = m_vertices[m_indices[i + 1]];
+      const meshVertex &d = m_vertices[m_indices[i + 2]];
+      Vec4 n = Vec4(b.m_x - a.m_x, b.m_y - a.m_y, b.m_z - a.m_z, 0.0f).cross(
+               Vec4(d.m_x - a.m_x, d.m_y - a.m_y, d.m_z - a.m_z, 0.0f));
+      n.m_w = 0.0f;
+      if(n.length() <= 0.0f)
+        continue;
+      n.normalize();
+      if(n.m_x * a.m_nx + n.m_y * a.m_ny + n.m_z * a.m_nz < 0.0f)
+        n = n * -1.0f;
+      normals.push_back(n);
+      normalAxis += n;
+    }
+    if(normalAxis.length() > 0.0f)
+      normalAxis.normalize();
+
+    float minCos = 1.0f;
+    float sphereRadius = 0.0f;
+    for(int i = patch.m_first; i < last; ++i)
+    {
+      const meshVertex &v = m_vertices[m_indices[i]];
+      Vec4 p(v.m_x, v.m_y, v.m_z, 0.0f);
+      float length = p.length();
+      minCos = length > 0.0f ? std::min(minCos, axis.dot(p) / length) : -1.0f;
+      sphereRadius = std::max(sphereRadius, (p - centre).length());
+    }
+    float minNormalCos = normals.empty() ? -1.0f : 1.0f;
+    for(size_t i = 0; i < normals.size(); ++i)
+      minNormalCos = std::min(minNormalCos, normalAxis.dot(normals[i]));
+
+    patch.m_x = axis.m_x;
+    patch.m_y = axis.m_y;
+    patch.m_z = axis.m_z;
+    patch.m_angle = acosf(std::max(-1.0f, std::min(minCos, 1.0f)));
+    patch.m_nx = normalAxis.m_x;
+    patch.m_ny = normalAxis.m_y;
+    patch.m_nz = normalAxis.m_z;
+    patch.m_normalAngle = acosf(std::max(-1.0f, std::min(minNormalCos, 1.0f)));
+    patch.m_cx = centre.m_x;
+    patch.m_cy = centre.m_y;
+    patch.m_cz = centre.m_z;
+    patch.m_sphereRadius = sphereRadius;
+    m_patches.push_back(patch);
+
+    m_sphereX.push_back(patch.m_cx);
+    m_sphereY.push_back(patch.m_cy);
+    m_sphereZ.push_back(patch.m_cz);
+    m_sphereR.push_back(patch.m_sphereRadius);
+  }
+  m_visible.resize(m_patches.size());
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+int Mesh::visiblePatches(
+                         const Vec4 &_eye,
+                         const float _occluder,
+                         const bool _closed,
+                         const frustum::planes &_frustum,
+                         std::vector<char> &o_visible
+                        ) const
+{
+  o_visible.assign(m_patches.size(), 0);
+  if(m_patches.empty())
+    return 0;
+
+  // Only the patches with their bounding spheres in the frustum are tested further
+  frustum::spheres spheres = {&m_sphereX[0], &m_sphereY[0], &m_sphereZ[0], &m_sphereR[0], (int)m_patches.size()};
+  m_inside.resize(m_patches.size());
+  int inside = m_cull(_frustum, spheres, &m_inside[0]);
+
+  // Nothing can be hidden behind the sphere from inside it
+  float distance = _eye.length();
+  bool horizonTest = distance > _occluder;
+  Vec4 dir = horizonTest ? _eye / distance : Vec4(0.0f, 0.0f, 0.0f, 0.0f);
+  float horizon = horizonTest ? acosf(_occluder / distance) : 0.0f;
+
+  int visible = 0;
+  for(int i = 0; i < inside; ++i)
+  {
+    int p = m_inside[i];
+    const meshPatch &patch = m_patches[p];
+    if(horizonTest)
+    {
+      float limit = patch.m_angle + horizon + acosf(std::min(_occluder / patch.m_radius, 1.0f));
+      if(limit < (float)M_PI &&
+         dir.m_x * patch.m_x + dir.m_y * patch.m_y + dir.m_z * patch.m_z < cosf(limit))
+        continue;
+    }
+
+    // A triangle faces away when n.(eye - p) < 0. With the normal at most the cone's
+    // angle off its axis and p within the sphere that's at most d cos(a - angle) + r,
+    // a being the angle between the axis and the direction to the eye from the centre
+    // of the sphere and d the distance.
+    if(_closed)
+    {
+      Vec4 toEye(_eye.m_x - patch.m_cx, _eye.m_y - patch.m_cy, _eye.m_z - patch.m_cz, 0.0f);
+      float eyeDistance = toEye.length();
+      float angle = eyeDistance > 0.0f ?
+                    acosf(std::max(-1.0f, std::min((toEye.m_x * patch.m_nx + toEye.m_y * patch.m_ny + toEye.m_z * patch.m_nz) / eyeDistance, 1.0f))) - patch.m_normalAngle :
+                    0.0f;
+      if(angle > 0.0f && eyeDistance * cosf(angle) + patch.m_sphereRadius < 0.0f)
+        continue;
+    }
+
+    o_visible[p] = 1;
+    visible += patch.m_count;
+  }
+  return visible;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Symmetric 4x4 matrix of the summed squared distances from a set of planes
+///        (Garland and Heckbert, Surface Simplification Using Quadric Error Metrics),
+///        stored as the upper triangle a², ab, ac, ad, b², bc, bd, c², cd, d²
+// ---------------------------------------------------------------------------------------
+typedef struct
+{
+  double m_q[10];
+} meshQuadric;
+
+// ---------------------------------------------------------------------------------------
+/// @brief Adds the squared distance from a plane to a quadric
+/// @param[io] io_q Quadric to add to
+/// @param[in] _a Unit normal of the plane in x
+/// @param[in] _b Unit normal of the plane in y
+/// @param[in] _c Unit normal of the plane in z
+/// @param[in] _d Distance of the plane from the origin
+/// @param[in] _w Weight of the plane
+// ---------------------------------------------------------------------------------------
+static void addPlane(
+                     meshQuadric &io_q,
+                     const double _a,
+                     const double _b,
+                     const double _c,
+                     const double _d,
+                     const double _w
+                    )
+{
+  io_q.m_q[0] += _w * _a * _a; io_q.m_q[1] += _w * _a * _b; io_q.m_q[2] += _w * _a * _c;
+  io_q.m_q[3] += _w * _a * _d; io_q.m_q[4] += _w * _b * _b; io_q.m_q[5] += _w * _b * _c;
+  io_q.m_q[6] += _w * _b * _d; io_q.m_q[7] += _w * _c * _c; io_q.m_q[8] += _w * _c * _d;
+  io_q.m_q[9] += _w * _d * _d;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Evaluates a quadric at a point
+/// @param[in] _q Quadric to evaluate
+/// @param[in] _x Position in x
+/// @param[in] _y Position in y
+/// @param[in] _z Position in z
+/// @return Weighted sum of the squared distances of the point from the planes
+// ---------------------------------------------------------------------------------------
+static double quadricError(
+                           const meshQuadric &_q,
+                           const double _x,
+                           const double _y,
+                           const double _z
+                          )
+{
+  const double *q = _q.m_q;
+  return q[0] * _x * _x + 2.0 * q[1] * _x * _y + 2.0 * q[2] * _x * _z + 2.0 * q[3] * _x +
+         q[4] * _y * _y + 2.0 * q[5] * _y * _z + 2.0 * q[6] * _y +
+         q[7] * _z * _z + 2.0 * q[8] * _z +
+         q[9];
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Edge collapse waiting in the queue, the versions of the vertices tell whether
+///        it's still up to date when it comes out
+// ---------------------------------------------------------------------------------------
+typedef struct
+{
+  double m_cost;
+  int m_from, m_to;
+  int m_fromVersion, m_toVersion;
+} meshCollapse;
+
+// ---------------------------------------------------------------------------------------
+/// @brief Orders the collapses so the cheapest comes out of the queue first
+// ---------------------------------------------------------------------------------------
+struct meshCollapseGreater
+{
+  bool operator()(const meshCollapse &_a, const meshCollapse &_b) const { return _a.m_cost > _b.m_cost; }
+};
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Queues the collapse of an edge towards whichever end makes the smaller error
+/// @param[in] _a First end of the edge
+/// @param[in] _b Second end of the edge
+/// @param[in] _points Positions of the vertices
+/// @param[in] _quadrics Quadrics of the vertices
+/// @param[in] _versions Versions of the vertices
+/// @param[io] io_queue Queue the collapse is added to
+// ---------------------------------------------------------------------------------------
+static void queueCollapse(
+                          const int _a,
+                          const int _b,
+                          const std::vector<Vec4> &_points,
+                          const std::vector<meshQuadric> &_quadrics,
+                          const std::vector<int> &_versions,
+                          std::priority_queue<meshCollapse, std::vector<meshCollapse>, meshCollapseGreater> &io_queue
+                         )
+{
+  meshQuadric q;
+  for(int i = 0; i < 10; ++i)
+    q.m_q[i] = _quadrics[_a].m_q[i] + _quadrics[_b].m_q[i];
+
+  const Vec4 &a = _points[_a];
+  const Vec4 &b = _points[_b];
+  double toA = quadricError(q, a.m_x, a.m_y, a.m_z);
+  double toB = quadricError(q, b.m_x, b.m_y, b.m_z);
+
+  meshCollapse c;
+  c.m_cost = std::min(toA, toB);
+  c.m_from = toB < toA ? _a : _b;
+  c.m_to = toB < toA ? _b : _a;
+  c.m_fromVersion = _versions[c.m_from];
+  c.m_toVersion = _versions[c.m_to];
+  io_queue.push(c);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Finds the vertices sharing a living triangle with a vertex
+/// @param[in] _v Vertex to find the neighbours of
+/// @param[in] _corners Vertices of the triangles
+/// @param[in] _around Triangles around each vertex, may contain dead ones
+/// @param[in] _alive Whether each triangle is still in the mesh
+/// @param[out] o_neighbours Sorted neighbours of the vertex
+// ---------------------------------------------------------------------------------------
+static void neighbours(
+                       const int _v,
+                       const std::vector<int> &_corners,
+                       const std::vector<std::vector<int> > &_around,
+                       const std::vector<char> &_alive,
+                       std::vector<int> &o_neighbours
+                      )
+{
+  o_neighbours.clear();
+  for(size_t i = 0; i < _around[_v].size(); ++i)
+  {
+    int t = _around[_v][i];
+    if(!_alive[t])
+      continue;
+    for(int k = 0; k < 3; ++k)
+      if(_corners[3 * t + k] != _v)
+        o_neighbours.push_back(_corners[3 * t + k]);
+  }
+  std::sort(o_neighbours.begin(), o_neighbours.end());
+  o_neighbours.erase(std::unique(o_neighbours.begin(), o_neighbours.end()), o_neighbours.end());
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Mesh::simplify(
+                    const int _triangles,
+                    Mesh &o_lod
+                   ) const
+{
+  int triangles = m_indexCount / 3;
+  if(m_vertices.empty())
+    return;
+
+  // Weld the vertices by their positions only so the collapses can cross the seams of the
+  // other attributes, each corner keeps its own normal, colour and texture coordinate
+  std::unordered_map<meshVertex, GLuint, meshVertexHash, meshVertexEqual> welded;
+  std::vector<Vec4> points;
+  std::vector<int> position(m_vertexCount);
+  meshVertex key;
+  memset(&key, 0, sizeof(meshVertex));
+  for(int i = 0; i < m_vertexCount; ++i)
+  {
+    key.m_x = m_vertices[i].m_x;
+    key.m_y = m_vertices[i].m_y;
+    key.m_z = m_vertices[i].m_z;
+    std::pair<std::unordered_map<meshVertex, GLuint, meshVertexHash, meshVertexEqual>::iterator, bool> found =
+      welded.insert(std::make_pair(key, (GLuint)points.size()));
+    if(found.second)
+      points.push_back(Vec4(key.m_x, key.m_y, key.m_z, 0.0f));
+    position[i] = found.first->second;
+  }
+  int count = (int)points.size();
+
+  // Welded corners of the triangles and the triangles around each vertex, triangles that
+  // lost an edge in the welding are dropped straight away
+  std::vector<int> corners(m_indexCount);
+  std::vector<std::vector<int> > around(count);
+  std::vector<char> alive(triangles, 1);
+  int living = triangles;
+  for(int t = 0; t < triangles; ++t)
+  {
+    int *c = &corners[3 * t];
+    for(int k = 0; k < 3; ++k)
+      c[k] = position[m_indices[3 * t + k]];
+
+    if(c[0] == c[1] || c[1] == c[2] || c[2] == c[0])
+    {
+      alive[t] = 0;
+      --living;
+      continue;
+    }
+    for(int k = 0; k < 3; ++k)
+      around[c[k]].push_back(t);
+  }
+
+  // Each vertex starts with the planes of its triangles weighted by their areas. The
+  // edges with only one triangle get a heavily weighted plane perpendicular to the
+  // triangle so the open borders keep their shape.
+  meshQuadric zero;
+  memset(&zero, 0, sizeof(meshQuadric));
+  std::vector<meshQuadric> quadrics(count, zero);
+  std::unordered_map<long long, std::pair<int, int> > edges;
+  for(int t = 0; t < triangles; ++t)
+  {
+    if(!alive[t])
+      continue;
+
+    const int *c = &corners[3 * t];
+    Vec4 n = (points[c[1]] - points[c[0]]).cross(points[c[2]] - points[c[0]]);
+    float area = n.length();
+    if(area > 0.0f)
+    {
+      n = n / area;
+      for(int k = 0; k < 3; ++k)
+        addPlane(quadrics[c[k]], n.m_x, n.m_y, n.m_z, -n.dot(points[c[0]]), area * 0.5f);
+    }
+
+    for(int k = 0; k < 3; ++k)
+    {
+      int a = std::min(c[k], c[(k + 1) % 3]);
+      int b = std::max(c[k], c[(k + 1) % 3]);
+      std::pair<int, int> &edge = edges[(long long)a * count + b];
+      edge.first++;
+      edge.second = t;
+    }
+  }
+
+  std::priority_queue<meshCollapse, std::vector<meshCollapse>, meshCollapseGreater> queue;
+  std::vector<int> versions(count, 0);
+  for(std::unordered_map<long long, std::pair<int, int> >::const_iterator e = edges.begin(); e != edges.end(); ++e)
+  {
+    int a = (int)(e->first / count);
+    int b = (int)(e->first % count);
+    if(e->second.first == 1)
+    {
+      const int *c = &corners[3 * e->second.second];
+      Vec4 edge = points[b] - points[a];
+      Vec4 n = (points[c[1]] - points[c[0]]).cross(points[c[2]] - points[c[0]]).cross(edge);
+      float length = n.length();
+      if(length > 0.0f)
+      {
+        n = n / length;
+        double weight = MESHBORDERWEIGHT * edge.dot(edge);
+        addPlane(quadrics[a], n.m_x, n.m_y, n.m_z, -n.dot(points[a]), weight);
+        addPlane(quadrics[b], n.m_x, n.m_y, n.m_z, -n.dot(points[a]), weight);
+      }
+    }
+  }
+  for(std::unordered_map<long long, std::pair<int, int> >::const_iterator e = edges.begin(); e != edges.end(); ++e)
+    queueCollapse((int)(e->first / count), (int)(e->first % count), points, quadrics, versions, queue);
+
+  // Collapse the cheapest edge until there are few enough triangles left
+  std::vector<int> fromNeighbours, toNeighbours, shared;
+  while(living > _triangles && !queue.empty())
+  {
+    meshCollapse c = queue.top();
+    queue.pop();
+    if(versions[c.m_from] != c.m_fromVersion || versions[c.m_to] != c.m_toVersion)
+      continue;
+
+    // An edge can only go if its ends share the two vertices opposite to it, otherwise
+    // the collapse would pinch the surface
+    neighbours(c.m_from, corners, around, alive, fromNeighbours);
+    neighbours(c.m_to, corners, around, alive, toNeighbours);
+    shared.clear();
+    std::set_intersection(fromNeighbours.begin(), fromNeighbours.end(),
+                          toNeighbours.begin(), toNeighbours.end(), std::back_inserter(shared));
+    if(shared.size() > 2)
+      continue;
+
+    // Nor can any of the remaining triangles around it flip over
+    bool flips = false;
+    for(size_t i = 0; i < around[c.m_from].size() && !flips; ++i)
+    {
+      int t = around[c.m_from][i];
+      const int *tc = &corners[3 * t];
+      if(!alive[t] || tc[0] == c.m_to || tc[1] == c.m_to || tc[2] == c.m_to)
+        continue;
+
+      Vec4 p[3], moved[3];
+      for(int k = 0; k < 3; ++k)
+      {
+        p[k] = points[tc[k]];
+        moved[k] = tc[k] == c.m_from ? points[c.m_to] : p[k];
+      }
+      Vec4 before = (p[1] - p[0]).cross(p[2] - p[0]);
+      Vec4 after = (moved[1] - moved[0]).cross(moved[2] - moved[0]);
+      flips = before.dot(after) <= 0.0f;
+    }
+    if(flips)
+      continue;
+
+    // Move the triangles over to the remaining vertex, the ones on the edge disappear
+    for(size_t i = 0; i < around[c.m_from].size(); ++i)
+    {
+      int t = around[c.m_from][i];
+      int *tc = &corners[3 * t];
+      if(!alive[t])
+        continue;
+      if(tc[0] == c.m_to || tc[1] == c.m_to || tc[2] == c.m_to)
+      {
+        alive[t] = 0;
+        --living;
+        continue;
+      }
+      for(int k = 0; k < 3; ++k)
+        if(tc[k] == c.m_from)
+          tc[k] = c.m_to;
+      around[c.m_to].push_back(t);
+    }
+    std::vector<int>().swap(around[c.m_from]);
+
+    for(int i = 0; i < 10; ++i)
+      quadrics[c.m_to].m_q[i] += quadrics[c.m_from].m_q[i];
+    versions[c.m_from] = -1;
+    ++versions[c.m_to];
+
+    // The costs of the edges around the remaining vertex changed with its quadric
+    neighbours(c.m_to, corners, around, alive, toNeighbours);
+    for(size_t i = 0; i < toNeighbours.size(); ++i)
+      queueCollapse(c.m_to, toNeighbours[i], points, quadrics, versions, queue);
+  }
+
+  // Emit the remaining triangles with the attributes of their original corners
+  o_lod.m_hasColours = m_hasColours;
+  o_lod.m_hasTexCoords = m_hasTexCoords;
+  for(int t = 0; t < triangles; ++t)
+  {
+    if(!alive[t])
+      continue;
+    for(int k = 0; k < 3; ++k)
+    {
+      o_lod.m_current = m_vertices[m_indices[3 * t + k]];
+      o_lod.vertex(points[corners[3 * t + k]]);
+    }
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+#ifndef HEADLESS
+// ---------------------------------------------------------------------------------------
+void Mesh::upload()
+{
+  optimize();
+
+  if(m_indexCount)
+  {
+    glGenBuffers(1, &m_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, m_vertexCount * sizeof(meshVertex), &m_vertices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Halve the index buffer when the vertices can be indexed with 16 bits
+    glGenBuffers(1, &m_ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+    if(indexType() == GL_UNSIGNED_SHORT)
+    {
+      std::vector<GLushort> indices(m_indices.begin(), m_indices.end());
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indexCount * sizeof(GLushort), &indices[0], GL_STATIC_DRAW);
+    }
+    else
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indexCount * sizeof(GLuint), &m_indices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  }
+
+  // The data lives on the GPU now, free the memory used for building
+  std::vector<meshVertex>().swap(m_vertices);
+  std::vector<GLuint>().swap(m_indices);
+  std::unordered_map<meshVertex, GLuint, meshVertexHash, meshVertexEqual>().swap(m_lookup);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Mesh::bind() const
+{
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_NORMAL_ARRAY);
+  glVertexPointer(3, GL_FLOAT, sizeof(meshVertex), (const GLvoid *)0);
+  glNormalPointer(GL_FLOAT, sizeof(meshVertex), (const GLvoid *)(3 * sizeof(GLfloat)));
+
+  if(m_hasTexCoords)
+  {
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(meshVertex), (const GLvoid *)(6 * sizeof(GLfloat)));
+  }
+  if(m_hasColours)
+  {
+    glEnableClientState(GL_COLOR_ARRAY);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(meshVertex), (const GLvoid *)(8 * sizeof(GLfloat)));
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Mesh::unbind() const
+{
+  if(m_hasColours)
+    glDisableClientState(GL_COLOR_ARRAY);
+  if(m_hasTexCoords)
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_NORMAL_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Mesh::draw() const
+{
+  if(!m_indexCount)
+    return;
+
+  bind();
+  glDrawElements(GL_TRIANGLES, m_indexCount, indexType(), (const GLvoid *)0);
+  unbind();
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Mesh::drawInstanced(
+                         const int _instances
+                        ) const
+{
+  if(!m_indexCount || !_instances)
+    return;
+
+  bind();
+  glDrawElementsInstancedARB(GL_TRIANGLES, m_indexCount, indexType(), (const GLvoid *)0, _instances);
+  unbind();
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+int Mesh::drawVisible(
+                      const Vec4 &_eye,
+                      const float _occluder,
+                      const bool _closed,
+                      const frustum::planes &_frustum
+                     ) const
+{
+  if(m_patches.empty())
+  {
+    draw();
+    return 0;
+  }
+
+  if(!visiblePatches(_eye, _occluder, _closed, _frustum, m_visible))
+    return 0;
+
+  // Visible patches next to each other in the index buffer go in the same call
+  size_t indexSize = indexType() == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+  int drawn = 0;
+  bind();
+  for(size_t p = 0; p < m_patches.size();)
+  {
+    if(!m_visible[p])
+    {
+      ++p;
+      continue;
+    }
+
+    int first = m_patches[p].m_first;
+    int count = 0;
+    for(; p < m_patches.size() && m_visible[p]; ++p, ++drawn)
+      count += m_patches[p].m_count;
+    glDrawElements(GL_TRIANGLES, count, indexType(), (const GLvoid *)(first * indexSize));
+  }
+  unbind();
+  return drawn;
+}
+// ---------------------------------------------------------------------------------------
+#endif
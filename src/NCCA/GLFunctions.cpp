@@ -48,7 +48,7 @@ Mat4 GLFunctions::orientation(
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void GLFunctions::perspective(
+Mat4 GLFunctions::perspective(
                               const float _fovy,
                               const float _aspect,
                               const float _zNear,
@@ -67,6 +67,8 @@ void GLFunctions::perspective(
   result.m_23 = - 1.0f;
   result.m_32 = - (2.0f* _zFar * _zNear) / (_zFar - _zNear);
   result.loadProjection();
+
+  return result;
 }
 // ---------------------------------------------------------------------------------------
 
@@ -152,6 +152,7 @@ void Mat4::identity()
 }
 // ---------------------------------------------------------------------------------------
 
+#ifndef HEADLESS
 // ---------------------------------------------------------------------------------------
 void Mat4::loadProjection() const
 {
@@ -170,6 +171,7 @@ void Mat4::loadModelView() const
   glMultMatrixf(m_openGL);
 }
 // ---------------------------------------------------------------------------------------
+#endif
 
 // ---------------------------------------------------------------------------------------
 const Mat4& Mat4::transpose()
@@ -23,12 +23,14 @@
 /// @brief Implementation for simple Vec4 vector class
 // ---------------------------------------------------------------------------------------
 
+#ifndef HEADLESS
 // ---------------------------------------------------------------------------------------
 void Vec4::colourGL() const
 {
   glColor4fv(m_openGL);
 }
 // ---------------------------------------------------------------------------------------
+#endif
 
 // ---------------------------------------------------------------------------------------
 Vec4::Vec4(
@@ -74,6 +76,7 @@ void Vec4::normalize()
 }
 // ---------------------------------------------------------------------------------------
 
+#ifndef HEADLESS
 // ---------------------------------------------------------------------------------------
 void Vec4::normalGL() const
 {
@@ -101,6 +104,7 @@ void Vec4::textureGL() const
   glTexCoord2f(m_x, m_y);
 }
 // ---------------------------------------------------------------------------------------
+#endif
 
 // ---------------------------------------------------------------------------------------
 void Vec4::set(
@@ -0,0 +1,182 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#include "Narrowphase.h"
+#include "Simd.h"
+
+// ---------------------------------------------------------------------------------------
+/// @file Narrowphase.cpp
+/// @brief Implementation of the narrowphase kernels and the runtime kernel selection. The
+///        hits are compacted from the comparison masks one set bit at a time, so the only
+///        branches are on the spheres that are actually hit.
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+int narrowphase::testScalar(
+                            const spheres &_s,
+                            const float _x,
+                            const float _y,
+                            const float _z,
+                            const float _scale2,
+                            int *o_hits
+                           )
+{
+  int hits = 0;
+  for(int i = 0; i < _s.m_count; ++i)
+  {
+    float dx = _s.m_x[i] - _x;
+    float dy = _s.m_y[i] - _y;
+    float dz = _s.m_z[i] - _z;
+
+    // Always write the id and only advance the hit count on a hit
+    o_hits[hits] = _s.m_ids[i];
+    hits += (dx*dx + dy*dy + dz*dz < _s.m_r2[i] * _scale2);
+  }
+
+  return hits;
+}
+// ---------------------------------------------------------------------------------------
+
+#ifdef SIMD_X86
+// ---------------------------------------------------------------------------------------
+__attribute__((target("sse2")))
+int narrowphase::testSSE(
+                         const spheres &_s,
+                         const float _x,
+                         const float _y,
+                         const float _z,
+                         const float _scale2,
+                         int *o_hits
+                        )
+{
+  const __m128 x = _mm_set1_ps(_x);
+  const __m128 y = _mm_set1_ps(_y);
+  const __m128 z = _mm_set1_ps(_z);
+  const __m128 scale2 = _mm_set1_ps(_scale2);
+
+  int hits = 0;
+  int i = 0;
+  for(; i + 4 <= _s.m_count; i += 4)
+  {
+    __m128 dx = _mm_sub_ps(_mm_loadu_ps(_s.m_x + i), x);
+    __m128 dy = _mm_sub_ps(_mm_loadu_ps(_s.m_y + i), y);
+    __m128 dz = _mm_sub_ps(_mm_loadu_ps(_s.m_z + i), z);
+    __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+    int mask = _mm_movemask_ps(_mm_cmplt_ps(d2, _mm_mul_ps(_mm_loadu_ps(_s.m_r2 + i), scale2)));
+    while(mask)
+    {
+      o_hits[hits++] = _s.m_ids[i + __builtin_ctz(mask)];
+      mask &= mask - 1;
+    }
+  }
+
+  // The scalar kernel tests the spheres left over after the last full register
+  spheres tail = _s;
+  tail.m_x += i; tail.m_y += i; tail.m_z += i;
+  tail.m_r2 += i; tail.m_ids += i;
+  tail.m_count -= i;
+
+  return hits + testScalar(tail, _x, _y, _z, _scale2, o_hits + hits);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+__attribute__((target("avx2")))
+int narrowphase::testAVX2(
+                          const spheres &_s,
+                          const float _x,
+                          const float _y,
+                          const float _z,
+                          const float _scale2,
+                          int *o_hits
+                         )
+{
+  const __m256 x = _mm256_set1_ps(_x);
+  const __m256 y = _mm256_set1_ps(_y);
+  const __m256 z = _mm256_set1_ps(_z);
+  const __m256 scale2 = _mm256_set1_ps(_scale2);
+
+  int hits = 0;
+  int i = 0;
+  for(; i + 8 <= _s.m_count; i += 8)
+  {
+    __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(_s.m_x + i), x);
+    __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(_s.m_y + i), y);
+    __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(_s.m_z + i), z);
+    __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+
+    int mask = _mm256_movemask_ps(_mm256_cmp_ps(d2, _mm256_mul_ps(_mm256_loadu_ps(_s.m_r2 + i), scale2), _CMP_LT_OQ));
+    while(mask)
+    {
+      o_hits[hits++] = _s.m_ids[i + __builtin_ctz(mask)];
+      mask &= mask - 1;
+    }
+  }
+
+  // The scalar kernel tests the spheres left over after the last full register
+  spheres tail = _s;
+  tail.m_x += i; tail.m_y += i; tail.m_z += i;
+  tail.m_r2 += i; tail.m_ids += i;
+  tail.m_count -= i;
+
+  simd::zeroUpper();
+  return hits + testScalar(tail, _x, _y, _z, _scale2, o_hits + hits);
+}
+// ---------------------------------------------------------------------------------------
+#else
+// ---------------------------------------------------------------------------------------
+int narrowphase::testSSE(
+                         const spheres &_s,
+                         const float _x,
+                         const float _y,
+                         const float _z,
+                         const float _scale2,
+                         int *o_hits
+                        )
+{
+  return testScalar(_s, _x, _y, _z, _scale2, o_hits);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+int narrowphase::testAVX2(
+                          const spheres &_s,
+                          const float _x,
+                          const float _y,
+                          const float _z,
+                          const float _scale2,
+                          int *o_hits
+                         )
+{
+  return testScalar(_s, _x, _y, _z, _scale2, o_hits);
+}
+// ---------------------------------------------------------------------------------------
+#endif
+
+// ---------------------------------------------------------------------------------------
+bool narrowphase::supported(
+                            const kernel _k
+                           )
+{
+  return simd::supported(simd::levelOf(_k, testSSE, testAVX2));
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+narrowphase::kernel narrowphase::select()
+{
+  return simd::select<kernel>(testScalar, testSSE, testAVX2);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+const char *narrowphase::name(
+                              const kernel _k
+                             )
+{
+  return simd::name(simd::levelOf(_k, testSSE, testAVX2));
+}
+// ---------------------------------------------------------------------------------------
@@ -0,0 +1,199 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#include "ParticleKernel.h"
+#include "Simd.h"
+
+// ---------------------------------------------------------------------------------------
+/// @file ParticleKernel.cpp
+/// @brief Implementation of the particle kernels and the runtime kernel selection. The
+///        SIMD versions are compiled with function level target attributes so the rest of
+///        the program doesn't need to be built for those instruction sets.
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void particleKernel::updateScalar(
+                                  const batch &io_b,
+                                  const float _scale
+                                 )
+{
+  for(int i = 0; i < io_b.m_count; ++i)
+  {
+    io_b.m_prevX[i] = io_b.m_x[i];
+    io_b.m_prevY[i] = io_b.m_y[i];
+    io_b.m_prevZ[i] = io_b.m_z[i];
+
+    // The particles move towards the origin on each axis
+    io_b.m_x[i] += (io_b.m_x[i] > 0 ? -io_b.m_velX[i] : io_b.m_velX[i]) * _scale;
+    io_b.m_y[i] += (io_b.m_y[i] > 0 ? -io_b.m_velY[i] : io_b.m_velY[i]) * _scale;
+    io_b.m_z[i] += (io_b.m_z[i] > 0 ? -io_b.m_velZ[i] : io_b.m_velZ[i]) * _scale;
+
+    io_b.m_life[i] += _scale;
+
+    // Colour based on the elapsed life relative to the maximum lifetime
+    float t = io_b.m_life[i] * io_b.m_invMaxLife[i];
+    io_b.m_g[i] = 1.0f - t;
+    io_b.m_b[i] = 0.5f - 2.0f * t;
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+#ifdef SIMD_X86
+// ---------------------------------------------------------------------------------------
+__attribute__((target("sse2")))
+void particleKernel::updateSSE(
+                               const batch &io_b,
+                               const float _scale
+                              )
+{
+  const __m128 scale = _mm_set1_ps(_scale);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 two = _mm_set1_ps(2.0f);
+  const __m128 sign = _mm_set1_ps(-0.0f);
+
+  int i = 0;
+  for(; i + 4 <= io_b.m_count; i += 4)
+  {
+    __m128 x = _mm_loadu_ps(io_b.m_x + i);
+    __m128 y = _mm_loadu_ps(io_b.m_y + i);
+    __m128 z = _mm_loadu_ps(io_b.m_z + i);
+
+    _mm_storeu_ps(io_b.m_prevX + i, x);
+    _mm_storeu_ps(io_b.m_prevY + i, y);
+    _mm_storeu_ps(io_b.m_prevZ + i, z);
+
+    // Flip the sign of the velocity where the position is positive, this is the
+    // branchless version of (x > 0 ? -vel : vel)
+    __m128 vx = _mm_xor_ps(_mm_loadu_ps(io_b.m_velX + i), _mm_and_ps(_mm_cmpgt_ps(x, zero), sign));
+    __m128 vy = _mm_xor_ps(_mm_loadu_ps(io_b.m_velY + i), _mm_and_ps(_mm_cmpgt_ps(y, zero), sign));
+    __m128 vz = _mm_xor_ps(_mm_loadu_ps(io_b.m_velZ + i), _mm_and_ps(_mm_cmpgt_ps(z, zero), sign));
+
+    _mm_storeu_ps(io_b.m_x + i, _mm_add_ps(x, _mm_mul_ps(vx, scale)));
+    _mm_storeu_ps(io_b.m_y + i, _mm_add_ps(y, _mm_mul_ps(vy, scale)));
+    _mm_storeu_ps(io_b.m_z + i, _mm_add_ps(z, _mm_mul_ps(vz, scale)));
+
+    __m128 life = _mm_add_ps(_mm_loadu_ps(io_b.m_life + i), scale);
+    _mm_storeu_ps(io_b.m_life + i, life);
+
+    __m128 t = _mm_mul_ps(life, _mm_loadu_ps(io_b.m_invMaxLife + i));
+    _mm_storeu_ps(io_b.m_g + i, _mm_sub_ps(one, t));
+    _mm_storeu_ps(io_b.m_b + i, _mm_sub_ps(half, _mm_mul_ps(two, t)));
+  }
+
+  // Handle the particles that didn't fit in to a full register
+  batch tail = io_b;
+  tail.m_x += i; tail.m_y += i; tail.m_z += i;
+  tail.m_prevX += i; tail.m_prevY += i; tail.m_prevZ += i;
+  tail.m_velX += i; tail.m_velY += i; tail.m_velZ += i;
+  tail.m_life += i; tail.m_invMaxLife += i;
+  tail.m_g += i; tail.m_b += i;
+  tail.m_count -= i;
+  updateScalar(tail, _scale);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+__attribute__((target("avx2")))
+void particleKernel::updateAVX2(
+                                const batch &io_b,
+                                const float _scale
+                               )
+{
+  const __m256 scale = _mm256_set1_ps(_scale);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256 two = _mm256_set1_ps(2.0f);
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+
+  int i = 0;
+  for(; i + 8 <= io_b.m_count; i += 8)
+  {
+    __m256 x = _mm256_loadu_ps(io_b.m_x + i);
+    __m256 y = _mm256_loadu_ps(io_b.m_y + i);
+    __m256 z = _mm256_loadu_ps(io_b.m_z + i);
+
+    _mm256_storeu_ps(io_b.m_prevX + i, x);
+    _mm256_storeu_ps(io_b.m_prevY + i, y);
+    _mm256_storeu_ps(io_b.m_prevZ + i, z);
+
+    // Flip the sign of the velocity where the position is positive
+    __m256 vx = _mm256_xor_ps(_mm256_loadu_ps(io_b.m_velX + i), _mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_GT_OQ), sign));
+    __m256 vy = _mm256_xor_ps(_mm256_loadu_ps(io_b.m_velY + i), _mm256_and_ps(_mm256_cmp_ps(y, zero, _CMP_GT_OQ), sign));
+    __m256 vz = _mm256_xor_ps(_mm256_loadu_ps(io_b.m_velZ + i), _mm256_and_ps(_mm256_cmp_ps(z, zero, _CMP_GT_OQ), sign));
+
+    _mm256_storeu_ps(io_b.m_x + i, _mm256_add_ps(x, _mm256_mul_ps(vx, scale)));
+    _mm256_storeu_ps(io_b.m_y + i, _mm256_add_ps(y, _mm256_mul_ps(vy, scale)));
+    _mm256_storeu_ps(io_b.m_z + i, _mm256_add_ps(z, _mm256_mul_ps(vz, scale)));
+
+    __m256 life = _mm256_add_ps(_mm256_loadu_ps(io_b.m_life + i), scale);
+    _mm256_storeu_ps(io_b.m_life + i, life);
+
+    __m256 t = _mm256_mul_ps(life, _mm256_loadu_ps(io_b.m_invMaxLife + i));
+    _mm256_storeu_ps(io_b.m_g + i, _mm256_sub_ps(one, t));
+    _mm256_storeu_ps(io_b.m_b + i, _mm256_sub_ps(half, _mm256_mul_ps(two, t)));
+  }
+
+  // Handle the particles that didn't fit in to a full register
+  batch tail = io_b;
+  tail.m_x += i; tail.m_y += i; tail.m_z += i;
+  tail.m_prevX += i; tail.m_prevY += i; tail.m_prevZ += i;
+  tail.m_velX += i; tail.m_velY += i; tail.m_velZ += i;
+  tail.m_life += i; tail.m_invMaxLife += i;
+  tail.m_g += i; tail.m_b += i;
+  tail.m_count -= i;
+
+  simd::zeroUpper();
+  updateScalar(tail, _scale);
+}
+// ---------------------------------------------------------------------------------------
+#else
+// ---------------------------------------------------------------------------------------
+void particleKernel::updateSSE(
+                               const batch &io_b,
+                               const float _scale
+                              )
+{
+  updateScalar(io_b, _scale);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void particleKernel::updateAVX2(
+                                const batch &io_b,
+                                const float _scale
+                               )
+{
+  updateScalar(io_b, _scale);
+}
+// ---------------------------------------------------------------------------------------
+#endif
+
+// ---------------------------------------------------------------------------------------
+bool particleKernel::supported(
+                               const kernel _k
+                              )
+{
+  return simd::supported(simd::levelOf(_k, updateSSE, updateAVX2));
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+particleKernel::kernel particleKernel::select()
+{
+  return simd::select<kernel>(updateScalar, updateSSE, updateAVX2);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+const char *particleKernel::name(
+                                 const kernel _k
+                                )
+{
+  return simd::name(simd::levelOf(_k, updateSSE, updateAVX2));
+}
+// ---------------------------------------------------------------------------------------
@@ -3,31 +3,186 @@
  SDAGE 1st year 2nd PPP Assignment
 */
 
+#include <algorithm>
+#include <cstdlib>
+
 #include "Particles.h"
 
 // ---------------------------------------------------------------------------------------
 /// @file Particles.cpp
-/// @brief Implementation of the particle draw and move functions
+/// @brief Implementation of the particle pool functions
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+ParticlePool::ParticlePool(
+                           const int _capacity
+                          ) :
+                           m_capacity(_capacity),
+                           m_count(0),
+                           m_x(_capacity), m_y(_capacity), m_z(_capacity),
+                           m_prevX(_capacity), m_prevY(_capacity), m_prevZ(_capacity),
+                           m_velX(_capacity), m_velY(_capacity), m_velZ(_capacity),
+                           m_life(_capacity), m_maxLife(_capacity), m_invMaxLife(_capacity),
+                           m_g(_capacity), m_b(_capacity),
+                           m_kernel(particleKernel::select())
+{
+#ifndef HEADLESS
+  // The storage for the buffer is allocated when drawing as it's orphaned every frame
+  glGenBuffers(1, &m_vbo);
+#endif
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+ParticlePool::~ParticlePool()
+{
+#ifndef HEADLESS
+  glDeleteBuffers(1, &m_vbo);
+#endif
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void ParticlePool::emit(
+                        const Vec4 &_p,
+                        const int _amount,
+                        const float _l
+                       )
+{
+  for(int i = 0; i < _amount && m_count < m_capacity; ++i, ++m_count)
+  {
+    m_x[m_count] = m_prevX[m_count] = _p.m_x;
+    m_y[m_count] = m_prevY[m_count] = _p.m_y;
+    m_z[m_count] = m_prevZ[m_count] = _p.m_z;
+
+    // Generate random values on how much the particle moves each step in which axis
+    m_velX[m_count] = 0.01 * (std::rand()/(float)RAND_MAX * 2 - 1);
+    m_velY[m_count] = 0.01 * (std::rand()/(float)RAND_MAX * 2 - 1);
+    m_velZ[m_count] = 0.01 * (std::rand()/(float)RAND_MAX * 2 - 1);
+
+    m_life[m_count] = 0.0f;
+    m_maxLife[m_count] = _l;
+    m_invMaxLife[m_count] = 1.0f / _l;
+    m_g[m_count] = 1.0f;
+    m_b[m_count] = 0.5f;
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void ParticlePool::update(
+                          const float _dt
+                         )
+{
+  if(!m_count)
+    return;
+
+  // Move, age and colour the whole batch at once. The movement is given per simulation
+  // step so it's scaled by the elapsed time
+  particleKernel::batch b;
+  b.m_x = &m_x[0]; b.m_y = &m_y[0]; b.m_z = &m_z[0];
+  b.m_prevX = &m_prevX[0]; b.m_prevY = &m_prevY[0]; b.m_prevZ = &m_prevZ[0];
+  b.m_velX = &m_velX[0]; b.m_velY = &m_velY[0]; b.m_velZ = &m_velZ[0];
+  b.m_life = &m_life[0];
+  b.m_invMaxLife = &m_invMaxLife[0];
+  b.m_g = &m_g[0]; b.m_b = &m_b[0];
+  b.m_count = m_count;
+  m_kernel(b, _dt / SIMSTEP);
+
+  // Kill the dead particles by moving the last living one in to their place, the moved
+  // particle might be dead as well so we don't advance the index
+  int i = 0;
+  while(i < m_count)
+  {
+    if(m_life[i] >= m_maxLife[i])
+      move(--m_count, i);
+    else
+      ++i;
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+#ifndef HEADLESS
+// ---------------------------------------------------------------------------------------
+void ParticlePool::draw(
+                        const float _alpha
+                       ) const
+{
+  if(!m_count)
+    return;
+
+  // Orphan the old storage so the driver can hand us a fresh block while the gpu might
+  // still be drawing from the previous one, then write the particles straight in to it
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+  glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(particleVertex), NULL, GL_STREAM_DRAW);
+
+  particleVertex *v = static_cast<particleVertex *>(glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY));
+  if(!v)
+  {
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return;
+  }
+
+  for(int i = 0; i < m_count; ++i)
+  {
+    v[i].m_x = m_prevX[i] + (m_x[i] - m_prevX[i]) * _alpha;
+    v[i].m_y = m_prevY[i] + (m_y[i] - m_prevY[i]) * _alpha;
+    v[i].m_z = m_prevZ[i] + (m_z[i] - m_prevZ[i]) * _alpha;
+
+    // The color of a particle is calculated in the updates based on how long it has
+    // lived relative to its maximum lifetime, blue goes negative after the first
+    // quarter of it and is clamped like glColor did
+    v[i].m_r = 255;
+    v[i].m_g = (GLubyte)(std::max(0.0f, std::min(m_g[i], 1.0f)) * 255.0f);
+    v[i].m_b = (GLubyte)(std::max(0.0f, std::min(m_b[i], 1.0f)) * 255.0f);
+    v[i].m_a = v[i].m_g;
+  }
+
+  // If the buffer got corrupted while mapped (e.g. a mode switch) we skip this frame
+  if(glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE)
+  {
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(particleVertex), (const GLvoid *)0);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(particleVertex), (const GLvoid *)(3 * sizeof(GLfloat)));
+
+    glDrawArrays(GL_POINTS, 0, m_count);
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
 // ---------------------------------------------------------------------------------------
+#endif
 
 // ---------------------------------------------------------------------------------------
-void Particle::draw()
+void ParticlePool::clear()
 {
-  // Calculate the color of a particle based on how long it has lived relative to its
-  // maximum lifetime
-  glColor4f(1,
-            1 - (m_life / (float)m_max_life),
-            0.5 - 2*(m_life / (float)m_max_life),
-            1 - m_life / (float)m_max_life);
-  m_pos.vertexGL();
+  m_count = 0;
 }
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void Particle::move()
+void ParticlePool::move(
+                        const int _from,
+                        const int _to
+                       )
 {
-  m_pos.m_x += (m_pos.m_x > 0 ? -m_moveX : m_moveX);
-  m_pos.m_y += (m_pos.m_y > 0 ? -m_moveY : m_moveY);
-  m_pos.m_z += (m_pos.m_z > 0 ? -m_moveZ : m_moveZ);
+  m_x[_to] = m_x[_from];
+  m_y[_to] = m_y[_from];
+  m_z[_to] = m_z[_from];
+  m_prevX[_to] = m_prevX[_from];
+  m_prevY[_to] = m_prevY[_from];
+  m_prevZ[_to] = m_prevZ[_from];
+  m_velX[_to] = m_velX[_from];
+  m_velY[_to] = m_velY[_from];
+  m_velZ[_to] = m_velZ[_from];
+  m_life[_to] = m_life[_from];
+  m_maxLife[_to] = m_maxLife[_from];
+  m_invMaxLife[_to] = m_invMaxLife[_from];
+  m_g[_to] = m_g[_from];
+  m_b[_to] = m_b[_from];
 }
 // ---------------------------------------------------------------------------------------
@@ -15,6 +15,7 @@
 #include <ctime>
 
 #include "Planet.h"
+#include "Shader.h"
 #include "TextureOBJ.h"
 #include "NCCA/GLFunctions.h"
 
@@ -24,7 +25,13 @@
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-Planet::Planet()
+Planet::Planet() :
+  m_cloudSteps(0.0f),
+  m_cloudVbo(0),
+  m_cloudShellRadius(0.0f),
+  m_cloudProgram(0),
+  m_occluderRadius(0.0f),
+  m_cull(frustum::select())
 {
   rng.seed(time(NULL));
 
@@ -32,23 +39,115 @@ Planet::Planet()
   // game is played
   boost::random::uniform_int_distribution<> u_random(25, 125);
   max_clouds = u_random(rng);
+}
+// ---------------------------------------------------------------------------------------
 
+// ---------------------------------------------------------------------------------------
+void Planet::loadAssets(
+                        AssetLoader &io_assets
+                       )
+{
   // Load the planet related models to their respective structures
-  loadModel("models/p_surface.obj", m_pSurface);
-  loadModel("models/p_mountains.obj", m_pMountains);
-  loadModel("models/p_waters.obj", m_pWaters);
-  loadModel("models/p_waterbottoms.obj", m_pSeabeds);
-  loadModel("models/tree_trunk.obj", m_tTrunk);
-  loadModel("models/tree_leaves.obj", m_tLeaves);
-  loadModel("models/cloud_1.obj", m_cloudGeometry);
-
-  // Call all the functions that generate the displaylists, calculate vertex colors etc.
+  io_assets.requestModel("models/p_surface.obj", m_pSurface);
+  io_assets.requestModel("models/p_mountains.obj", m_pMountains);
+  io_assets.requestModel("models/p_waters.obj", m_pWaters);
+  io_assets.requestModel("models/p_waterbottoms.obj", m_pSeabeds);
+  io_assets.requestModel("models/tree_trunk.obj", m_tTrunk);
+  io_assets.requestModel("models/tree_leaves.obj", m_tLeaves);
+  io_assets.requestModel("models/cloud_1.obj", m_cloudGeometry);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Rotates a vector around an axis (Rodrigues' rotation formula)
+/// @param[in] _v Vector to rotate
+/// @param[in] _axis Unit length rotation axis
+/// @param[in] _cos Cosine of the rotation angle
+/// @param[in] _sin Sine of the rotation angle
+/// @return The rotated vector
+// ---------------------------------------------------------------------------------------
+static Vec4 rotateAround(
+                         const Vec4 &_v,
+                         const Vec4 &_axis,
+                         const float _cos,
+                         const float _sin
+                        )
+{
+  Vec4 r = _v * _cos + _axis.cross(_v) * _sin + _axis * (_axis.dot(_v) * (1.0f - _cos));
+  return Vec4(r.m_x, r.m_y, r.m_z);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Finds a radius no triangle of a model around the origin comes closer to the
+///        origin than. A point on a triangle is a blend of its corners, so its distance
+///        along the direction of the triangle's centre is at least the smallest of the
+///        corners' and the point's distance from the origin at least that.
+/// @param[in] _m Model to check
+/// @return Radius of the sphere inside the model's triangles
+// ---------------------------------------------------------------------------------------
+static float innerRadius(
+                         const model &_m
+                        )
+{
+  float radius = HUGE_VALF;
+  for(int i = 0; i < (int)_m.m_Ind.size(); i += 9)
+  {
+    Vec4 c = _m.m_Verts[_m.m_Ind[i] - 1] + _m.m_Verts[_m.m_Ind[i + 3] - 1] + _m.m_Verts[_m.m_Ind[i + 6] - 1];
+    float length = c.length();
+    if(length <= 0.0f)
+      return 0.0f;
+
+    for(int k = i; k < i + 9; k += 3)
+      radius = std::min(radius, c.dot(_m.m_Verts[_m.m_Ind[k] - 1]) / length);
+  }
+  return std::max(radius, 0.0f);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Finds the position of the eye in the current modelview space. The eye is at the
+///        origin of the eye space, so it's -A^-1 t for the modelview's upper 3x3 A and
+///        translation t.
+/// @return The eye position
+// ---------------------------------------------------------------------------------------
+static Vec4 eyePosition()
+{
+  GLfloat m[16];
+  glGetFloatv(GL_MODELVIEW_MATRIX, m);
+
+  // The matrix is column major, the inverse of A is its adjugate over the determinant
+  float a = m[0], b = m[4], c = m[8];
+  float d = m[1], e = m[5], f = m[9];
+  float g = m[2], h = m[6], k = m[10];
+  float A = e * k - f * h, B = f * g - d * k, C = d * h - e * g;
+  float det = a * A + b * B + c * C;
+  if(fabsf(det) < 1e-12f)
+    return Vec4(0.0f, 0.0f, 0.0f);
+
+  float tx = m[12], ty = m[13], tz = m[14];
+  return Vec4(
+              -(A * tx + (c * h - b * k) * ty + (b * f - c * e) * tz) / det,
+              -(B * tx + (a * k - c * g) * ty + (c * d - a * f) * tz) / det,
+              -(C * tx + (b * g - a * h) * ty + (a * e - b * d) * tz) / det
+             );
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Planet::initAssets()
+{
+  // Call all the functions that generate the meshes, calculate vertex colors etc.
   genSurface();
   genMountains();
   genSeabeds();
   genWaters();
   genTree();
   genClouds();
+
+  // The surface and the seabeds together close the planet, the water on top of the
+  // seabeds is see-through
+  m_occluderRadius = std::min(innerRadius(m_pSurface), innerRadius(m_pSeabeds));
 }
 // ---------------------------------------------------------------------------------------
 
@@ -63,67 +162,85 @@ Planet::~Planet()
   freeModelMem(m_tTrunk);
   freeModelMem(m_tLeaves);
 
-  // Clear the tree and cloud vectors and free up the space
+  // Clear the tree vector and free up the space
   tree_positions.clear();
   std::vector<Vec4>().swap(tree_positions);
-  clouds.clear();
-  std::vector<m_cloud>().swap(clouds);
+
+  if(m_cloudVbo)
+    glDeleteBuffers(1, &m_cloudVbo);
+  if(m_cloudProgram)
+    glDeleteProgram(m_cloudProgram);
 }
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void Planet::draw()
+void Planet::update(
+                    const float _dt
+                   )
 {
-  // Call the displaylists of the planet surface, mountains, water surface and seabeds
-  glCallLists(p_displayList.size(), GL_UNSIGNED_INT, &p_displayList[0]);
-
-  // Loop through the trees, orient them and translate them to their respective positions
-  for(int i = 0; i < (int)tree_positions.size(); ++i)
-  {
-    // Calculating the rotation axis of a tree by calculating the cross product of
-    // the desired position and vector(0, 1, 0)
-    Vec4 vecTo = tree_positions[i];
-    Vec4 rotAxis = Vec4(0, 1, 0).cross(vecTo);
-
-    // Normalising both vectors
-    vecTo.normalize();
-    rotAxis.normalize();
-
-    // Calculating the rotation angle by taking the arccos of the dot product of
-    // the desired position and vector(0, 1, 0).
-    float theta = acosf(vecTo.dot(Vec4(0, 1, 0))) * 180/M_PI;
-
-    glPushMatrix();
-
-      // Rotating the tree based on the previously calculated angle and rotation axis and
-      // translating it to the desired position. The rotation orients the tree properly
-      glTranslatef(tree_positions[i].m_x, tree_positions[i].m_y, tree_positions[i].m_z);
-      glRotatef(theta, rotAxis.m_x, rotAxis.m_y, rotAxis.m_z);
-
-      // Call the list that holds the tree trunk data
-      glCallList(t_displayList[0]);
-
-      // Give every other tree a different leaf color
-      if(!(i%2))
-        glColor3f(0.706f, 0.706f, 0.251f);
-      else
-        glColor3f(0.349f, 0.584f, 0.196f);
-
-      glCallList(t_displayList[1]);
-
-    glPopMatrix();
-  }
+  // The clouds turn around their own axes in the vertex shader, only the time is kept
+  // here. It's wrapped to a full turn to keep the angle precise.
+  m_cloudSteps = fmodf(m_cloudSteps + _dt / SIMSTEP, 360.0f / CLOUDSPEED);
+}
+// ---------------------------------------------------------------------------------------
 
-  // Looping through the clouds, rotating each one slowly and scaling 'em to their respective sizes.
-  for(int i = 0; i < max_clouds; ++i)
+// ---------------------------------------------------------------------------------------
+void Planet::draw(
+                  const float _alpha,
+                  const frustum::planes &_frustum,
+                  frustum::counters &io_counters
+                 ) const
+{
+  // Draw the planet surface, mountains, seabeds and the water surface, the transparent
+  // water surface last. Only the patches in the frustum and in front of the planet's
+  // horizon are drawn and of the solid ground only the ones facing the camera, the
+  // see-through water could show its back faces.
+  Vec4 eye = eyePosition();
+  m_surfaceMesh.drawVisible(eye, m_occluderRadius, true, _frustum);
+  m_mountainMesh.drawVisible(eye, m_occluderRadius, true, _frustum);
+  m_seabedMesh.drawVisible(eye, m_occluderRadius, true, _frustum);
+  m_waterMesh.drawVisible(eye, m_occluderRadius, false, _frustum);
+
+  // All the trees are already in place in the one mesh, they're culled a patch at a time
+  int trees = m_treeMesh.drawVisible(eye, m_occluderRadius, false, _frustum);
+  io_counters.m_trees.m_visible += trees;
+  io_counters.m_trees.m_culled += m_treeMesh.patchCount() - trees;
+
+  // The clouds stay in the static instance buffer and turn in the vertex shader, so
+  // they're culled all together by the sphere around the whole cloud layer. It covers
+  // every place a cloud can turn to, so it stays the same from frame to frame.
+  float shellX = 0.0f, shellY = 0.0f, shellZ = 0.0f, shellR = m_cloudShellRadius;
+  frustum::spheres shell = {&shellX, &shellY, &shellZ, &shellR, 1};
+  int inside;
+  if(!m_cull(_frustum, shell, &inside))
   {
-    glPushMatrix();
-      glRotatef(clouds[i].m_rot += 0.1f, clouds[i].m_rAxis.m_x, clouds[i].m_rAxis.m_y, clouds[i].m_rAxis.m_z);
-      glTranslatef(0.0f, 1.0f, 0.0f);
-      glScalef(clouds[i].m_scale, clouds[i].m_scale, clouds[i].m_scale);
-      glCallList(c_displayList[0]);
-    glPopMatrix();
+    io_counters.m_clouds.m_culled += max_clouds;
+    return;
   }
+  io_counters.m_clouds.m_visible += max_clouds;
+
+  // Draw all the clouds in one go, the shader rotates each one to its position
+  // interpolated between the last two updates and scales 'em to their respective sizes
+  glUseProgram(m_cloudProgram);
+  glUniform1f(m_cloudAngleLoc, CLOUDSPEED * (m_cloudSteps - (1.0f - _alpha)));
+
+  glBindBuffer(GL_ARRAY_BUFFER, m_cloudVbo);
+  glEnableVertexAttribArray(m_cloudLoc);
+  glEnableVertexAttribArray(m_cloudScaleLoc);
+  glVertexAttribPointer(m_cloudLoc, 4, GL_FLOAT, GL_FALSE, sizeof(cloudInstance), (const GLvoid *)0);
+  glVertexAttribPointer(m_cloudScaleLoc, 1, GL_FLOAT, GL_FALSE, sizeof(cloudInstance), (const GLvoid *)(4 * sizeof(GLfloat)));
+  glVertexAttribDivisorARB(m_cloudLoc, 1);
+  glVertexAttribDivisorARB(m_cloudScaleLoc, 1);
+
+  m_cloudMesh.drawInstanced(max_clouds);
+
+  glVertexAttribDivisorARB(m_cloudLoc, 0);
+  glVertexAttribDivisorARB(m_cloudScaleLoc, 0);
+  glDisableVertexAttribArray(m_cloudScaleLoc);
+  glDisableVertexAttribArray(m_cloudLoc);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  glUseProgram(0);
 }
 // ---------------------------------------------------------------------------------------
 
@@ -135,67 +252,61 @@ void Planet::genSurface()
   float max = 0.92f;
 
   // Making an array holding boolean data on whether a tree is already placed on a certain vertex
-  bool *stored_position = new bool[(int)m_pSurface.m_Verts.size()];
-
-  GLuint id = glGenLists(1);
-  glNewList(id, GL_COMPILE);
+  bool *stored_position = new bool[(int)m_pSurface.m_Verts.size()]();
 
-    glBegin(GL_TRIANGLES);
-      for(int i = 0; i < (int)m_pSurface.m_Ind.size(); i += 9)
+  for(int i = 0; i < (int)m_pSurface.m_Ind.size(); i += 9)
+  {
+    // Arrays to hold the color values for each vertex of a triangle
+    float r[3];
+    float g[3];
+    float b[3];
+    int j = 0;
+
+    for(int k = i; k < i + 9; k += 3)
+    {
+      // Normalizing the vertex distance to 0 -> 1 for color calculations
+      float hVal = (m_pSurface.m_Verts[m_pSurface.m_Ind[k] - 1].length() - min) / (max - min);
+
+      // Depending on the vertex distance we'll have a bit different calculations
+      if(hVal < 0.4f)
       {
-        // Arrays to hold the color values for each vertex of a triangle
-        float r[3];
-        float g[3];
-        float b[3];
-        int j = 0;
-
-        for(int k = i; k < i + 9; k += 3)
+        r[j] = 0.686f + 0.15f*(hVal / 0.4f);
+        g[j] = 0.592f + 0.1f*(hVal / 0.4f);
+        b[j] = 0.31f;
+
+        // If the vertex distance < 0.4f we'll add a tree to that point
+        // but also check that no tree has been placed on that vertex yet
+        // to avoid duplicates. If not then update the tree_positions vector
+        // with the position of the vertex and set that vertex to be "visited"
+        if(stored_position[m_pSurface.m_Ind[k] - 1] == false)
         {
-          // Normalizing the vertex distance to 0 -> 1 for color calculations
-          float hVal = (m_pSurface.m_Verts[m_pSurface.m_Ind[k] - 1].length() - min) / (max - min);
-
-          // Depending on the vertex distance we'll have a bit different calculations
-          if(hVal < 0.4f)
-          {
-            r[j] = 0.686f + 0.15f*(hVal / 0.4f);
-            g[j] = 0.592f + 0.1f*(hVal / 0.4f);
-            b[j] = 0.31f;
-
-            // If the vertex distance < 0.4f we'll add a tree to that point
-            // but also check that no tree has been placed on that vertex yet
-            // to avoid duplicates. If not then update the tree_positions vector
-            // with the position of the vertex and set that vertex to be "visited"
-            if(stored_position[m_pSurface.m_Ind[k] - 1] == false)
-            {
-              tree_positions.push_back(Vec4(m_pSurface.m_Verts[m_pSurface.m_Ind[k] - 1]));
-              stored_position[m_pSurface.m_Ind[k] - 1] = true;
-            }
-          }
-          else
-          {
-            r[j] = 0.471f;
-            g[j] = 0.565f + 0.35f*(hVal - 0.49f) / 0.4f;
-            b[j] = 0.188f;
-          }
-          ++j;
+          tree_positions.push_back(Vec4(m_pSurface.m_Verts[m_pSurface.m_Ind[k] - 1]));
+          stored_position[m_pSurface.m_Ind[k] - 1] = true;
         }
+      }
+      else
+      {
+        r[j] = 0.471f;
+        g[j] = 0.565f + 0.35f*(hVal - 0.49f) / 0.4f;
+        b[j] = 0.188f;
+      }
+      ++j;
+    }
 
-        // Only using the normals of the first vertex in each triangle to achieve
-        // flat shading
-        m_pSurface.m_Norms[m_pSurface.m_Ind[i + 2] - 1].normalGL();
-        glColor3f(r[0], g[0], b[0]);
-        m_pSurface.m_Verts[m_pSurface.m_Ind[i] - 1].vertexGL();
-
-        //glColor3f(r[1], g[1], b[1]);
-        m_pSurface.m_Verts[m_pSurface.m_Ind[i + 3] - 1].vertexGL();
+    // Only using the normals of the first vertex in each triangle to achieve
+    // flat shading
+    m_surfaceMesh.normal(m_pSurface.m_Norms[m_pSurface.m_Ind[i + 2] - 1]);
+    m_surfaceMesh.colour(r[0], g[0], b[0]);
+    m_surfaceMesh.vertex(m_pSurface.m_Verts[m_pSurface.m_Ind[i] - 1]);
 
-        //glColor3f(r[2], g[2], b[2]);
-        m_pSurface.m_Verts[m_pSurface.m_Ind[i + 6] - 1].vertexGL();
-      }
+    //m_surfaceMesh.colour(r[1], g[1], b[1]);
+    m_surfaceMesh.vertex(m_pSurface.m_Verts[m_pSurface.m_Ind[i + 3] - 1]);
 
-    glEnd();
-  glEndList();
-  p_displayList.push_back(id);
+    //m_surfaceMesh.colour(r[2], g[2], b[2]);
+    m_surfaceMesh.vertex(m_pSurface.m_Verts[m_pSurface.m_Ind[i + 6] - 1]);
+  }
+  m_surfaceMesh.splitPatches(PLANETPATCHDIVISIONS);
+  m_surfaceMesh.upload();
 
   // Freeing up the memory allocated for the boolean array
   delete [] stored_position;
@@ -209,48 +320,32 @@ void Planet::genMountains()
   float min = 0.87f;
   float max = 1.01f;
 
-  GLuint id = glGenLists(1);
-  glNewList(id, GL_COMPILE);
-
-    glBegin(GL_TRIANGLES);
-      for(int i = 0; i < (int)m_pMountains.m_Ind.size(); i += 3)
-      {
-        // Normalizing the vertex distance to 0 -> 1 for color calculations
-        float hVal = (m_pMountains.m_Verts[m_pMountains.m_Ind[i] - 1].length() - min) / (max - min);
-
-        // Based on the distance of a vertex we're coloring it differently
-        if(hVal > 0.7f)
-          glColor3f(0.357f, 0.329f, 0.267f);
-        else
-          glColor3f(0.31f - 0.1 * (hVal / 0.7f), 0.286f - 0.1 * (hVal / 0.7f), 0.235f - 0.1 * (hVal / 0.7f));
-        m_pMountains.m_Norms[m_pMountains.m_Ind[i + 2] - 1].normalGL();
-        m_pMountains.m_Verts[m_pMountains.m_Ind[i] - 1].vertexGL();
-      }
-
-    glEnd();
-  glEndList();
-  p_displayList.push_back(id);
+  for(int i = 0; i < (int)m_pMountains.m_Ind.size(); i += 3)
+  {
+    // Normalizing the vertex distance to 0 -> 1 for color calculations
+    float hVal = (m_pMountains.m_Verts[m_pMountains.m_Ind[i] - 1].length() - min) / (max - min);
+
+    // Based on the distance of a vertex we're coloring it differently
+    if(hVal > 0.7f)
+      m_mountainMesh.colour(0.357f, 0.329f, 0.267f);
+    else
+      m_mountainMesh.colour(0.31f - 0.1 * (hVal / 0.7f), 0.286f - 0.1 * (hVal / 0.7f), 0.235f - 0.1 * (hVal / 0.7f));
+    m_mountainMesh.normal(m_pMountains.m_Norms[m_pMountains.m_Ind[i + 2] - 1]);
+    m_mountainMesh.vertex(m_pMountains.m_Verts[m_pMountains.m_Ind[i] - 1]);
+  }
+  m_mountainMesh.splitPatches(PLANETPATCHDIVISIONS);
+  m_mountainMesh.upload();
 }
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
 void Planet::genWaters()
 {
-  // Loads the water surface model data into a displaylist
-  GLuint id = glGenLists(1);
-  glNewList(id, GL_COMPILE);
-
-    glBegin(GL_TRIANGLES);
-      glColor4f(0.671f, 0.827f, 0.878f, 0.6);
-      for(int i = 0; i < (int)m_pWaters.m_Ind.size(); i += 3)
-      {
-        m_pWaters.m_Norms[m_pWaters.m_Ind[i + 2] - 1].normalGL();
-        m_pWaters.m_Verts[m_pWaters.m_Ind[i] - 1].vertexGL();
-      }
-
-    glEnd();
-  glEndList();
-  p_displayList.push_back(id);
+  // Loads the water surface model data into a mesh
+  m_waterMesh.colour(0.671f, 0.827f, 0.878f, 0.6);
+  m_waterMesh.addModel(m_pWaters, false);
+  m_waterMesh.splitPatches(PLANETPATCHDIVISIONS);
+  m_waterMesh.upload();
 }
 // ---------------------------------------------------------------------------------------
 
@@ -261,104 +356,115 @@ void Planet::genSeabeds()
   float min = 0.78f;
   float max = 0.9f;
 
-  GLuint id = glGenLists(1);
-  glNewList(id, GL_COMPILE);
-    glBegin(GL_TRIANGLES);
-      for(int i = 0; i < (int)m_pSeabeds.m_Ind.size(); i += 3)
-      {
-        // Normalizing the vertex distance to 0 -> 1 for color calculations
-        float hVal = (m_pSeabeds.m_Verts[m_pSeabeds.m_Ind[i] - 1].length() - min) / (max - min);
-
-        // Based on the distance of a vertex we're coloring it differently
-        if(hVal < 0.7f)
-          glColor3f(0.60f, 0.698f, 0.729f);
-        else
-          glColor3f(0.686f + 0.15f*(hVal / 0.7f), 0.592f + 0.1f*(hVal / 0.7f), 0.31f);
+  for(int i = 0; i < (int)m_pSeabeds.m_Ind.size(); i += 3)
+  {
+    // Normalizing the vertex distance to 0 -> 1 for color calculations
+    float hVal = (m_pSeabeds.m_Verts[m_pSeabeds.m_Ind[i] - 1].length() - min) / (max - min);
 
-        m_pSeabeds.m_Norms[m_pSeabeds.m_Ind[i + 2] - 1].normalGL();
-        m_pSeabeds.m_Verts[m_pSeabeds.m_Ind[i] - 1].vertexGL();
-      }
+    // Based on the distance of a vertex we're coloring it differently
+    if(hVal < 0.7f)
+      m_seabedMesh.colour(0.60f, 0.698f, 0.729f);
+    else
+      m_seabedMesh.colour(0.686f + 0.15f*(hVal / 0.7f), 0.592f + 0.1f*(hVal / 0.7f), 0.31f);
 
-    glEnd();
-  glEndList();
-  p_displayList.push_back(id);
+    m_seabedMesh.normal(m_pSeabeds.m_Norms[m_pSeabeds.m_Ind[i + 2] - 1]);
+    m_seabedMesh.vertex(m_pSeabeds.m_Verts[m_pSeabeds.m_Ind[i] - 1]);
+  }
+  m_seabedMesh.splitPatches(PLANETPATCHDIVISIONS);
+  m_seabedMesh.upload();
 }
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
 void Planet::genTree()
 {
-  // Load the trunk data to a displaylist
-  GLuint id = glGenLists(1);
-  glNewList(id, GL_COMPILE);
-
-    glBegin(GL_TRIANGLES);
-      glColor3f(0.165f, 0.106f, 0.039f);
-      for(int i = 0; i < (int)m_tTrunk.m_Ind.size(); i += 3)
-      {
-        m_tTrunk.m_Norms[m_tTrunk.m_Ind[i + 2] - 1].normalGL();
-        m_tTrunk.m_Verts[m_tTrunk.m_Ind[i] - 1].vertexGL();
-      }
-    glEnd();
+  const Vec4 up(0, 1, 0);
 
-  glEndList();
-
-  t_displayList.push_back(id);
-
-  // Load the leaf data to a separate displaylist so we're able to change the color
-  // of just the leaves later
-  id = glGenLists(1);
-  glNewList(id, GL_COMPILE);
+  for(int i = 0; i < (int)tree_positions.size(); ++i)
+  {
+    // The tree models point up the y axis, rotate them around the cross product of y and
+    // the position so they point away from the planet's centre
+    Vec4 vecTo = tree_positions[i];
+    vecTo.normalize();
+    Vec4 rotAxis = up.cross(vecTo);
+    float sinTheta = rotAxis.length();
+    float cosTheta = up.dot(vecTo);
+
+    // Straight up or down there's no cross product, any horizontal axis works then
+    if(sinTheta > 1e-6f)
+      rotAxis = rotAxis / sinTheta;
+    else
+    {
+      rotAxis = Vec4(1, 0, 0);
+      sinTheta = 0.0f;
+    }
+
+    // Rotate and move the trunk and leaves of the tree to its position and add them to
+    // the mesh, giving every other tree a different leaf color
+    const model *parts[] = {&m_tTrunk, &m_tLeaves};
+    for(int p = 0; p < 2; ++p)
+    {
+      if(!p)
+        m_treeMesh.colour(0.165f, 0.106f, 0.039f);
+      else if(!(i%2))
+        m_treeMesh.colour(0.706f, 0.706f, 0.251f);
+      else
+        m_treeMesh.colour(0.349f, 0.584f, 0.196f);
 
-    glBegin(GL_TRIANGLES);
-      for(int i = 0; i < (int)m_tLeaves.m_Ind.size(); i += 3)
+      const model &m = *parts[p];
+      for(int k = 0; k < (int)m.m_Ind.size(); k += 3)
       {
-        m_tLeaves.m_Norms[m_tLeaves.m_Ind[i + 2] - 1].normalGL();
-        m_tLeaves.m_Verts[m_tLeaves.m_Ind[i] - 1].vertexGL();
+        m_treeMesh.normal(rotateAround(m.m_Norms[m.m_Ind[k + 2] - 1], rotAxis, cosTheta, sinTheta));
+        m_treeMesh.vertex(tree_positions[i] + rotateAround(m.m_Verts[m.m_Ind[k] - 1], rotAxis, cosTheta, sinTheta));
       }
-    glEnd();
-
-  glEndList();
-
-  t_displayList.push_back(id);
+    }
+  }
+  m_treeMesh.splitPatches(PLANETPATCHDIVISIONS);
+  m_treeMesh.upload();
 }
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
 void Planet::genClouds()
 {
-  // Loads the cloud model into a displaylist
-  GLuint id = glGenLists(1);
-  glNewList(id, GL_COMPILE);
-
-    glBegin(GL_TRIANGLES);
-      glColor3f(1, 1, 1);
-      for(int i = 0; i < (int)m_cloudGeometry.m_Ind.size(); i += 3)
-      {
-        m_cloudGeometry.m_Norms[m_cloudGeometry.m_Ind[i + 2] - 1].normalGL();
-        m_cloudGeometry.m_Verts[m_cloudGeometry.m_Ind[i] - 1].vertexGL();
-      }
-    glEnd();
-
-  glEndList();
-
-  c_displayList.push_back(id);
+  // Loads the cloud model into a mesh
+  m_cloudMesh.colour(1, 1, 1);
+  m_cloudMesh.addModel(m_cloudGeometry, false);
+  m_cloudMesh.upload();
 
   boost::random::uniform_int_distribution<> u_random(1, 100);
 
   // Randomise the rotation axis, rotation and scale for each cloud
+  std::vector<cloudInstance> clouds(max_clouds);
+  float maxScale = 0.0f;
   for(int i = 0; i < max_clouds; ++i)
   {
-    m_cloud aCloud;
-    aCloud.m_rAxis = Vec4(u_random(rng)/100.0f * 2.0f - 1.0f,
-                        u_random(rng)/100.0f * 2.0f - 1.0f,
-                        u_random(rng)/100.0f * 2.0f - 1.0f);
-    aCloud.m_rAxis.normalize();
+    Vec4 rAxis(u_random(rng)/100.0f * 2.0f - 1.0f,
+               u_random(rng)/100.0f * 2.0f - 1.0f,
+               u_random(rng)/100.0f * 2.0f - 1.0f);
+    rAxis.normalize();
+
+    clouds[i].m_x = rAxis.m_x;
+    clouds[i].m_y = rAxis.m_y;
+    clouds[i].m_z = rAxis.m_z;
+    clouds[i].m_rot = u_random(rng)*3.6f;
+    clouds[i].m_scale = u_random(rng) / (100.0f * 20.0f) + 0.01f;
+    maxScale = std::max(maxScale, clouds[i].m_scale);
+  }
 
-    aCloud.m_rot = u_random(rng)*3.6f;
-    aCloud.m_scale = u_random(rng) / (100.0f * 20.0f) + 0.01f;
+  // Each cloud is moved up to the unit sphere before it's rotated, so none of them ever
+  // reaches further from the centre than the largest cloud's radius above it
+  m_cloudShellRadius = 1.0f + maxScale * m_cloudMesh.radius();
 
-    clouds.push_back(aCloud);
-  }
+  // The clouds never change so they're uploaded once
+  glGenBuffers(1, &m_cloudVbo);
+  glBindBuffer(GL_ARRAY_BUFFER, m_cloudVbo);
+  glBufferData(GL_ARRAY_BUFFER, max_clouds * sizeof(cloudInstance), &clouds[0], GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  m_cloudProgram = loadShaderProgram("shaders/cloud.vert", "shaders/cloud.frag");
+  m_cloudLoc = glGetAttribLocation(m_cloudProgram, "a_cloud");
+  m_cloudScaleLoc = glGetAttribLocation(m_cloudProgram, "a_scale");
+  m_cloudAngleLoc = glGetUniformLocation(m_cloudProgram, "u_angle");
 }
 // ---------------------------------------------------------------------------------------
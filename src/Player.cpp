@@ -11,15 +11,19 @@
 #endif
 
 #include <iostream>
+#include <cstdlib>
 #include <ctime>
 
 #include "Defs.h"
 #include "Camera.h"
 #include "Player.h"
 #include "Projectile.h"
-#include "TextureOBJ.h"
 #include "World.h"
-#include "NCCA/GLFunctions.h"
+
+#ifndef HEADLESS
+  #include "TextureOBJ.h"
+  #include "NCCA/GLFunctions.h"
+#endif
 
 // ---------------------------------------------------------------------------------------
 /// @file Player.cpp
@@ -32,61 +36,72 @@ Player::Player(
                const float _y,
                const float _z
               ) :
+               m_particles(MAX_PARTICLES),
                m_score(0),
                m_pos(_x, _y, _z, 1.0f),
+               m_camUp(0.0f, 1.0f, 0.0f),
+               m_camLeft(1.0f, 0.0f, 0.0f),
+               m_p(MAX_PROJECTILES),
                m_aimDir(0.0f),
                m_rot(0.0f),
                m_turn(0.0f),
                m_xMov(0.0f),
                m_yMov(0.0f),
-               m_life(100)
+               m_life(100),
+               m_firing(false),
+               m_narrowphase(narrowphase::select()),
+               m_hits(16)
+{
+}
+// ---------------------------------------------------------------------------------------
+
+#ifndef HEADLESS
+// ---------------------------------------------------------------------------------------
+void Player::loadAssets(
+                        AssetLoader &io_assets
+                       )
 {
   // Loading in the ship model and textures
-  loadModel("models/ss.obj", m_ship);
-
-  loadTexture("textures/projectile4.png", m_particleTexId);
-  loadTexture("textures/animated_explosion.png", m_projectileId);
-
-  // This is a bit of a hacky solution as the models (vertices, texture coordinates etc)
-  // were rotated 90 degrees ccw on the uni machines so we're using a rotated texture
-  // and rotating the actual model 90 degrees cw. If the ships' flying sideways and
-  // textures are not showing up properly, remove the #ifdef LINUX parts and leave in
-  // the DARWIN ones where ever I've flagged it as //HACKY SOLUTION
-
-// HACKY SOLUTION START
-#ifdef LINUX // Remove this line
-  loadTexture("textures/ss_texture_90.png", m_shipTexId); // Remove this line
-#endif // Remove this line
-#ifdef DARWIN // Remove this line
-  loadTexture("textures/ss_texture.png", m_shipTexId);
-#endif // Remove this line
-// HACKY SOLUTION END
-
-  // Generates the displaylist from the model data
+  io_assets.requestModel("models/ss.obj", m_ship);
+
+  io_assets.requestTexture("textures/projectile4.png", m_particleTexId);
+  io_assets.requestTexture("textures/animated_explosion.png", m_projectileId);
+
+  io_assets.requestTexture("textures/ss_texture.png", m_shipTexId);
+
+  // Loads the firing sound and background noise
+  io_assets.requestSound("sounds/flame.wav", &s_aFire);
+  io_assets.requestSound("sounds/bg_sound.ogg", &s_bgSound);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Player::initAssets()
+{
+  // Generates the mesh from the model data
   ship();
 
-  // Loads the firing sound and background noise and start the background noise
-  audio::loadSound("sounds/flame.wav", &s_aFire);
-  audio::loadSound("sounds/bg_sound.ogg", &s_bgSound);
+  // Start the background noise
   Mix_PlayMusic(s_bgSound, -1);
   Mix_VolumeMusic(MIX_MAX_VOLUME * 0.1f);
 }
 // ---------------------------------------------------------------------------------------
+#endif
 
 // ---------------------------------------------------------------------------------------
 Player::~Player()
 {
-  // Clear the projectile and particle vectors and free
+  // Kill the projectiles and particles and free
   // up the memory used by the player class
   m_p.clear();
-  std::vector<Projectile>().swap(m_p);
   m_particles.clear();
-  std::vector<Particle>().swap(m_particles);
 
+#ifndef HEADLESS
   freeModelMem(m_ship);
 
   Mix_FreeChunk(s_aFire);
   Mix_FreeMusic(s_bgSound);
+#endif
 }
 // ---------------------------------------------------------------------------------------
 
@@ -98,7 +113,36 @@ bool Player::isAlive()
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void Player::drawPlayer()
+void Player::setAim(
+                    const float _dir,
+                    const bool _fire
+                   )
+{
+  m_aimDir = _dir;
+  m_firing = _fire;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void Player::update(
+                    const float _dt
+                   )
+{
+  // If the player's shooting we'll be creating a new projectile every step
+  if(m_firing)
+    fire();
+
+  // Move the projectiles and retire the ones that have reached their maximum lifetime
+  m_p.update(_dt);
+
+  // Move the fire particles and kill them when they've reached their maximum lifetime
+  m_particles.update(_dt);
+}
+// ---------------------------------------------------------------------------------------
+
+#ifndef HEADLESS
+// ---------------------------------------------------------------------------------------
+void Player::drawPlayer() const
 {
     // Moving and orienting the player to the camera
     glMultMatrixf(m_orientation.m_openGL);
@@ -115,18 +159,18 @@ void Player::drawPlayer()
       glVertex3f(0.1*cosf(m_aimDir), 0.1*sinf(m_aimDir), 0);
     glEnd();
 
-// HACKY SOLUTION START
-#ifdef LINUX // Remove this line
-    glRotatef(-90, 0, 0, 1); // Remove this line
-#endif // Remove this line
-// HACKY SOLUTION END
-
     // Rotate and tilt the player based on the movement
     glRotatef(m_rot, 0, 0, 1);
     glRotatef(m_turn, 0, 1, 0);
 
-    glColor3f(1.0f, 0.0, 0.0f);
-    glCallLists(m_displayList.size(), GL_UNSIGNED_INT, &m_displayList[0]);
+    // Draw the ship model rotated, scaled and textured
+    glRotatef(90, 1, 0, 0);
+    glScalef(0.02f, 0.02f, 0.02f);
+
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glBindTexture(GL_TEXTURE_2D, m_shipTexId);
+    m_shipMesh.draw();
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 // ---------------------------------------------------------------------------------------
 
@@ -155,6 +199,9 @@ void Player::handleMovement(
 
   m_turn = 0;
 
+  // Store the current camera position for the interpolation
+  io_cam.m_prevEye = io_cam.m_eye;
+
   // Using the cross product we calculate the new up and side vectors for the camera
   // to control the correct movement of the camera and the player
   io_cam.m_eye.normalize();
@@ -286,16 +333,17 @@ void Player::handleMovement(
   // Wrap the rotation to be between 0 and 360
   wrapRotation(m_rot);
 
-  // Call the shooting function with the controller and camera up and side vectors
-  shoot(_c, io_cam.m_up, io_cam.m_w);
+  // Store the camera up and side vectors for the projectiles and call the shooting function
+  // with the controller
+  m_camUp = io_cam.m_up;
+  m_camLeft = io_cam.m_w;
+  shoot(_c);
 }
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
 void Player::shoot(
-                   SDL_GameController *_c,
-                   const Vec4 &_cu,
-                   const Vec4 &_cl
+                   SDL_GameController *_c
                   )
 {
   // Initially we're not shooting
@@ -331,46 +379,25 @@ void Player::shoot(
   if((x != 0 || y != 0) && _c)
     m_aimDir = atan2f(y, x);
 
-  // If the player's shooting we'll be creating projectiles inside this statement
-  if(shoot)
-  {
-
-    /*if(!Mix_Playing(1))
-    {
-      if(Mix_PlayChannel(1, a_fire, -1) == -1)
-          std::cerr << "Unable to play WAV file: " << Mix_GetError() << "\n";
-    }
-    if(Mix_Paused(1))
-      Mix_Resume(1);*/
-
-    Vec4 n = m_pos;
-    n.normalize();
-
-    // Pushing projectile and setting the starting position of the projectile to be where ever
-    // the player is at the moment and giving it a random lifetime
-    m_p.push_back(Projectile(n.m_x * (WORLDRADIUS + PLAYEROFFSET) + (m_xMov * -_cl.m_x + m_yMov * _cu.m_x),
-                             n.m_y * (WORLDRADIUS + PLAYEROFFSET) + (m_xMov * -_cl.m_y + m_yMov * _cu.m_y),
-                             n.m_z * (WORLDRADIUS + PLAYEROFFSET) + (m_xMov * -_cl.m_z + m_yMov * _cu.m_z),
-                             _cu, _cl,
-                             n.m_x, n.m_y, n.m_z,
-                             m_aimDir, std::rand()%30 + 25));
-  }
+  setAim(m_aimDir, shoot);
+}
+// ---------------------------------------------------------------------------------------
 
-  // Looping through the projectile vector and drawing them, could be set into a separate function
+// ---------------------------------------------------------------------------------------
+void Player::drawProjectiles(
+                             const float _alpha,
+                             const frustum::planes &_frustum,
+                             frustum::counter &io_counter
+                            ) const
+{
+  // Drawing all the projectiles with the sprite sheet in one go
   glBindTexture(GL_TEXTURE_2D, m_projectileId);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE);
 
   // Disable depth mask so the points above won't occlude the ones behind
   glDepthMask(GL_FALSE);
 
-    glBegin(GL_TRIANGLES);
-      for(int i = 0; i < (int)m_p.size(); ++i)
-      {
-        m_p[i].drawProjectile(3, _cu, _cl);
-        if(m_p[i].m_life == m_p[i].m_maxLife)
-          m_p.erase(m_p.begin() + i);
-      }
-    glEnd();
+  m_p.draw(_alpha, _frustum, io_counter);
 
   glBindTexture(GL_TEXTURE_2D, 0);
 
@@ -383,30 +410,36 @@ void Player::shoot(
 // ---------------------------------------------------------------------------------------
 void Player::ship()
 {
-  // Generates the displaylist from the ship model
-  GLuint id = glGenLists(1);
-  glNewList(id, GL_COMPILE);
-
-    glRotatef(90, 1, 0, 0);
-
-    glScalef(0.02f, 0.02f, 0.02f);
-
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glBindTexture(GL_TEXTURE_2D, m_shipTexId);
-
-    glBegin(GL_TRIANGLES);
-      for(int i = 0; i < (int)m_ship.m_Ind.size(); i += 3)
-      {
-        m_ship.m_Norms[m_ship.m_Ind[i + 2] - 1].normalGL();
-        m_ship.m_Text[m_ship.m_Ind[i + 1] - 1].textureGL();
-        m_ship.m_Verts[m_ship.m_Ind[i] - 1].vertexGL();
-      }
-    glEnd();
+  // Generates the mesh from the ship model
+  m_shipMesh.addModel(m_ship, true);
+  m_shipMesh.upload();
+}
+// ---------------------------------------------------------------------------------------
+#endif
 
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glScalef(1.0f/0.02f, 1.0f/0.02f, 1.0f/0.02f);
-  glEndList();
-  m_displayList.push_back(id);
+// ---------------------------------------------------------------------------------------
+void Player::fire()
+{
+  /*if(!Mix_Playing(1))
+  {
+    if(Mix_PlayChannel(1, a_fire, -1) == -1)
+        std::cerr << "Unable to play WAV file: " << Mix_GetError() << "\n";
+  }
+  if(Mix_Paused(1))
+    Mix_Resume(1);*/
+
+  Vec4 n = m_pos;
+  n.normalize();
+
+  // Spawning a projectile and setting the starting position of the projectile to be where
+  // ever the player is at the moment and giving it a random lifetime. If the pool is full
+  // the shot is dropped
+  m_p.spawn(Projectile(n.m_x * (WORLDRADIUS + PLAYEROFFSET) + (m_xMov * -m_camLeft.m_x + m_yMov * m_camUp.m_x),
+                           n.m_y * (WORLDRADIUS + PLAYEROFFSET) + (m_xMov * -m_camLeft.m_y + m_yMov * m_camUp.m_y),
+                           n.m_z * (WORLDRADIUS + PLAYEROFFSET) + (m_xMov * -m_camLeft.m_z + m_yMov * m_camUp.m_z),
+                           m_camUp, m_camLeft,
+                           n.m_x, n.m_y, n.m_z,
+                           m_aimDir, std::rand()%30 + 25));
 }
 // ---------------------------------------------------------------------------------------
 
@@ -424,11 +457,10 @@ void Player::wrapRotation(
 
 // ---------------------------------------------------------------------------------------
 void Player::checkCollisions(
-                             std::vector<Asteroid> &io_a,
-                             std::list<int> &io_aInd
+                             AsteroidField &io_a,
+                             const SphereGrid &_grid
                             )
 {
-  float dist;
   int extra_particles = 0;
 
   // A bit of a hacky solution, here we calculate the position of the player
@@ -441,57 +473,67 @@ void Player::checkCollisions(
   paDist.normalize();
   paDist *= WORLDRADIUS*ASPHERERADIUS;
 
-  // Iterator to iterate through the asteroids that have reached the atmosphere
-  std::list<int>::iterator it = io_aInd.begin();
-
-  for(it; it != io_aInd.end(); ++it)
+  // Looping through all the living projectiles, a destroyed projectile gets replaced
+  // by the last living one so the index is only advanced when there's no hit
+  int i = 0;
+  while(i < m_p.size())
   {
-    // Looping through all the living projectiles
-    for(int i = 0; i < (int)m_p.size(); ++i)
+    // Only the asteroids binned in to the same cell as the projectile can hit it,
+    // the grid holds them packed with their hit radius
+    narrowphase::spheres cell = _grid.query(m_p[i].m_pos);
+    if((int)m_hits.size() < cell.m_count)
+      m_hits.resize(cell.m_count);
+
+    if(m_narrowphase(cell, m_p[i].m_pos.m_x, m_p[i].m_pos.m_y, m_p[i].m_pos.m_z, 1.0f, &m_hits[0]))
     {
-      // Get the distance between a projectile and an asteroid
-      dist = (io_a[*it].m_pos - m_p[i].m_pos).length();
-
-      // Checks if the distance from the origin of the asteroid is small enough
-      // then we have a collision
-      if(dist < io_a[*it].m_size * 0.75f)
-      {
-        // Decrease the life of the asteroid and increase the players score
-        io_a[*it].m_life -= 6;
-        ++m_score;
-
-        // If the asteroid was destroyed, we increase the amount of fire particles
-        // it spawns to give more of an explosion effect
-        if(io_a[*it].m_life <= 0)
-          extra_particles = 50;
-
-        // Spawn fire particles whenever an asteroid gets hit
-        for(int j = 0; j < FIRE_PARTICLES + extra_particles; ++j)
-          m_particles.push_back(Particle(m_p[i].m_pos, 25));
-
-        // Destroy the projectile that hit the asteroid
-        m_p.erase(m_p.begin() + i);
-      }
+      // A projectile can only hit one asteroid, the first one in the hit list
+      int &life = io_a.m_life[io_a.indexOf(m_hits[0])];
+
+      // Decrease the life of the asteroid and increase the players score
+      life -= 6;
+      ++m_score;
+
+      // If the asteroid was destroyed, we increase the amount of fire particles
+      // it spawns to give more of an explosion effect
+      if(life <= 0)
+        extra_particles = 50;
+
+      // Spawn fire particles whenever an asteroid gets hit
+      m_particles.emit(m_p[i].m_pos, FIRE_PARTICLES + extra_particles, 25);
+
+      // Destroy the projectile that hit the asteroid
+      m_p.kill(i);
     }
+    else
+      ++i;
+  }
+
+  // Checks for collisions between the player and the asteroids in the player's cell, the
+  // player gets hit when it's within half of the size of an asteroid
+  narrowphase::spheres cell = _grid.query(paDist);
+  if((int)m_hits.size() < cell.m_count)
+    m_hits.resize(cell.m_count);
 
-    // Checks for a collision between the player and an asteroid
-    if((io_a[*it].m_pos - paDist).length() <= io_a[*it].m_size * 0.5)
+  const float scale = 0.5f / ASTEROIDHITSCALE;
+  int hits = m_narrowphase(cell, paDist.m_x, paDist.m_y, paDist.m_z, scale * scale, &m_hits[0]);
+  for(int j = 0; j < hits; ++j)
+  {
+    m_life -= 20;
+    // If the player dies (life reaches 0 or below), we spawn fire particles
+    // to the position of the player
+    if(m_life <= 0)
     {
-      m_life -= 20;
-      // If the player dies (life reaches 0 or below), we spawn fire particles
-      // to the position of the player
-      if(m_life <= 0)
-      {
-        for(int j = 0; j < 250; ++j)
-          m_particles.push_back(Particle(m_pos, 50));
-      }
+      m_particles.emit(m_pos, 250, 50);
     }
   }
 }
 // ---------------------------------------------------------------------------------------
 
+#ifndef HEADLESS
 // ---------------------------------------------------------------------------------------
-void Player::drawParticles()
+void Player::drawParticles(
+                           const float _alpha
+                          ) const
 {
   // Loop through the fire particles and draw them, for the fire particles we use a
   // kind of a flame sprite, combined with glBlendFunc (more intense parts become white)
@@ -506,16 +548,7 @@ void Player::drawParticles()
   glTexEnvi(GL_POINT_SPRITE, GL_COORD_REPLACE, GL_TRUE);
 
   glPointSize(50);
-  glBegin(GL_POINTS);
-    for(int i = 0; i < (int)m_particles.size(); ++i)
-    {
-      m_particles[i].draw();
-      m_particles[i].move();
-      ++m_particles[i].m_life;
-      if(m_particles[i].m_life >= m_particles[i].m_max_life)
-        m_particles.erase(m_particles.begin() + i);
-    }
-  glEnd();
+  m_particles.draw(_alpha);
 
   // When the drawing is finished we return all the set flags to normal
   glBindTexture(GL_TEXTURE_2D, 0);
@@ -523,3 +556,4 @@ void Player::drawParticles()
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 // ---------------------------------------------------------------------------------------
+#endif
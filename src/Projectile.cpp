@@ -10,44 +10,37 @@
   #include <OpenGL/gl.h>
 #endif
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
 #include "Projectile.h"
 #include "Defs.h"
+#include "Shader.h"
 
 // ---------------------------------------------------------------------------------------
 /// @file Projectile.cpp
-/// @brief Implementation of the projectile class functions
+/// @brief Implementation of the projectile and projectile pool class functions
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void Projectile::drawProjectile(
-                                const int _itAmt,
-                                const Vec4 &_cu,
-                                const Vec4 &_cl)
+void Projectile::update(
+                        const float _dt
+                       )
 {
-  // Calculating which sprite from the sprite sheet to use
-  // based on the elapsed life of the projectile in relation
-  // to it's maximum lifetime. This because the projectiles
-  // can have different max lifetime and we want each one to
-  // display the whole animation
-  float tDim = 1.0/5.0;
-  int step = floor(m_life*25/m_maxLife);
+  // The speed is given per simulation step so scale it by the elapsed time
+  float scale = _dt / SIMSTEP;
 
-  // Getting the texture coordinates for each sprite
-  float xMin = tDim * (step%5);
-  float xMax = tDim * (step%5 + 1);
-  float yMin = tDim * (step/5);
-  float yMax = tDim * (step/5 + 1);
+  // Store the current position so the trail can be drawn between the two
+  m_prevPos = m_pos;
 
   // Iterate the movement to smooth it with higher movement speeds
-  for(int i = 0; i < _itAmt; ++i)
+  for(int i = 0; i < PROJECTILESTEPS; ++i)
   {
     // Calculate multipliers for the left and the up vectors
-    // i.e. how much to move on each vector in each frame
-    float lMul = (PROJECTILESPEED * cosf(m_dir)) / _itAmt;
-    float uMul = (PROJECTILESPEED * sinf(m_dir)) / _itAmt;
+    // i.e. how much to move on each vector in each iteration
+    float lMul = (PROJECTILESPEED * scale * cosf(m_dir)) / PROJECTILESTEPS;
+    float uMul = (PROJECTILESPEED * scale * sinf(m_dir)) / PROJECTILESTEPS;
 
     // Move the projectile
     m_pos.m_x -= lMul * m_left.m_x;
@@ -63,7 +56,7 @@ void Projectile::drawProjectile(
       // While the projectiles are under the atmosphere we
       // move them upwards more rapidly. This is done by
       // moving the projectiles to their normal direction
-      m_pos += Vec4(m_normal.m_x, m_normal.m_y, m_normal.m_z)*PROJECTILESPEED / _itAmt;
+      m_pos += Vec4(m_normal.m_x, m_normal.m_y, m_normal.m_z)*PROJECTILESPEED * scale / PROJECTILESTEPS;
     }
 
     // Check if the projectile has reached the atmosphere,
@@ -78,60 +71,221 @@ void Projectile::drawProjectile(
       m_up.normalize();
       m_pos *= WORLDRADIUS*ASPHERERADIUS;
     }
-
-    m_normal.normalGL();
-
-    // Change the color of the projectile based on the elapsed life
-    glColor4f(1,
-              1 - (m_life / (float)m_maxLife),
-              0.5 - 2*(m_life / (float)m_maxLife),
-              1 - m_life / (float)m_maxLife);
-
-    // Length of the triangle quad side
-    float r = 0.05f;
-
-    // We use camera up and left vectors to billboard the triangles
-    // so they're facing the camera all the time
-
-    // Top right
-    glTexCoord2f(xMax, yMin);
-    glVertex3f(m_pos.m_x + r * (-_cl.m_x + _cu.m_x),
-               m_pos.m_y + r * (-_cl.m_y + _cu.m_y),
-               m_pos.m_z + r * (-_cl.m_z + _cu.m_z));
-
-    // Top left
-    glTexCoord2f(xMin, yMin);
-    glVertex3f(m_pos.m_x - r * (-_cl.m_x - _cu.m_x),
-               m_pos.m_y - r * (-_cl.m_y - _cu.m_y),
-               m_pos.m_z - r * (-_cl.m_z - _cu.m_z));
-
-    // Bot right
-    glTexCoord2f(xMax, yMax);
-    glVertex3f(m_pos.m_x + r * (-_cl.m_x - _cu.m_x),
-               m_pos.m_y + r * (-_cl.m_y - _cu.m_y),
-               m_pos.m_z + r * (-_cl.m_z - _cu.m_z));
-
-    // Top left
-    glTexCoord2f(xMin, yMin);
-    glVertex3f(m_pos.m_x - r * (-_cl.m_x - _cu.m_x),
-               m_pos.m_y - r * (-_cl.m_y - _cu.m_y),
-               m_pos.m_z - r * (-_cl.m_z - _cu.m_z));
-
-    // Bot left
-    glTexCoord2f(xMin, yMax);
-    glVertex3f(m_pos.m_x - r * (-_cl.m_x + _cu.m_x),
-               m_pos.m_y - r * (-_cl.m_y + _cu.m_y),
-               m_pos.m_z - r * (-_cl.m_z + _cu.m_z));
-
-    // Bot right
-    glTexCoord2f(xMax, yMax);
-    glVertex3f(m_pos.m_x + r * (-_cl.m_x - _cu.m_x),
-               m_pos.m_y + r * (-_cl.m_y - _cu.m_y),
-               m_pos.m_z + r * (-_cl.m_z - _cu.m_z));
   }
 
   // Increase the elapsed life
-  ++m_life;
+  m_life += scale;
+}
+// ---------------------------------------------------------------------------------------
+
+#ifndef HEADLESS
+// ---------------------------------------------------------------------------------------
+void Projectile::writeSprites(
+                              const float _alpha,
+                              projectileVertex *o_v
+                             ) const
+{
+  // Calculating which sprite from the sprite sheet to use
+  // based on the elapsed life of the projectile in relation
+  // to it's maximum lifetime. This because the projectiles
+  // can have different max lifetime and we want each one to
+  // display the whole animation
+  float t = m_life / m_maxLife;
+  float tDim = 1.0/PROJECTILESHEETDIM;
+  int step = (int)floor(t*PROJECTILESHEETDIM*PROJECTILESHEETDIM);
+
+  // Top left corner of the sprite, the rest of the cell is mapped in the fragment shader
+  float u = tDim * (step%PROJECTILESHEETDIM);
+  float v = tDim * (step/PROJECTILESHEETDIM);
+
+  // Change the color of the projectile based on the elapsed life
+  GLubyte g = (GLubyte)(std::max(0.0f, 1 - t) * 255);
+  GLubyte b = (GLubyte)(std::max(0.0f, 0.5f - 2*t) * 255);
+
+  // The trail is as long as the latest move and ends at the position interpolated
+  // between the last two updates
+  Vec4 trail = m_pos - m_prevPos;
+  Vec4 start = m_prevPos + trail * (_alpha - 1.0f);
+
+  // Write a sprite for each of the movement iterations, placing them evenly
+  // along the trail to keep it smooth
+  for(int i = 0; i < PROJECTILESTEPS; ++i)
+  {
+    Vec4 pos = start + trail * ((i + 1) / (float)PROJECTILESTEPS);
+
+    o_v[i].m_x = pos.m_x;
+    o_v[i].m_y = pos.m_y;
+    o_v[i].m_z = pos.m_z;
+    o_v[i].m_u = u;
+    o_v[i].m_v = v;
+    o_v[i].m_r = 255;
+    o_v[i].m_g = g;
+    o_v[i].m_b = b;
+    o_v[i].m_a = g;
+  }
+}
+// ---------------------------------------------------------------------------------------
+#endif
+
+// ---------------------------------------------------------------------------------------
+ProjectilePool::ProjectilePool(
+                               const int _capacity
+                              ) :
+                               m_capacity(_capacity),
+                               m_highWater(0)
+{
+  m_p.reserve(_capacity);
+
+#ifndef HEADLESS
+  // The storage for the buffer is allocated when drawing as it's orphaned every frame
+  glGenBuffers(1, &m_vbo);
+
+  m_drawX.resize(_capacity); m_drawY.resize(_capacity); m_drawZ.resize(_capacity);
+  m_drawR.resize(_capacity);
+  m_visible.resize(_capacity);
+  m_cull = frustum::select();
+
+  m_program = loadShaderProgram("shaders/projectile.vert", "shaders/projectile.frag");
+  m_sizeLoc = glGetUniformLocation(m_program, "u_size");
+  m_viewportLoc = glGetUniformLocation(m_program, "u_viewportHeight");
+  m_cellLoc = glGetUniformLocation(m_program, "u_cellSize");
+  m_texLoc = glGetUniformLocation(m_program, "u_tex");
+#endif
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+ProjectilePool::~ProjectilePool()
+{
+#ifndef HEADLESS
+  glDeleteBuffers(1, &m_vbo);
+  glDeleteProgram(m_program);
+#endif
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+bool ProjectilePool::spawn(
+                           const Projectile &_p
+                          )
+{
+  if((int)m_p.size() >= m_capacity)
+    return false;
+
+  // The storage was reserved up front so this never reallocates
+  m_p.push_back(_p);
+
+  if((int)m_p.size() > m_highWater)
+    m_highWater = (int)m_p.size();
+
+  return true;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void ProjectilePool::kill(
+                          const int _i
+                         )
+{
+  m_p[_i] = m_p.back();
+  m_p.pop_back();
 }
 // ---------------------------------------------------------------------------------------
 
+// ---------------------------------------------------------------------------------------
+void ProjectilePool::update(
+                            const float _dt
+                           )
+{
+  // The projectile moved in to a killed one's slot hasn't been updated yet
+  // so we don't advance the index after killing
+  int i = 0;
+  while(i < (int)m_p.size())
+  {
+    m_p[i].update(_dt);
+    if(m_p[i].m_life >= m_p[i].m_maxLife)
+      kill(i);
+    else
+      ++i;
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+#ifndef HEADLESS
+// ---------------------------------------------------------------------------------------
+void ProjectilePool::draw(
+                          const float _alpha,
+                          const frustum::planes &_frustum,
+                          frustum::counter &io_counter
+                         ) const
+{
+  if(m_p.empty())
+    return;
+
+  // Bound each trail with a sphere around the middle of its sprites, reaching past the
+  // end sprites by half a sprite
+  for(int i = 0; i < (int)m_p.size(); ++i)
+  {
+    Vec4 trail = m_p[i].m_pos - m_p[i].m_prevPos;
+    Vec4 centre = m_p[i].m_prevPos + trail * (_alpha - 1.0f + (PROJECTILESTEPS + 1) / (2.0f * PROJECTILESTEPS));
+    m_drawX[i] = centre.m_x;
+    m_drawY[i] = centre.m_y;
+    m_drawZ[i] = centre.m_z;
+    m_drawR[i] = trail.length() * (PROJECTILESTEPS - 1) / (2.0f * PROJECTILESTEPS) + PROJECTILESIZE * 0.5f;
+  }
+
+  frustum::spheres spheres = {&m_drawX[0], &m_drawY[0], &m_drawZ[0], &m_drawR[0], (int)m_p.size()};
+  int visible = m_cull(_frustum, spheres, &m_visible[0]);
+  io_counter.m_visible += visible;
+  io_counter.m_culled += (int)m_p.size() - visible;
+  if(!visible)
+    return;
+
+  // Orphan the old storage and write the sprites straight in to the new one
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+  glBufferData(GL_ARRAY_BUFFER, m_capacity * PROJECTILESTEPS * sizeof(projectileVertex), NULL, GL_STREAM_DRAW);
+
+  projectileVertex *v = static_cast<projectileVertex *>(glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY));
+  if(!v)
+  {
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return;
+  }
+
+  for(int i = 0; i < visible; ++i)
+    m_p[m_visible[i]].writeSprites(_alpha, v + i * PROJECTILESTEPS);
+
+  if(glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE)
+  {
+    // The point size is calculated from the viewport height in the vertex shader
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glUseProgram(m_program);
+    glUniform1f(m_sizeLoc, PROJECTILESIZE);
+    glUniform1f(m_viewportLoc, (float)viewport[3]);
+    glUniform1f(m_cellLoc, 1.0f/PROJECTILESHEETDIM);
+    glUniform1i(m_texLoc, 0);
+    glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(projectileVertex), (const GLvoid *)0);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(projectileVertex), (const GLvoid *)(3 * sizeof(GLfloat)));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(projectileVertex), (const GLvoid *)(5 * sizeof(GLfloat)));
+
+    glDrawArrays(GL_POINTS, 0, (GLsizei)visible * PROJECTILESTEPS);
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
+    glUseProgram(0);
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+// ---------------------------------------------------------------------------------------
+#endif
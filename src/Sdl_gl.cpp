@@ -59,6 +59,11 @@ SDL_GL::SDL_GL()
     SDLErrorExit("Problem creating OpenGL context");
   }
 
+  // Sync the buffer swaps to the display refresh rate, the simulation runs at a fixed
+  // rate regardless so if vsync is not available the rendering just runs uncapped
+  if(SDL_GL_SetSwapInterval(1) != 0)
+    std::cerr << "Vsync not available: " << SDL_GetError() << "\n";
+
   m_controller = NULL;
 
   // Look for possible controllers
@@ -172,7 +177,14 @@ bool SDL_GL::isActive() const
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void SDL_GL::handleInput(Player &io_p, Camera &io_cam)
+bool SDL_GL::isMinimized() const
+{
+  return SDL_GetWindowFlags(m_win) & SDL_WINDOW_MINIMIZED;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void SDL_GL::handleInput()
 {
   SDL_Event event;
 
@@ -199,8 +211,5 @@ void SDL_GL::handleInput(Player &io_p, Camera &io_cam)
       default : break;
     } // end of event switch
   } // end of poll events
-
-  if(io_p.isAlive())
-    io_p.handleMovement(m_controller, io_cam);
 }
 // ---------------------------------------------------------------------------------------
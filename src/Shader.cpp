@@ -0,0 +1,97 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#ifdef LINUX
+  #include <GL/gl.h>
+#endif
+#ifdef DARWIN
+  #include <OpenGL/gl.h>
+#endif
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "Shader.h"
+
+// ---------------------------------------------------------------------------------------
+/// @file Shader.cpp
+/// @brief Implementation of the shader loading function
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Reads a shader source and compiles it
+/// @param[in] _n Path to the shader source
+/// @param[in] _type Type of the shader, GL_VERTEX_SHADER or GL_FRAGMENT_SHADER
+/// @return Id of the compiled shader
+// ---------------------------------------------------------------------------------------
+static GLuint compileShader(const std::string &_n, const GLenum _type)
+{
+  std::ifstream file(_n.c_str());
+  if(!file)
+  {
+    std::cerr << "Couldn't load shader " << _n << "\n";
+    exit(0);
+  }
+
+  std::stringstream source;
+  source << file.rdbuf();
+  std::string s = source.str();
+  const GLchar *src = s.c_str();
+
+  GLuint id = glCreateShader(_type);
+  glShaderSource(id, 1, &src, NULL);
+  glCompileShader(id);
+
+  GLint status;
+  glGetShaderiv(id, GL_COMPILE_STATUS, &status);
+  if(status != GL_TRUE)
+  {
+    GLint length;
+    glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+    std::vector<GLchar> log(length + 1, 0);
+    glGetShaderInfoLog(id, length, NULL, &log[0]);
+
+    std::cerr << "Couldn't compile shader " << _n << "\n" << &log[0] << "\n";
+    exit(0);
+  }
+
+  return id;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+GLuint loadShaderProgram(const std::string &_vert, const std::string &_frag)
+{
+  GLuint vert = compileShader(_vert, GL_VERTEX_SHADER);
+  GLuint frag = compileShader(_frag, GL_FRAGMENT_SHADER);
+
+  GLuint id = glCreateProgram();
+  glAttachShader(id, vert);
+  glAttachShader(id, frag);
+  glLinkProgram(id);
+
+  // The shaders stay alive as long as they're attached to the program
+  glDeleteShader(vert);
+  glDeleteShader(frag);
+
+  GLint status;
+  glGetProgramiv(id, GL_LINK_STATUS, &status);
+  if(status != GL_TRUE)
+  {
+    GLint length;
+    glGetProgramiv(id, GL_INFO_LOG_LENGTH, &length);
+    std::vector<GLchar> log(length + 1, 0);
+    glGetProgramInfoLog(id, length, NULL, &log[0]);
+
+    std::cerr << "Couldn't link shaders " << _vert << " and " << _frag << "\n" << &log[0] << "\n";
+    exit(0);
+  }
+
+  return id;
+}
+// ---------------------------------------------------------------------------------------
@@ -0,0 +1,41 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#include "Simd.h"
+
+// ---------------------------------------------------------------------------------------
+/// @file Simd.cpp
+/// @brief Implementation of the cpu feature checks shared by the kernels
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+bool simd::supported(
+                     const level _l
+                    )
+{
+#ifdef SIMD_X86
+  if(_l == AVX2)
+    return __builtin_cpu_supports("avx2");
+  if(_l == SSE)
+    return __builtin_cpu_supports("sse2");
+  return true;
+#else
+  return _l == SCALAR;
+#endif
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+const char *simd::name(
+                       const level _l
+                      )
+{
+  if(_l == AVX2)
+    return "avx2";
+  if(_l == SSE)
+    return "sse";
+  return "scalar";
+}
+// ---------------------------------------------------------------------------------------
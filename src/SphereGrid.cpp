@@ -0,0 +1,190 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#include <cmath>
+#include <algorithm>
+
+#include "SphereGrid.h"
+
+// ---------------------------------------------------------------------------------------
+/// @file SphereGrid.cpp
+/// @brief Implementation of the sphere surface spatial hash
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+SphereGrid::SphereGrid(
+                       const int _res
+                      ) :
+                       m_res(_res),
+                       m_cellStart(6 * _res * _res + 1, 0)
+{;}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void SphereGrid::clear()
+{
+  m_pairCell.clear();
+  m_pairId.clear();
+  m_pairObj.clear();
+  m_objX.clear();
+  m_objY.clear();
+  m_objZ.clear();
+  m_objR2.clear();
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+int SphereGrid::cellOf(
+                       const float _x,
+                       const float _y,
+                       const float _z
+                      ) const
+{
+  float ax = std::fabs(_x), ay = std::fabs(_y), az = std::fabs(_z);
+  int face;
+  float u, v;
+
+  // The face is picked by the major axis and the point is projected on to it
+  if(ax >= ay && ax >= az)
+  {
+    face = (_x > 0 ? 0 : 1);
+    u = _y / ax;
+    v = _z / ax;
+  }
+  else if(ay >= az)
+  {
+    face = (_y > 0 ? 2 : 3);
+    u = _x / ay;
+    v = _z / ay;
+  }
+  else
+  {
+    face = (_z > 0 ? 4 : 5);
+    u = _x / az;
+    v = _y / az;
+  }
+
+  return (face * m_res + toCell(v)) * m_res + toCell(u);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void SphereGrid::insert(
+                        const int _id,
+                        const Vec4 &_pos,
+                        const float _r
+                       )
+{
+  // Bounding box of the object, every point within the radius of the object is inside
+  // of it no matter how far from the origin the point is
+  float lo[3] = {_pos.m_x - _r, _pos.m_y - _r, _pos.m_z - _r};
+  float hi[3] = {_pos.m_x + _r, _pos.m_y + _r, _pos.m_z + _r};
+
+  // Axes projected on to the u and v coordinates of the faces of each major axis,
+  // these have to match the ones used in cellOf()
+  const int uAxis[3] = {1, 0, 0};
+  const int vAxis[3] = {2, 2, 1};
+
+  // The object is stored once and each of its cells refers to it
+  int obj = (int)m_objX.size();
+  m_objX.push_back(_pos.m_x);
+  m_objY.push_back(_pos.m_y);
+  m_objZ.push_back(_pos.m_z);
+  m_objR2.push_back(_r * _r);
+
+  for(int face = 0; face < 6; ++face)
+  {
+    int axis = face / 2;
+    int ua = uAxis[axis], va = vAxis[axis];
+
+    // Range of the major axis coordinate on the positive or negative side of the axis
+    float mLo = (face % 2 ? -hi[axis] : lo[axis]);
+    float mHi = (face % 2 ? -lo[axis] : hi[axis]);
+
+    // A point is on this face only if its major coordinate is larger than the absolute
+    // values of the other two, skip the face if no point in the box can be
+    float uMinAbs = (lo[ua] > 0.0f ? lo[ua] : (hi[ua] < 0.0f ? -hi[ua] : 0.0f));
+    float vMinAbs = (lo[va] > 0.0f ? lo[va] : (hi[va] < 0.0f ? -hi[va] : 0.0f));
+    mLo = std::max(std::max(mLo, 1e-6f), std::max(uMinAbs, vMinAbs));
+    if(mHi < mLo)
+      continue;
+
+    // Range of the projected coordinates over the part of the box on this face, dividing
+    // by the smallest major coordinate pushes the coordinates furthest from the center
+    float uMin = lo[ua] / (lo[ua] < 0.0f ? mLo : mHi);
+    float uMax = hi[ua] / (hi[ua] > 0.0f ? mLo : mHi);
+    float vMin = lo[va] / (lo[va] < 0.0f ? mLo : mHi);
+    float vMax = hi[va] / (hi[va] > 0.0f ? mLo : mHi);
+
+    int colMin = toCell(uMin), colMax = toCell(uMax);
+    int rowMin = toCell(vMin), rowMax = toCell(vMax);
+
+    for(int row = rowMin; row <= rowMax; ++row)
+      for(int col = colMin; col <= colMax; ++col)
+      {
+        m_pairCell.push_back((face * m_res + row) * m_res + col);
+        m_pairId.push_back(_id);
+        m_pairObj.push_back(obj);
+      }
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void SphereGrid::build()
+{
+  // Counting sort of the pairs by their cells, first count the objects in each cell
+  std::fill(m_cellStart.begin(), m_cellStart.end(), 0);
+  for(int i = 0; i < (int)m_pairCell.size(); ++i)
+    ++m_cellStart[m_pairCell[i] + 1];
+
+  // Turn the counts in to start indices
+  for(int c = 0; c < cells(); ++c)
+    m_cellStart[c + 1] += m_cellStart[c];
+
+  // And scatter the ids to their cells, the start indices are moved along while scattering
+  // and shifted back afterwards
+  int pairs = (int)m_pairCell.size();
+  m_ids.resize(pairs);
+  m_x.resize(pairs);
+  m_y.resize(pairs);
+  m_z.resize(pairs);
+  m_r2.resize(pairs);
+  for(int i = 0; i < pairs; ++i)
+  {
+    int dst = m_cellStart[m_pairCell[i]]++;
+    int obj = m_pairObj[i];
+    m_ids[dst] = m_pairId[i];
+    m_x[dst] = m_objX[obj];
+    m_y[dst] = m_objY[obj];
+    m_z[dst] = m_objZ[obj];
+    m_r2[dst] = m_objR2[obj];
+  }
+
+  for(int c = cells(); c > 0; --c)
+    m_cellStart[c] = m_cellStart[c - 1];
+  m_cellStart[0] = 0;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+narrowphase::spheres SphereGrid::query(
+                                       const Vec4 &_pos
+                                      ) const
+{
+  int c = cellOf(_pos.m_x, _pos.m_y, _pos.m_z);
+  int first = m_cellStart[c];
+
+  narrowphase::spheres s;
+  s.m_count = m_cellStart[c + 1] - first;
+  s.m_ids = (s.m_count ? &m_ids[first] : 0);
+  s.m_x = (s.m_count ? &m_x[first] : 0);
+  s.m_y = (s.m_count ? &m_y[first] : 0);
+  s.m_z = (s.m_count ? &m_z[first] : 0);
+  s.m_r2 = (s.m_count ? &m_r2[first] : 0);
+
+  return s;
+}
+// ---------------------------------------------------------------------------------------
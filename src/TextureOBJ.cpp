@@ -20,6 +20,11 @@
 // ---------------------------------------------------------------------------------------
 
 void loadTexture(const std::string &_n, GLuint &o_id)
+{
+  uploadTexture(decodeTexture(_n), o_id);
+}
+
+SDL_Surface *decodeTexture(const std::string &_n)
 {
   SDL_Surface *texture;
   if(!(texture = IMG_Load(_n.c_str())))
@@ -27,17 +32,21 @@ void loadTexture(const std::string &_n, GLuint &o_id)
     std::cerr << "Couldn't load texture " << _n << "\n";
     exit(0);
   }
+  return texture;
+}
 
-  GLint mode = ((int)texture->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB);
+void uploadTexture(SDL_Surface *_texture, GLuint &o_id)
+{
+  GLint mode = ((int)_texture->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB);
 
   glGenTextures(1, &o_id);
   glBindTexture(GL_TEXTURE_2D, o_id);
-  glTexImage2D(GL_TEXTURE_2D, 0, mode, texture->w, texture->h, 0, mode, GL_UNSIGNED_BYTE, texture->pixels);
+  glTexImage2D(GL_TEXTURE_2D, 0, mode, _texture->w, _texture->h, 0, mode, GL_UNSIGNED_BYTE, _texture->pixels);
 
   glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
   glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 
-  SDL_FreeSurface(texture);
+  SDL_FreeSurface(_texture);
 }
@@ -11,15 +11,20 @@
 #endif
 
 #include <iostream>
-#include <SDL2/SDL.h>
+#include <ctime>
 
 #include "Defs.h"
 #include "World.h"
-#include "Audio.h"
-#include "Icosahedron.h"
-#include "TextureOBJ.h"
 #include "NCCA/Vec4.h"
-#include "NCCA/GLFunctions.h"
+
+#ifndef HEADLESS
+  #include <SDL2/SDL.h>
+
+  #include "Audio.h"
+  #include "Icosphere.h"
+  #include "TextureOBJ.h"
+  #include "NCCA/GLFunctions.h"
+#endif
 
 // ---------------------------------------------------------------------------------------
 /// @file World.cpp
@@ -33,34 +38,45 @@ World::World() :
   // Set the seed of the boost rng to whatever time it is when to program is run
   // to get different values each time the program is run.
   m_rng.seed(time(NULL));
+}
+// ---------------------------------------------------------------------------------------
+
+#ifndef HEADLESS
+// ---------------------------------------------------------------------------------------
+void World::loadAssets(
+                       AssetLoader &io_assets
+                      )
+{
+  // The planet has the biggest models so get them going first
+  m_planet.loadAssets(io_assets);
 
   // Loads in the skybox and asteroid models and stores the data to their
   // respective model structures
-  loadModel("models/sphere.obj", m_skybox);
-  loadModel("models/asteroid1.obj", m_asteroid[0]);
-  loadModel("models/asteroid2.obj", m_asteroid[1]);
-
-// HACKY SOLUTION START
-#ifdef LINUX // Remove this line
-  loadTexture("textures/sb_90.png", m_skyBoxTexId); // Remove this line
-#endif // Remove this line
-#ifdef DARWIN // Remove this line
-  loadTexture("textures/sb_cube.png", m_skyBoxTexId);
-#endif // Remove this line
-// HACKY SOLUTION END
+  io_assets.requestModel("models/sphere.obj", m_skybox);
+  io_assets.requestModel("models/asteroid1.obj", m_asteroid[0]);
+  io_assets.requestModel("models/asteroid2.obj", m_asteroid[1]);
+
+  io_assets.requestTexture("textures/sb_cube.png", m_skyBoxTexId);
 
   // Loads in the asteroid texture
-  loadTexture("textures/Am2.jpg", m_aTexId);
+  io_assets.requestTexture("textures/Am2.jpg", m_aTexId);
 
   // Loads the asteroid explosion suond and background music
-  audio::loadSound("sounds/explosion.wav", &m_aExplosion);
-  audio::loadSound("sounds/bg_music.wav", &m_bgMusic);
+  io_assets.requestSound("sounds/explosion.wav", &m_aExplosion);
+  io_assets.requestSound("sounds/bg_music.wav", &m_bgMusic);
+}
+// ---------------------------------------------------------------------------------------
 
-  // Call the functions that generate the displaylists for skybox,
+// ---------------------------------------------------------------------------------------
+void World::initAssets()
+{
+  m_planet.initAssets();
+
+  // Call the functions that generate the meshes for skybox,
   // atmosphere geodesic sphere and asteroids
   skybox();
   atmosphere();
-  genALists();
+  genAMeshes();
 
   // Set the volume levels for the explosions and background music
   Mix_VolumeChunk(m_bgMusic, MIX_MAX_VOLUME * 0.8f);
@@ -70,6 +86,8 @@ World::World() :
   Mix_PlayChannel(-1, m_bgMusic, -1);
 }
 // ---------------------------------------------------------------------------------------
+#endif
+// ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
 World::~World()
@@ -77,36 +95,54 @@ World::~World()
   // Clean up the displaylists, asteroid and star data
   m_stars.clear();
   std::vector<Vec4>().swap(m_stars);
-  m_wDisplayList.clear();
-  std::vector<GLuint>().swap(m_wDisplayList);
   m_asteroids.clear();
-  std::vector<Asteroid>().swap(m_asteroids);
   m_aColIndices.clear();
-  std::list<int>().swap(m_aColIndices);
 
+#ifndef HEADLESS
   // Clean up the memory allocated for the skybox and asteroid models
   freeModelMem(m_skybox);
 
-  for(int i = 0; i < 2; ++i)
+  for(int i = 0; i < ASTEROIDTYPES; ++i)
     freeModelMem(m_asteroid[i]);
 
   // Frees the memory allocated for the audio
   Mix_FreeChunk(m_aExplosion);
   Mix_FreeChunk(m_bgMusic);
+#endif
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void World::update(
+                   const float _dt
+                  )
+{
+  // Generate and move the asteroids and bin the ones on the atmosphere
+  generate_Asteroids(_dt);
+  binAsteroids();
+
+#ifndef HEADLESS
+  // Rotate the clouds
+  m_planet.update(_dt);
+#endif
 }
 // ---------------------------------------------------------------------------------------
 
+#ifndef HEADLESS
 // ---------------------------------------------------------------------------------------
-void World::drawWorld()
+void World::drawWorld(
+                      const float _alpha,
+                      const frustum::planes &_frustum,
+                      frustum::counters &io_counters
+                     ) const
 {
-  // Draws the stars, generate and draw the asteroids and do the spatial partitioning
+  // Draws the stars and the asteroids
   drawStars();
-  generate_Asteroids();
-  partByDist();
+  drawAsteroids(_alpha, _frustum, io_counters.m_asteroids);
 
-  // Calls the displaylists that draw the atmosphere and skybox and finally the planet
-  glCallLists(m_wDisplayList.size(), GL_UNSIGNED_INT, &m_wDisplayList[0]);
-  drawPlanet();
+  // Draws the skybox and atmosphere and finally the planet
+  drawSkyAndAtmosphere();
+  drawPlanet(_alpha, _frustum, io_counters);
 }
 // ---------------------------------------------------------------------------------------
 
@@ -126,175 +162,126 @@ void World::drawStars() const
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void World::drawPlanet()
+void World::drawPlanet(
+                       const float _alpha,
+                       const frustum::planes &_frustum,
+                       frustum::counters &io_counters
+                      ) const
 {
   // Scale the planet by the defined world radius and call the draw function of the
-  // planet object
+  // planet object, the frustum is scaled along with it
   glScalef(WORLDRADIUS, WORLDRADIUS, WORLDRADIUS);
-  m_planet.draw();
+  m_planet.draw(_alpha, frustum::scale(_frustum, WORLDRADIUS), io_counters);
 }
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
 void World::atmosphere()
 {
-  // Generate the displaylist for the atmosphere
-  GLuint id = glGenLists(1);
-  glNewList(id, GL_COMPILE);
-
-    // Turn the polygon mode to GL_LINE so the atmosphere will
-    // be displayed in wireframe mode
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-
-    // Set the color to a blueish value and set the opacity to 60%
-    glColor4f(0.114, 0.431, 0.506, 0.6);
-
-    // Scale the atmosphere
-    glScalef(WORLDRADIUS*ASPHERERADIUS, WORLDRADIUS*ASPHERERADIUS, WORLDRADIUS*ASPHERERADIUS);
-
-    glBegin(GL_TRIANGLES);
-
-        // Calling the triangle sphere/geodesic sphere function with the subdivison
-        // level 4 to generate the actual atmosphere
-        tSphere(4);
-
-    glEnd();
-
-    // Return the scale back to normal as we're not loading identity with every element
-    glScalef(1.0f/(WORLDRADIUS*ASPHERERADIUS), 1.0f/(WORLDRADIUS*ASPHERERADIUS), 1.0f/(WORLDRADIUS*ASPHERERADIUS));
-
-    // Turn the polygon mode back to fill so no other objects will be affected by
-    // the wireframe mode
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-  glEndList();
-  m_wDisplayList.push_back(id);
+  // Subdividing an icosahedron 4 times to generate the actual atmosphere. The
+  // colour is a blueish value with the opacity at 60%
+  m_atmosphereMesh.colour(0.114, 0.431, 0.506, 0.6);
+  Icosphere(4).addTo(m_atmosphereMesh);
+  m_atmosphereMesh.upload();
 }
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
 void World::skybox()
 {
-  // Generate a displaylist for the skybox
-  GLuint id = glGenLists(1);
-  glNewList(id, GL_COMPILE);
-
-    // We disable lighting and depth mask/testing as the skybox should be fully lit due to
-    // it being a space scenery where the elements kinda "bring light to the scene"
-    glDisable(GL_LIGHTING);
-    glDepthMask(GL_FALSE);
+  // Generate a mesh for the skybox, the normals are flipped as the
+  // skybox is seen from the inside
+  m_skyboxMesh.colour(1.0f, 1.0f, 1.0f, 1.0f);
+  for(int i = 0; i < (int)m_skybox.m_Ind.size(); i += 3)
+  {
+    m_skyboxMesh.normal(m_skybox.m_Norms[m_skybox.m_Ind[i + 2] - 1] * -1);
+    m_skyboxMesh.texCoord(m_skybox.m_Text[m_skybox.m_Ind[i + 1] - 1]);
+    m_skyboxMesh.vertex(m_skybox.m_Verts[m_skybox.m_Ind[i] - 1]);
+  }
+  m_skyboxMesh.upload();
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+void World::drawSkyAndAtmosphere() const
+{
+  // We disable lighting and depth mask/testing as the skybox should be fully lit due to
+  // it being a space scenery where the elements kinda "bring light to the scene"
+  glDisable(GL_LIGHTING);
+  glDepthMask(GL_FALSE);
+
+  glPushMatrix();
     // Scale the skybox
     glScalef(WORLDRADIUS*ASPHERERADIUS*SKYBOXRADIUS, WORLDRADIUS*ASPHERERADIUS*SKYBOXRADIUS, WORLDRADIUS*ASPHERERADIUS*SKYBOXRADIUS);
 
-    // Binding the texture inside the list so that the texture is rendered
-    // whenever the list is called.
     glBindTexture(GL_TEXTURE_2D, m_skyBoxTexId);
-    glBegin(GL_TRIANGLES);
-
-      glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-      for(int i = 0; i < (int)m_skybox.m_Ind.size(); i += 3)
-      {
-        m_skybox.m_Norms[m_skybox.m_Ind[i + 2] - 1].normalInvGL();
-        m_skybox.m_Text[m_skybox.m_Ind[i + 1] - 1].textureGL();
-        m_skybox.m_Verts[m_skybox.m_Ind[i] - 1].vertexGL();
-      }
-
-    glEnd();
+    m_skyboxMesh.draw();
     glBindTexture(GL_TEXTURE_2D, 0);
+  glPopMatrix();
 
-    // Return the scale back to normal as we're not loading identity with every element
-    glScalef(1.0f/(WORLDRADIUS*ASPHERERADIUS*SKYBOXRADIUS), 1.0f/(WORLDRADIUS*ASPHERERADIUS*SKYBOXRADIUS), 1.0f/(WORLDRADIUS*ASPHERERADIUS*SKYBOXRADIUS));
+  // Turning depth mask/testing and lighting back on
+  glDepthMask(GL_TRUE);
+  glEnable(GL_LIGHTING);
 
-    // Turning depth mask/testing and lighting back on
-    glDepthMask(GL_TRUE);
-    glEnable(GL_LIGHTING);
-  glEndList();
-  m_wDisplayList.push_back(id);
-}
-// ---------------------------------------------------------------------------------------
+  // Turn the polygon mode to GL_LINE so the atmosphere will
+  // be displayed in wireframe mode
+  glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
-// ---------------------------------------------------------------------------------------
-void World::subd(const Vec4 &_a, const Vec4 &_b, const Vec4 &_c, const int _d) const
-{
-  // A vector array holding the new points achieved by the subdivision
-  Vec4 v[3];
-
-  // As this is a recursive function, we'll check that we're still subdividing.
-  // If not the function will reach its end and "return"
-  if(_d > 0)
-  {
+  glPushMatrix();
+    // Scale the atmosphere
+    glScalef(WORLDRADIUS*ASPHERERADIUS, WORLDRADIUS*ASPHERERADIUS, WORLDRADIUS*ASPHERERADIUS);
+    m_atmosphereMesh.draw();
+  glPopMatrix();
 
-    // Calculate the subdivided points by getting the mid point of each side
-    // of the triangle
-    v[0] = (_a + _b)/2.0;
-    v[1] = (_a + _c)/2.0;
-    v[2] = (_b + _c)/2.0;
-
-    // Normalise the new points as they will be used for the next subdivision
-    v[0].normalize();
-    v[1].normalize();
-    v[2].normalize();
-
-    // Call the subdivide function with the new triangles formed by the
-    // current subdivision:
-    /*   /\      /\
-        /  \ => /__\
-       /____\  /_\/_\ */
-
-    subd(_a, v[0], v[1], _d - 1);
-    subd(v[0], _b, v[2], _d - 1);
-    subd(v[1], v[2], _c, _d - 1);
-    subd(v[0], v[1], v[2], _d - 1);
-
-    // If we've reached the last subdivision level we'll render out the triangles
-    // As we only want the to draw the same sized triangles
-    if(_d == 1)
-    {
-      drawTriangle(_a, v[0], v[1]);
-      drawTriangle(v[0], _b, v[2]);
-      drawTriangle(v[1], v[2], _c);
-      drawTriangle(v[0], v[1], v[2]);
-    }
-  }
+  // Turn the polygon mode back to fill so no other objects will be affected by
+  // the wireframe mode
+  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 }
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void World::drawTriangle(
-                         const Vec4 &_a,
-                         const Vec4 &_b,
-                         const Vec4 &_c
-                        ) const
+void World::drawAsteroids(
+                          const float _alpha,
+                          const frustum::planes &_frustum,
+                          frustum::counter &io_counter
+                         ) const
 {
-  // Calculating the normal of a face (not necessarily needed here as we're
-  // only using this method for the wireframed atmosphere.
-  Vec4 normal;
-  normal = _a + _b + _c;
-  normal.normalize();
-
-  normal.normalGL();
-
-  _a.vertexGL();
-  _b.vertexGL();
-  _c.vertexGL();
+  // Bind the asteroid texture and draw the living asteroids in the view
+  glBindTexture(GL_TEXTURE_2D, m_aTexId);
+  m_asteroids.draw(m_aMesh, _alpha, _frustum, io_counter);
+  glBindTexture(GL_TEXTURE_2D, 0);
 }
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void World::tSphere(
-                    const int _d
-                   ) const
+void World::genAMeshes()
 {
-  // Loop through the icosahedron shape and subdivide each triangle
-  for(int k = 0; k < 20; ++k)
+  // Generating the meshes for both asteroid models, each triangle gets the
+  // normal of its first vertex like the models have always been drawn
+  for(int j = 0; j < ASTEROIDTYPES; ++j)
   {
-    icosHedron[k][0].normalize();
-    icosHedron[k][1].normalize();
-    icosHedron[k][2].normalize();
-    subd(icosHedron[k][0], icosHedron[k][1], icosHedron[k][2], _d);
+    const model &m = m_asteroid[j];
+    for(int i = 0; i < (int)m.m_Ind.size(); i += 9)
+    {
+      m_aMesh[j][0].normal(m.m_Norms[m.m_Ind[i + 2] - 1]);
+      for(int k = 0; k < 9; k += 3)
+      {
+        m_aMesh[j][0].texCoord(m.m_Text[m.m_Ind[i + k + 1] - 1]);
+        m_aMesh[j][0].vertex(m.m_Verts[m.m_Ind[i + k] - 1]);
+      }
+    }
+
+    // Each level is simplified from the full model down to half the triangles of the
+    // level before
+    for(int l = 1; l < ASTEROIDLODS; ++l)
+      m_aMesh[j][0].simplify((m_aMesh[j][0].indexCount() / 3) >> l, m_aMesh[j][l]);
+
+    for(int l = 0; l < ASTEROIDLODS; ++l)
+      m_aMesh[j][l].upload();
   }
 }
 // ---------------------------------------------------------------------------------------
+#endif
 
 // ---------------------------------------------------------------------------------------
 void World::initStars(
@@ -319,16 +306,19 @@ void World::initStars(
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void World::generate_Asteroids()
+void World::generate_Asteroids(
+                               const float _dt
+                              )
 {
   // Using the boost random to generate random attributes
   // for each asteroid
   boost::random::uniform_int_distribution<> u_random(1, 100);
 
-  // As we don't want to generate asteroids every frame, we add the boost random
+  // As we don't want to generate asteroids every step, we add the boost random
   // element to the equation and only generate more asteroids if the randomness
-  // gets a value > 95 which should theoretically be about 5% chance every frame
-  if(u_random(m_rng)/100.0 > 0.95 && (int)m_asteroids.size() < m_maxAsteroids)
+  // gets a value > 95 which should theoretically be about 5% chance every
+  // simulation step, scaled by the elapsed time
+  if(u_random(m_rng)/100.0 > 1.0 - 0.05 * _dt / SIMSTEP && m_asteroids.size() < m_maxAsteroids)
   {
     // Generate a random position for each asteroid (adding 0.01f to each
     // to avoid the unlikely case of each component resulting to 0
@@ -363,107 +353,88 @@ void World::generate_Asteroids()
     float size = u_random(m_rng)/100.0 * 0.8f + 0.1f;
     int type = u_random(m_rng)%2;
 
-    // Push the asteroid to the stl vector to have it drawn later
-    m_asteroids.push_back(Asteroid(aPos, aDir,
-                                 aUp, aSide,
-                                 size, fmod(u_random(m_rng)/100.0, 0.04f) + 0.0315f,
-                                 size * 150, type));
+    // Add the asteroid to the field to have it drawn later
+    m_asteroids.insert(aPos, aDir, aUp,
+                       size, fmod(u_random(m_rng)/100.0, 0.04f) + 0.0315f,
+                       size * 150, type);
   }
 
-  // Bind the asteroid texture and loop through the living asteroids
-  glBindTexture(GL_TEXTURE_2D, m_aTexId);
-  for(int i = 0; i < (int)m_asteroids.size(); ++i)
+  // Destroy the asteroids that have no health left, a destroyed asteroid gets replaced
+  // by the last one so the index is only advanced for living ones. The fragments are
+  // added to the end and moved with the rest of the field below.
+  int i = 0;
+  while(i < m_asteroids.size())
   {
-    // Check if the asteroid still has health left, if so we'll call its
-    // drawing function
-    if(m_asteroids[i].m_life > 0)
-      m_asteroids[i].draw(m_aDisplayList);
-    else
+    if(m_asteroids.m_life[i] > 0)
+    {
+      ++i;
+      continue;
+    }
+
+    // Bigger asteroids will generate two smaller asteroids (idea is that the asteroid
+    // breaks to smaller pieces)
+    // TODO: model and implement actually explodable asteroids
+    if(m_asteroids.m_size[i] > 0.5f)
     {
-      // If not we check the size of the asteroid as bigger asteroids will generate
-      // two smaller asteroids (idea is that the asteroid breaks to smaller pieces)
-      // TODO: model and implement actually explodable asteroids
-      if(m_asteroids[i].m_size > 0.5f)
+      for(int j = 0; j < 2; ++j)
       {
-        for(int j = 0; j < 2; ++j)
-        {
-          // Set the start position of the new smalle asteroids to be where the bigger
-          // one was destroyed, randomise rest of the attributes.
-          Vec4 aPos = m_asteroids[i].m_pos;
-          aPos.normalize();
-          Vec4 new_dir = aPos * - 1;
-          Vec4 new_side(u_random(m_rng)/100.0 + 0.01f,
-                    u_random(m_rng)/100.0 + 0.01f,
-                    0);
-          Vec4 new_up = new_side.cross(aPos);
-
-          if(fabs(aPos.m_z) > 0.001)
-            new_side.m_z = -(new_side.m_x * aPos.m_x + new_side.m_y * aPos.m_y) / aPos.m_z;
-
-          float new_size = m_asteroids[i].m_size * fmod(u_random(m_rng)/100.0, 0.35f) + 0.25f;
-
-          m_asteroids.push_back(Asteroid(m_asteroids[i].m_pos, new_dir,
-                                         new_up, new_side,
-                                         new_size, fmod(u_random(m_rng)/100.0, 0.055) + 0.02f,
-                                         new_size*150, u_random(m_rng)%2));
-        }
+        // Set the start position of the new smalle asteroids to be where the bigger
+        // one was destroyed, randomise rest of the attributes.
+        Vec4 aPos = m_asteroids.position(i);
+        aPos.normalize();
+        Vec4 new_dir = aPos * - 1;
+        Vec4 new_side(u_random(m_rng)/100.0 + 0.01f,
+                  u_random(m_rng)/100.0 + 0.01f,
+                  0);
+        Vec4 new_up = new_side.cross(aPos);
+
+        float new_size = m_asteroids.m_size[i] * fmod(u_random(m_rng)/100.0, 0.35f) + 0.25f;
+
+        m_asteroids.insert(m_asteroids.position(i), new_dir, new_up,
+                           new_size, fmod(u_random(m_rng)/100.0, 0.055) + 0.02f,
+                           new_size*150, u_random(m_rng)%2);
       }
+    }
 
-      // When an asteroid is destroyed we play the explosion sound and remove it from
-      // the stl vector
-      Mix_PlayChannel(-1, m_aExplosion, 0);
+    // When an asteroid is destroyed we play the explosion sound and remove it from
+    // the field
+#ifndef HEADLESS
+    Mix_PlayChannel(-1, m_aExplosion, 0);
+#endif
 
-      m_asteroids.erase(m_asteroids.begin() + i);
-    }
+    removeAsteroid(i);
   }
-  glBindTexture(GL_TEXTURE_2D, 0);
+
+  // Move the whole field in one batch and start tracking the asteroids that reached the
+  // atmosphere for collisions
+  int reached = m_asteroids.update(_dt, m_reached);
+  for(int n = 0; n < reached; ++n)
+    m_aColIndices.insert(m_asteroids.slotAt(m_reached[n]));
 }
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void World::partByDist()
+void World::binAsteroids()
 {
-  // Looping through the asteroids to do the spatial partitioning
-  // This is done by checking whether an asteroid has reached the atmosphere
-  for(int i = 0; i < (int)m_asteroids.size(); ++i)
-    if(fabs(m_asteroids[i].m_pos.length() - WORLDRADIUS*ASPHERERADIUS) < 0.05)
-      m_aColIndices.push_back(i);
-
-  // As we're only storing the indices of the asteroids we'll sort the list
-  // and call unique to remove duplicate entries as the loop above is not
-  // checking whether a certain asteroid has already been added to the list
-  m_aColIndices.sort();
-  m_aColIndices.unique();
+  // Bin the asteroids on the atmosphere in to the grid with their hit radius
+  m_aGrid.clear();
+  for(int n = 0; n < m_aColIndices.size(); ++n)
+  {
+    int a = m_asteroids.indexOf(m_aColIndices[n]);
+    m_aGrid.insert(m_aColIndices[n], m_asteroids.position(a), m_asteroids.m_size[a] * ASTEROIDHITSCALE);
+  }
+  m_aGrid.build();
 }
 // ---------------------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------------------
-void World::genALists()
+void World::removeAsteroid(
+                           const int _i
+                          )
 {
-  // Generating the displaylists for both asteroid models
-  GLuint id;
-
-  for(int j = 0; j < 2; ++j)
-  {
-    id = glGenLists(1);
-    glNewList(id, GL_COMPILE);
-      glBegin(GL_TRIANGLES);
-        for(int i = 0; i < (int)m_asteroid[j].m_Ind.size(); i += 9)
-        {
-          m_asteroid[j].m_Norms[m_asteroid[j].m_Ind[i + 2] - 1].normalGL();
-          m_asteroid[j].m_Text[m_asteroid[j].m_Ind[i + 1] - 1].textureGL();
-          m_asteroid[j].m_Verts[m_asteroid[j].m_Ind[i] - 1].vertexGL();
-
-          m_asteroid[j].m_Text[m_asteroid[j].m_Ind[i + 4] - 1].textureGL();
-          m_asteroid[j].m_Verts[m_asteroid[j].m_Ind[i + 3] - 1].vertexGL();
-
-          m_asteroid[j].m_Text[m_asteroid[j].m_Ind[i + 7] - 1].textureGL();
-          m_asteroid[j].m_Verts[m_asteroid[j].m_Ind[i + 6] - 1].vertexGL();
-        }
-      glEnd();
-    glEndList();
-
-    m_aDisplayList.push_back(id);
-  }
+  // The slot index stays the same when the field moves the asteroids around
+  // so only the removed one needs to be dropped from the set
+  m_aColIndices.erase(m_asteroids.slotAt(_i));
+  m_asteroids.remove(m_asteroids.handleAt(_i));
 }
 // ---------------------------------------------------------------------------------------
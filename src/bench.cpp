@@ -0,0 +1,731 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include <boost/tokenizer.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "Defs.h"
+#include "Particles.h"
+#include "ParticleKernel.h"
+#include "SphereGrid.h"
+#include "Asteroids.h"
+#include "AsteroidKernel.h"
+#include "LoadOBJ.h"
+#include "Mesh.h"
+#include "Frustum.h"
+#include "Icosphere.h"
+
+// ---------------------------------------------------------------------------------------
+/// @file bench.cpp
+/// @brief Main file of the microbenchmark build. Runs the benchmarks for the simulation
+///        parts that don't need a window or a GL context and prints out the throughput.
+///        Usage: super_stardust_bench [benchmark name], run from the bench directory so
+///        the models are found in ../models
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Returns the seconds elapsed since the given time point
+/// @param[in] _start Time point to measure from
+/// @return Elapsed seconds
+// ---------------------------------------------------------------------------------------
+static double elapsedSince(
+                           const std::chrono::steady_clock::time_point &_start
+                          )
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Updates pools of 10k to 1M particles with each of the particle kernels the cpu
+///        supports and prints out the particles updated per second
+// ---------------------------------------------------------------------------------------
+static void benchParticles()
+{
+  const int counts[] = {10000, 100000, 1000000};
+  const particleKernel::kernel kernels[] = {particleKernel::updateScalar,
+                                            particleKernel::updateSSE,
+                                            particleKernel::updateAVX2};
+
+  std::cout << "particles (selected kernel: " << particleKernel::name(particleKernel::select()) << ")\n";
+
+  for(int c = 0; c < 3; ++c)
+  {
+    for(int k = 0; k < 3; ++k)
+    {
+      if(!particleKernel::supported(kernels[k]))
+        continue;
+
+      // Spawn the particles around the origin with a lifetime long enough
+      // for none of them to die during the benchmark
+      std::srand(1);
+      ParticlePool pool(counts[c]);
+      pool.setKernel(kernels[k]);
+      for(int i = 0; i < counts[c]; ++i)
+        pool.emit(Vec4(std::rand()/(float)RAND_MAX * 2 - 1,
+                       std::rand()/(float)RAND_MAX * 2 - 1,
+                       std::rand()/(float)RAND_MAX * 2 - 1), 1, 1e9f);
+
+      // Roughly the same amount of particle updates for each pool size
+      int iterations = 50000000 / counts[c];
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for(int i = 0; i < iterations; ++i)
+        pool.update(SIMSTEP);
+      double elapsed = elapsedSince(start);
+
+      std::cout << "  " << counts[c] << " particles, " << particleKernel::name(kernels[k]) << ": "
+                << counts[c] * (double)iterations / elapsed << " particles/s\n";
+    }
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Returns a random point on a sphere
+/// @param[in] _r Radius of the sphere
+/// @return Random point on the sphere
+// ---------------------------------------------------------------------------------------
+static Vec4 randomOnSphere(
+                           const float _r
+                          )
+{
+  Vec4 p;
+  do
+  {
+    p = Vec4(std::rand()/(float)RAND_MAX * 2 - 1,
+             std::rand()/(float)RAND_MAX * 2 - 1,
+             std::rand()/(float)RAND_MAX * 2 - 1);
+  } while(p.length() > 1.0f || p.length() < 0.1f);
+
+  p.normalize();
+  p *= _r;
+
+  return p;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Stress wave of 2000 asteroids and 500 projectiles on the atmosphere, times the
+///        projectile-asteroid tests against every asteroid and through the atmosphere grid
+// ---------------------------------------------------------------------------------------
+static void benchCollisions()
+{
+  const int asteroids = 2000, projectiles = 500, iterations = 200;
+  const float radius = WORLDRADIUS*ASPHERERADIUS;
+
+  std::srand(1);
+  std::vector<Vec4> aPos, pPos;
+  std::vector<float> aRadius;
+  for(int i = 0; i < asteroids; ++i)
+  {
+    aPos.push_back(randomOnSphere(radius));
+    aRadius.push_back((std::rand()/(float)RAND_MAX * 0.8f + 0.1f) * ASTEROIDHITSCALE);
+  }
+  for(int i = 0; i < projectiles; ++i)
+    pPos.push_back(randomOnSphere(radius));
+
+  std::cout << "collisions (" << asteroids << " asteroids, " << projectiles << " projectiles)\n";
+
+  // Every projectile against every asteroid
+  int hits = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(int n = 0; n < iterations; ++n)
+    for(int i = 0; i < projectiles; ++i)
+      for(int j = 0; j < asteroids; ++j)
+        if((aPos[j] - pPos[i]).length() < aRadius[j])
+          ++hits;
+  double elapsed = elapsedSince(start);
+  std::cout << "  brute force: " << elapsed / iterations * 1000.0 << " ms/step, "
+            << hits / iterations << " hits\n";
+
+  // Rebuild the grid every step like the game does
+  SphereGrid grid;
+  start = std::chrono::steady_clock::now();
+  for(int n = 0; n < iterations; ++n)
+  {
+    grid.clear();
+    for(int j = 0; j < asteroids; ++j)
+      grid.insert(j, aPos[j], aRadius[j]);
+    grid.build();
+  }
+  elapsed = elapsedSince(start);
+  std::cout << "  sphere grid build: " << elapsed / iterations * 1000.0 << " ms/step\n";
+
+  // And test each projectile against its cell with each of the narrowphase kernels the
+  // cpu supports
+  const narrowphase::kernel kernels[] = {narrowphase::testScalar,
+                                         narrowphase::testSSE,
+                                         narrowphase::testAVX2};
+  std::vector<int> hitList(asteroids);
+
+  for(int k = 0; k < 3; ++k)
+  {
+    if(!narrowphase::supported(kernels[k]))
+      continue;
+
+    hits = 0;
+    start = std::chrono::steady_clock::now();
+    for(int n = 0; n < iterations; ++n)
+      for(int i = 0; i < projectiles; ++i)
+        hits += kernels[k](grid.query(pPos[i]), pPos[i].m_x, pPos[i].m_y, pPos[i].m_z, 1.0f, &hitList[0]);
+    elapsed = elapsedSince(start);
+    std::cout << "  sphere grid queries, " << narrowphase::name(kernels[k]) << " narrowphase: "
+              << elapsed / iterations * 1000.0 << " ms/step, " << hits / iterations << " hits\n";
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Returns the view frustum of the game camera, 6 units away looking at the planet
+///        with the same perspective as in the game
+/// @return Planes of the frustum
+// ---------------------------------------------------------------------------------------
+static frustum::planes gameFrustum()
+{
+  const float fov = 65.0f, near = 0.5f, far = 200.0f;
+  const float aspect = SCREENWIDTH / (float)SCREENHEIGHT;
+  const float range = std::tan(fov / 360.0f * M_PI) * near;
+  Mat4 projection;
+  projection.m_00 = near / (range * aspect);
+  projection.m_11 = near / range;
+  projection.m_22 = -(far + near) / (far - near);
+  projection.m_23 = -1.0f;
+  projection.m_32 = -(2.0f * far * near) / (far - near);
+  Mat4 modelView;
+  modelView.m_32 = -6.0f;
+  return frustum::extract(modelView, projection);
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Culls 300, 10k and 100k spheres scattered around the planet against the frustum
+///        of the game camera with each of the culling kernels the cpu supports and prints
+///        out the spheres tested per second and how many were visible
+// ---------------------------------------------------------------------------------------
+static void benchCulling()
+{
+  const int counts[] = {300, 10000, 100000};
+  const frustum::kernel kernels[] = {frustum::cullScalar,
+                                     frustum::cullSSE,
+                                     frustum::cullAVX2};
+  const float radius = WORLDRADIUS*ASPHERERADIUS;
+
+  const frustum::planes planes = gameFrustum();
+
+  std::cout << "culling (selected kernel: " << frustum::name(frustum::select()) << ")\n";
+
+  for(int c = 0; c < 3; ++c)
+  {
+    const int count = counts[c];
+    std::srand(1);
+    std::vector<float> x(count), y(count), z(count), r(count);
+    for(int i = 0; i < count; ++i)
+    {
+      Vec4 p = randomOnSphere(radius * (1.0f + std::rand()/(float)RAND_MAX));
+      x[i] = p.m_x; y[i] = p.m_y; z[i] = p.m_z;
+      r[i] = (std::rand()/(float)RAND_MAX * 0.8f + 0.1f) * ASTEROIDHITSCALE;
+    }
+    const frustum::spheres spheres = {&x[0], &y[0], &z[0], &r[0], count};
+    std::vector<int> visible(count);
+
+    const int iterations = std::max(10, 10000000 / count);
+    for(int k = 0; k < 3; ++k)
+    {
+      if(!frustum::supported(kernels[k]))
+        continue;
+
+      int drawn = 0;
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for(int n = 0; n < iterations; ++n)
+        drawn = kernels[k](planes, spheres, &visible[0]);
+      double elapsed = elapsedSince(start);
+      std::cout << "  " << count << " spheres, " << frustum::name(kernels[k]) << ": "
+                << count * (double)iterations / elapsed / 1e6 << " M spheres/s, "
+                << drawn << " visible\n";
+    }
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Moves fields of 300 (the default asteroid limit), 10k and 100k asteroids with each
+///        of the asteroid kernels the cpu supports and prints out the asteroids moved per
+///        second. Half of the asteroids start on the atmosphere and the rest between the
+///        atmosphere and the skybox heading towards the planet so both phases get timed.
+// ---------------------------------------------------------------------------------------
+static void benchAsteroids()
+{
+  const int counts[] = {300, 10000, 100000};
+  const asteroidKernel::kernel kernels[] = {asteroidKernel::updateScalar,
+                                            asteroidKernel::updateSSE,
+                                            asteroidKernel::updateAVX2};
+  const float radius = WORLDRADIUS*ASPHERERADIUS;
+
+  std::cout << "asteroids (selected kernel: " << asteroidKernel::name(asteroidKernel::select()) << ")\n";
+
+  std::vector<int> reached;
+  for(int c = 0; c < 3; ++c)
+  {
+    for(int k = 0; k < 3; ++k)
+    {
+      if(!asteroidKernel::supported(kernels[k]))
+        continue;
+
+      std::srand(1);
+      AsteroidField field(counts[c]);
+      field.setKernel(kernels[k]);
+      for(int i = 0; i < counts[c]; ++i)
+      {
+        float distance = i % 2 ? radius : radius + std::rand()/(float)RAND_MAX * (15.0f - radius);
+        Vec4 pos = randomOnSphere(1.0f);
+        Vec4 up = pos.cross(randomOnSphere(1.0f));
+        up.normalize();
+
+        field.insert(pos * distance, pos * -1, up,
+                     0.5f, std::rand()/(float)RAND_MAX * 0.04f + 0.0315f, 75, 0);
+      }
+
+      // Roughly the same amount of asteroid updates for each field size
+      int iterations = 20000000 / counts[c];
+      int arrivals = 0;
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for(int i = 0; i < iterations; ++i)
+        arrivals += field.update(SIMSTEP, reached);
+      double elapsed = elapsedSince(start);
+
+      std::cout << "  " << counts[c] << " asteroids, " << asteroidKernel::name(kernels[k]) << ": "
+                << counts[c] * (double)iterations / elapsed << " asteroids/s, "
+                << elapsed / iterations * 1000.0 << " ms/step, "
+                << arrivals << " reached the atmosphere\n";
+    }
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief The OBJ-parser that was used before the in place one, unchanged apart from the
+///        name. Reads the file line by line and converts the tokens with boost, kept here
+///        to time and check the new parser against.
+/// @param[in] _n Path to the OBJ-file
+/// @param[out] o_m Model structure to store the data in
+// ---------------------------------------------------------------------------------------
+static void parseOBJTokenizer(
+                              const std::string &_n,
+                              model &o_m
+                             )
+{
+  typedef boost::tokenizer<boost::char_separator<char> >tokenizer;
+
+  // Open the filestream for reading a file
+  std::fstream fileIn;
+  fileIn.open(_n.c_str(), std::ios::in);
+
+  // Make sure that the file was opened
+  if(!fileIn.is_open())
+  {
+    std::cerr << "Could not open " << _n << "\n";
+    exit(EXIT_FAILURE);
+  }
+
+  // Boost parser separator
+  boost::char_separator<char> sep(" /\t\r\n");
+
+  // Read the file till we reach the end
+  std::string lineBuffer;
+  while(!fileIn.eof())
+  {
+    // Get a single line from the file and read it to the lineBuffer
+    getline(fileIn, lineBuffer, '\n');
+    if(lineBuffer.size() != 0)
+    {
+      // Using boost to parse each line using the separators defined earlier
+      tokenizer tokens(lineBuffer, sep);
+      tokenizer::iterator it = tokens.begin();
+
+      // Check if we found v i.e. vertex data and store it into the vertex data
+      // part of the supplied structure
+      if(*it == "v")
+      {
+        Vec4 v(boost::lexical_cast<float>(*++it),
+               boost::lexical_cast<float>(*++it),
+               boost::lexical_cast<float>(*++it));
+        o_m.m_Verts.push_back(v);
+      }
+      // Check if we found vn i.e. vertex normal data and store it into the vertex
+      // normal data part of the supplied structure
+      else if(*it == "vn")
+      {
+        Vec4 n(boost::lexical_cast<float>(*++it),
+               boost::lexical_cast<float>(*++it),
+               boost::lexical_cast<float>(*++it));
+        o_m.m_Norms.push_back(n);
+      }
+      // Check if we found vt i.e. texture coordinate data and store it into the
+      // texture coordinate data part of the supplied structure
+      else if(*it == "vt")
+      {
+        Vec4 t(boost::lexical_cast<float>(*++it),
+               boost::lexical_cast<float>(*++it),
+               0);
+        o_m.m_Text.push_back(t);
+      }
+      // Check if we found f i.e. triangle index data and store it into the
+      // stl vector containing the indice data
+      else if(*it == "f")
+      {
+        // First vert, textcoords & norms
+        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
+        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
+        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
+
+        // Second vert, textcoords & norms
+        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
+        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
+        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
+
+        // Third vert, textcoords & norms
+        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
+        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
+        o_m.m_Ind.push_back(boost::lexical_cast<int>(*++it));
+      }
+    }
+  }
+
+  // Close the file after we've reached the eof
+  fileIn.close();
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Hands out increasing numbers to find the order function arguments are
+///        evaluated in
+/// @param[io] io_counter Number to hand out next
+/// @return The number handed out
+// ---------------------------------------------------------------------------------------
+static float nextComponent(
+                           int &io_counter
+                          )
+{
+  return (float)io_counter++;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Puts the components of a model loaded with the old tokenizing parser back in
+///        file order. It stored them in the order the compiler evaluates the Vec4's
+///        arguments in, right to left with gcc, which is found by building a Vec4 the
+///        same way.
+/// @param[io] io_m Model to reorder
+// ---------------------------------------------------------------------------------------
+static void toFileOrder(
+                        model &io_m
+                       )
+{
+  int counter = 0;
+  Vec4 v(nextComponent(counter), nextComponent(counter), nextComponent(counter));
+  counter = 0;
+  Vec4 t(nextComponent(counter), nextComponent(counter), 0);
+
+  std::vector<Vec4> *vectors[] = {&io_m.m_Verts, &io_m.m_Norms};
+  for(int i = 0; i < 2; ++i)
+    for(size_t j = 0; j < vectors[i]->size(); ++j)
+    {
+      Vec4 &c = (*vectors[i])[j];
+      float f[3];
+      f[(int)v.m_x] = c.m_x;
+      f[(int)v.m_y] = c.m_y;
+      f[(int)v.m_z] = c.m_z;
+      c = Vec4(f[0], f[1], f[2]);
+    }
+  for(size_t j = 0; j < io_m.m_Text.size(); ++j)
+  {
+    Vec4 &c = io_m.m_Text[j];
+    float f[2];
+    f[(int)t.m_x] = c.m_x;
+    f[(int)t.m_y] = c.m_y;
+    c = Vec4(f[0], f[1], 0);
+  }
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Checks that two models hold exactly the same data
+/// @param[in] _a First model
+/// @param[in] _b Second model
+/// @return True if all the vectors and indices are bitwise the same
+// ---------------------------------------------------------------------------------------
+static bool sameModel(
+                      const model &_a,
+                      const model &_b
+                     )
+{
+  const std::vector<Vec4> *a[] = {&_a.m_Verts, &_a.m_Norms, &_a.m_Text};
+  const std::vector<Vec4> *b[] = {&_b.m_Verts, &_b.m_Norms, &_b.m_Text};
+  for(int i = 0; i < 3; ++i)
+  {
+    if(a[i]->size() != b[i]->size())
+      return false;
+    for(size_t j = 0; j < a[i]->size(); ++j)
+      if(std::memcmp((*a[i])[j].m_openGL, (*b[i])[j].m_openGL, sizeof(float) * 4))
+        return false;
+  }
+  return _a.m_Ind == _b.m_Ind;
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Loads each of the bundled models with the old tokenizing parser, the in place
+///        parser and from the binary cache, checks that they all give the same data and
+///        prints out the time each of them took and the parsing throughput. The old
+///        parser's components are put in file order before they're compared, the order it
+///        stored them in depends on the compiler.
+// ---------------------------------------------------------------------------------------
+static void benchModels()
+{
+  const char *files[] = {"p_surface.obj", "p_waterbottoms.obj", "p_mountains.obj",
+                         "planet.obj", "sphere.obj", "p_waters.obj", "ss.obj",
+                         "asteroid1.obj", "asteroid2.obj", "cloud_1.obj",
+                         "tree_leaves.obj", "projectile.obj", "tree_trunk.obj"};
+  const int amount = sizeof(files) / sizeof(const char *);
+  const int iterations = 5;
+
+  std::cout << "models (best of " << iterations << ")\n";
+
+  double total[3] = {0.0, 0.0, 0.0};
+  for(int f = 0; f < amount; ++f)
+  {
+    std::string path = std::string("../models/") + files[f];
+    std::ifstream probe(path.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+    if(!probe.is_open())
+    {
+      std::cout << "  " << path << " not found, run from the bench directory\n";
+      return;
+    }
+    double megabytes = probe.tellg() / (1024.0 * 1024.0);
+
+    // Make sure there's an up to date cache to load from
+    model reference;
+    loadModel(path, reference);
+
+    double best[3] = {1e9, 1e9, 1e9};
+    bool same = true;
+    for(int i = 0; i < iterations; ++i)
+    {
+      for(int p = 0; p < 3; ++p)
+      {
+        model m;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if(p == 0)
+          parseOBJTokenizer(path, m);
+        else if(p == 1)
+          parseOBJ(path, m);
+        else
+          loadModelCache(path, m);
+        best[p] = std::min(best[p], elapsedSince(start));
+        if(p == 0)
+          toFileOrder(m);
+        same &= sameModel(reference, m);
+      }
+    }
+
+    for(int p = 0; p < 3; ++p)
+      total[p] += best[p];
+    std::cout << "  " << files[f] << ": tokenizer " << best[0] * 1000.0 << " ms, in place "
+              << best[1] * 1000.0 << " ms (" << megabytes / best[1] << " MB/s), cache "
+              << best[2] * 1000.0 << " ms" << (same ? "" : ", DATA DIFFERS") << "\n";
+  }
+  std::cout << "  total: tokenizer " << total[0] * 1000.0 << " ms, in place " << total[1] * 1000.0
+            << " ms, cache " << total[2] * 1000.0 << " ms\n";
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Builds a mesh out of each of the bundled models and the atmosphere's geodesic
+///        sphere and prints out the vertices before and after welding, the ACMR before
+///        and after reordering the triangles and how long building and optimizing took
+// ---------------------------------------------------------------------------------------
+static void benchMeshes()
+{
+  const char *files[] = {"p_surface.obj", "p_waterbottoms.obj", "p_mountains.obj",
+                         "planet.obj", "sphere.obj", "p_waters.obj", "ss.obj",
+                         "asteroid1.obj", "asteroid2.obj", "cloud_1.obj",
+                         "tree_leaves.obj", "projectile.obj", "tree_trunk.obj"};
+  const int amount = sizeof(files) / sizeof(const char *);
+
+  std::cout << "meshes (ACMR with a " << MESHACMRCACHESIZE << " vertex FIFO, optimized for a "
+            << MESHCACHESIZE << " vertex LRU)\n";
+
+  for(int f = 0; f < amount; ++f)
+  {
+    std::string path = std::string("../models/") + files[f];
+    std::ifstream probe(path.c_str());
+    if(!probe.is_open())
+    {
+      std::cout << "  " << path << " not found, run from the bench directory\n";
+      return;
+    }
+
+    model m;
+    loadModel(path, m);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Mesh mesh;
+    mesh.addModel(m, !m.m_Text.empty());
+    double built = elapsedSince(start);
+    mesh.optimize();
+    double optimized = elapsedSince(start) - built;
+
+    std::cout << "  " << files[f] << ": " << mesh.emittedCount() << " -> " << mesh.vertexCount()
+              << " vertices (" << (mesh.indexType() == GL_UNSIGNED_SHORT ? 16 : 32) << "-bit indices), ACMR "
+              << mesh.acmrBefore() << " -> " << mesh.acmrAfter() << ", build " << built * 1000.0
+              << " ms, optimize " << optimized * 1000.0 << " ms\n";
+  }
+
+  // And the geodesic sphere of the atmosphere
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  Mesh mesh;
+  Icosphere(4).addTo(mesh);
+  double built = elapsedSince(start);
+  mesh.optimize();
+  double optimized = elapsedSince(start) - built;
+
+  std::cout << "  icosphere (4 subdivisions): " << mesh.emittedCount() << " -> " << mesh.vertexCount()
+            << " vertices (" << (mesh.indexType() == GL_UNSIGNED_SHORT ? 16 : 32) << "-bit indices), ACMR "
+            << mesh.acmrBefore() << " -> " << mesh.acmrAfter() << ", build " << built * 1000.0
+            << " ms, optimize " << optimized * 1000.0 << " ms\n";
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+/// @brief Builds the levels of detail of the asteroid models and prints out their
+///        triangles and how long simplifying took, then culls a late wave of 300 asteroids
+///        sized 0.1 to 0.8 from the game camera and prints out the triangles drawn with
+///        the full models and with the level picked for each asteroid
+// ---------------------------------------------------------------------------------------
+static void benchLods()
+{
+  const char *files[ASTEROIDTYPES] = {"asteroid1.obj", "asteroid2.obj"};
+  const int asteroids = 300;
+  const float radius = WORLDRADIUS*ASPHERERADIUS;
+
+  std::cout << "lods (" << ASTEROIDLODS << " levels, simplified below " << ASTEROIDLODPIXELS
+            << " pixels of radius)\n";
+
+  Mesh meshes[ASTEROIDTYPES][ASTEROIDLODS];
+  for(int t = 0; t < ASTEROIDTYPES; ++t)
+  {
+    std::string path = std::string("../models/") + files[t];
+    std::ifstream probe(path.c_str());
+    if(!probe.is_open())
+    {
+      std::cout << "  " << path << " not found, run from the bench directory\n";
+      return;
+    }
+
+    model m;
+    loadModel(path, m);
+    meshes[t][0].addModel(m, true);
+
+    std::cout << "  " << files[t] << ": " << meshes[t][0].indexCount() / 3;
+    for(int l = 1; l < ASTEROIDLODS; ++l)
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      meshes[t][0].simplify((meshes[t][0].indexCount() / 3) >> l, meshes[t][l]);
+      std::cout << " -> " << meshes[t][l].indexCount() / 3 << " (" << elapsedSince(start) * 1000.0 << " ms)";
+    }
+    std::cout << " triangles\n";
+  }
+
+  // Half of the asteroids on the atmosphere and the rest on their way from the skybox
+  std::srand(1);
+  std::vector<float> x(asteroids), y(asteroids), z(asteroids), r(asteroids);
+  std::vector<int> type(asteroids);
+  for(int i = 0; i < asteroids; ++i)
+  {
+    float distance = i % 2 ? radius : radius + std::rand()/(float)RAND_MAX * (15.0f - radius);
+    Vec4 p = randomOnSphere(distance);
+    type[i] = std::rand() % ASTEROIDTYPES;
+    x[i] = p.m_x; y[i] = p.m_y; z[i] = p.m_z;
+    r[i] = (std::rand()/(float)RAND_MAX * 0.7f + 0.1f) * meshes[type[i]][0].radius();
+  }
+
+  const frustum::planes planes = gameFrustum();
+  const frustum::spheres spheres = {&x[0], &y[0], &z[0], &r[0], asteroids};
+  std::vector<int> visible(asteroids);
+  int drawn = frustum::select()(planes, spheres, &visible[0]);
+
+  const float pixels = frustum::focalLength(planes) * SCREENHEIGHT * 0.5f;
+  int levels[ASTEROIDLODS] = {0};
+  int full = 0, reduced = 0;
+  for(int k = 0; k < drawn; ++k)
+  {
+    int i = visible[k];
+    float depth = std::max(frustum::depth(planes, x[i], y[i], z[i]), r[i]);
+    int level = AsteroidField::lodLevel(r[i] * pixels / depth);
+    ++levels[level];
+    full += meshes[type[i]][0].indexCount() / 3;
+    reduced += meshes[type[i]][level].indexCount() / 3;
+  }
+
+  std::cout << "  " << asteroids << " asteroids, " << drawn << " visible, per level:";
+  for(int l = 0; l < ASTEROIDLODS; ++l)
+    std::cout << " " << levels[l];
+  std::cout << "\n  triangles: " << full << " full, " << reduced << " with the levels of detail\n";
+}
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+  // Table of the benchmarks, run all of them or just the one given as an argument
+  typedef struct
+  {
+    const char *m_name;
+    void (*m_run)();
+  } benchmark;
+
+  const benchmark benchmarks[] = {
+    {"particles", benchParticles},
+    {"collisions", benchCollisions},
+    {"culling", benchCulling},
+    {"asteroids", benchAsteroids},
+    {"models", benchModels},
+    {"meshes", benchMeshes},
+    {"lods", benchLods}
+  };
+  const int amount = sizeof(benchmarks) / sizeof(benchmark);
+
+  bool found = false;
+  for(int i = 0; i < amount; ++i)
+  {
+    if(argc < 2 || !std::strcmp(argv[1], benchmarks[i].m_name))
+    {
+      benchmarks[i].m_run();
+      found = true;
+    }
+  }
+
+  if(!found)
+  {
+    std::cerr << "Usage: " << argv[0] << " [benchmark]\nBenchmarks:";
+    for(int i = 0; i < amount; ++i)
+      std::cerr << " " << benchmarks[i].m_name;
+    std::cerr << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+// ---------------------------------------------------------------------------------------
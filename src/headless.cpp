@@ -0,0 +1,71 @@
+/*
+ Copyright © 2015 Teemu Lindborg
+ SDAGE 1st year 2nd PPP Assignment
+*/
+
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+
+#include "Defs.h"
+#include "World.h"
+#include "Player.h"
+
+// ---------------------------------------------------------------------------------------
+/// @file headless.cpp
+/// @brief Main file of the headless simulation build. Runs the world and player
+///        simulation for a given amount of fixed updates (frames) without any window, GL context or audio
+///        and prints out how long the simulation took. The player is kept still in the
+///        middle of the view, turning its aim slowly and firing every frame.
+///        Usage: super_stardust_headless [frames]
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+  // Amount of frames to simulate, can be given as the first argument
+  int frames = (argc > 1 ? std::atoi(argv[1]) : 10000);
+  if(frames <= 0)
+  {
+    std::cerr << "Usage: " << argv[0] << " [frames]\n";
+    return EXIT_FAILURE;
+  }
+
+  World world;
+  Player player(0.0f, 0.0f, WORLDRADIUS+PLAYEROFFSET);
+
+  // Same aim turning speed as with the keyboard
+  float aim = 0.0f;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  for(int i = 0; i < frames; ++i)
+  {
+    aim = fmod(aim + 0.1f, TWO_PI);
+    player.setAim(aim, true);
+
+    world.update(SIMSTEP);
+    player.update(SIMSTEP);
+
+    if(player.isAlive())
+      player.checkCollisions(world.m_asteroids, world.m_aGrid);
+
+    // Increase the amount of maximum possible asteroids every simulated second
+    if(!((i + 1) % SIMRATE) && world.m_maxAsteroids < MAX_ASTEROIDS)
+      world.m_maxAsteroids += world.m_maxAsteroids/50 + 1;
+  }
+
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "Simulated " << frames << " frames in " << elapsed << "s ("
+            << frames / elapsed << " frames/s)\n"
+            << "Asteroids: " << world.m_asteroids.size()
+            << ", particles: " << player.m_particles.size()
+            << ", projectile high-water mark: " << player.getProjectiles().highWaterMark()
+            << "/" << player.getProjectiles().capacity()
+            << ", score: " << player.m_score
+            << ", player " << (player.isAlive() ? "alive" : "dead") << "\n";
+
+  return EXIT_SUCCESS;
+}
+// ---------------------------------------------------------------------------------------
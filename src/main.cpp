@@ -3,6 +3,10 @@
  SDAGE 1st year 2nd PPP Assignment
 */
 
+#ifdef CULLINGSTATS
+  #include <sstream>
+#endif
+
 #include "Sdl_gl.h"
 #include "Camera.h"
 #include "World.h"
@@ -10,6 +14,7 @@
 #include "Asteroids.h"
 #include "frames.h"
 #include "OrthoText.h"
+#include "AssetLoader.h"
 
 // ---------------------------------------------------------------------------------------
 /// @file main.cpp
@@ -29,6 +34,18 @@ int main()
   World world;
   Player player(0.0f, 0.0f, WORLDRADIUS+PLAYEROFFSET);
 
+  // Load all the models, textures and sounds on a thread pool, the textures are
+  // created on this thread as they get decoded. The meshes are generated after
+  // everything has been loaded.
+  {
+    AssetLoader assets;
+    world.loadAssets(assets);
+    player.loadAssets(assets);
+    assets.finish();
+  }
+  world.initAssets();
+  player.initAssets();
+
   // Initialising the camera, generating stars and enabling gl lightning and
   // texture related stuff, also clearing the screen to a grey color
   cam.initCamera();
@@ -36,21 +53,69 @@ int main()
   sdlgl.enableLighting();
   glClearColor (0.4, 0.4, 0.4, 0.4);
 
-  // Using SDL_GetTicks() to keep track of time passed in the game,
-  // this is used later to increase the amount of maximum asteroids
-  // that's allowed to be in the scene
-  int start = SDL_GetTicks();
-  int lastTime = 0;
+  // The simulation is advanced in fixed steps of SIMSTEP seconds, the time taken by the
+  // rendering is accumulated and consumed by as many updates as fit in it. The rendering
+  // then interpolates between the last two updates using what's left in the accumulator.
+  Uint64 lastCounter = SDL_GetPerformanceCounter();
+  double accumulator = 0.0;
+
+  // Amount of simulation updates run, this is used later to increase the amount
+  // of maximum asteroids that's allowed to be in the scene
+  int steps = 0;
 
   while(sdlgl.isActive())
   {
-    // Clearing the color and depth buffers and calling the frameStart()
-    // function that'll calculate and limit our fps
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // Calling the frameStart() function that'll calculate our fps
     frameStart();
 
-    // Draw the world first
-    world.drawWorld();
+    Uint64 counter = SDL_GetPerformanceCounter();
+    double frameTime = (counter - lastCounter) / (double)SDL_GetPerformanceFrequency();
+    lastCounter = counter;
+
+    // Clamp overly long frames (window dragged, breakpoints etc.) so we don't end up
+    // trying to catch up with a huge amount of updates
+    accumulator += (frameTime > 0.25 ? 0.25 : frameTime);
+
+    // Call the function that handles the input events
+    sdlgl.handleInput();
+
+    while(accumulator >= SIMSTEP)
+    {
+      // Move the player and the camera based on the controller/keyboard input
+      if(player.isAlive())
+        player.handleMovement(sdlgl.m_controller, cam);
+
+      // Advance the simulation, first the world (asteroids)
+      // and then the player's projectiles and particles
+      world.update(SIMSTEP);
+      player.update(SIMSTEP);
+
+      // Checking for collisions between the player, projectiles and asteroids
+      if(player.isAlive())
+        player.checkCollisions(world.m_asteroids, world.m_aGrid);
+
+      // Update the amount of maximum possible asteroids every simulated second
+      if(!(++steps % SIMRATE) && world.m_maxAsteroids < MAX_ASTEROIDS)
+        world.m_maxAsteroids += world.m_maxAsteroids/50 + 1;
+
+      accumulator -= SIMSTEP;
+    }
+
+    // Nothing to draw while the window is minimized, just give the time slice away
+    if(sdlgl.isMinimized())
+    {
+      SDL_Delay(10);
+      continue;
+    }
+
+    // How far we are between the last update and the next one
+    float alpha = accumulator / SIMSTEP;
+
+    // Clearing the color and depth buffers and drawing the world first, culled against
+    // the frustum the camera was left at after the last frame
+    frustum::counters culling = {{0, 0}, {0, 0}, {0, 0}, {0, 0}};
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    world.drawWorld(alpha, cam.m_frustum, culling);
 
     // If player is still considered to be alive we draw the player
     // if not pause the background noise that was playing when the
@@ -64,29 +129,24 @@ int main()
     }
 
     // Updating the camera
-    cam.updateCamera();
+    cam.updateCamera(alpha);
 
-    // If there are any alive fire particles, render them
+    // Render the projectiles and, if there are any alive fire particles, them as well
+    player.drawProjectiles(alpha, cam.m_frustum, culling.m_projectiles);
     if(player.m_particles.size() > 0)
-      player.drawParticles();
-
-    // Checking for collisions between the player, projectiles and asteroids
-    if(player.isAlive())
-      player.checkCollisions(world.m_asteroids, world.m_aColIndices);
-
-    // Call the function that handles the input and calls
-    // the movement handling functions
-    sdlgl.handleInput(player, cam);
-
-    // Update the amount of maximum possible asteroids every 1 second
-    if(lastTime != (int)(SDL_GetTicks() - start)/1000 && world.m_maxAsteroids < 300)
-    {
-      world.m_maxAsteroids += world.m_maxAsteroids/50 + 1;
-      lastTime = (SDL_GetTicks() - start)/1000;
-    }
+      player.drawParticles(alpha);
+
+#ifdef CULLINGSTATS
+    // Drawn and culled counts under the fps when built with CULLINGSTATS defined
+    std::ostringstream culled;
+    culled << "Drawn/culled - asteroids " << culling.m_asteroids.m_visible << "/" << culling.m_asteroids.m_culled
+           << " trees " << culling.m_trees.m_visible << "/" << culling.m_trees.m_culled
+           << " clouds " << culling.m_clouds.m_visible << "/" << culling.m_clouds.m_culled
+           << " projectiles " << culling.m_projectiles.m_visible << "/" << culling.m_projectiles.m_culled;
+    OrthoText(GLUT_BITMAP_HELVETICA_18, culled.str(), 0.05f, 0.92f);
+#endif
 
     // Frame ends here so we call the function that renders the fps and score
-    // and calls for SDL_Delay should the fps surpass the limit
     frameEnd(GLUT_BITMAP_HELVETICA_18, 1.0, 1.0, 1.0, 0.05, 0.95, player.m_score);
     SDL_GL_SwapWindow(sdlgl.m_win);
   }